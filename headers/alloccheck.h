@@ -0,0 +1,54 @@
+// alloccheck.h
+// Allocation counting for the hot paths of B and D (test builds)
+//   - make ALLOC_CHECK=1 defines ARP_ALLOC_CHECK: the binary replaces
+//     malloc/calloc/realloc/free (forwarding to glibc) and counts calls per
+//     thread, including the ones made inside libc and ncurses
+//   - B and D mark a tick with ALLOC_TICK() at the top of their loops; after
+//     ALLOC_WARMUP_TICKS any tick that allocates is a steady-state violation
+//   - counters live in a MAP_SHARED table created by main, so B's exit report
+//     covers D (and the standby replica) too: a run with a violation fails
+//     (exit status 1, "[B] ALLOC FAIL") like a failed scenario or soak
+//   - release builds compile the hooks to nothing
+// ======================================================================
+
+#ifndef ALLOCCHECK_H
+#define ALLOCCHECK_H
+
+#include <stdio.h>
+
+#define ALLOC_WARMUP_TICKS 200   // loop iterations allowed to allocate (startup, first log lines)
+#define ALLOC_LOG_FIRST    5     // violations logged individually, per role
+
+typedef enum {
+    ALC_B = 0,
+    ALC_D,        // primary D and standby replicas
+    ALC_COUNT
+} AllocRole;
+
+// One loop's tick bookkeeping (lives in the component)
+typedef struct {
+    AllocRole     role;
+    unsigned long ticks;
+    unsigned long allocs0, frees0;   // thread counters at the start of the tick
+    int           open;
+} AllocTick;
+
+// Creates the shared table. Call in main before the components are launched.
+// No-op in builds without ARP_ALLOC_CHECK.
+void alloc_check_setup(void);
+
+#ifdef ARP_ALLOC_CHECK
+void alloc_tick_init(AllocTick *t, AllocRole role);
+void alloc_tick(AllocTick *t, FILE *log);     // ends the previous tick, starts the next
+int  alloc_check_finish(FILE *log);           // summary per role; 1 = no steady-state allocation
+
+#define ALLOC_TICK_INIT(t, role)  alloc_tick_init(t, role)
+#define ALLOC_TICK(t, log)        alloc_tick(t, log)
+#define ALLOC_CHECK_FINISH(log)   alloc_check_finish(log)
+#else
+#define ALLOC_TICK_INIT(t, role)  ((void)(t))
+#define ALLOC_TICK(t, log)        ((void)0)
+#define ALLOC_CHECK_FINISH(log)   1
+#endif
+
+#endif // ALLOCCHECK_H
@@ -0,0 +1,35 @@
+// arena.h
+// Per-tick scratch arena
+//   - one buffer allocated at startup; arena_alloc() bumps a pointer and
+//     arena_reset() (once per tick) gives everything back at once
+//   - variable-length scratch on the hot path goes here instead of malloc,
+//     so a steady-state tick never allocates (see alloccheck.h)
+//   - full arena: arena_alloc() returns NULL and counts an overflow; callers
+//     fall back to their slower fixed-size path
+// ======================================================================
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define ARENA_ALIGN 16
+
+typedef struct {
+    unsigned char *base;
+    size_t         cap;
+    size_t         used;
+    size_t         high;        // high-water mark (bytes)
+    unsigned long  overflows;   // allocations refused because the arena was full
+} Arena;
+
+int   arena_init(Arena *a, size_t cap);   // 0 or -1 (startup allocation failed)
+void *arena_alloc(Arena *a, size_t n);    // ARENA_ALIGN-aligned, NULL if full
+void  arena_reset(Arena *a);
+void  arena_free(Arena *a);
+
+// At exit: capacity, high-water mark and overflows.
+void  arena_report(const Arena *a, const char *name, FILE *log);
+
+#endif // ARENA_H
@@ -0,0 +1,64 @@
+// channel.h
+// Lifecycle of B's generator input channels (O -> B, T -> B)
+//   OPEN        peer alive, fd in B's select set
+//   DRAINING    peer process reaped, unread messages are still consumed
+//   CLOSED      fd closed and out of the select set (B runs degraded)
+//   RESTARTING  B forked a new peer and waits for its first message
+// A closed channel never stays in the select set, so a dead peer cannot
+// turn B's loop into a busy loop.
+// ======================================================================
+
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <stdio.h>
+#include <sys/select.h>
+#include <sys/types.h>
+#include "params.h"
+
+typedef enum {
+    CHAN_OPEN = 0,
+    CHAN_DRAINING,
+    CHAN_CLOSED,
+    CHAN_RESTARTING
+} ChanState;
+
+// Generator entry point used for restarts (run_obstacle_process, run_target_process)
+typedef void (*PeerMain)(int write_fd, SimParams params);
+
+typedef struct {
+    const char *name;       // "O" / "T"
+    const char *log_name;   // process log, e.g. "obstacles" -> logs/obstacles.log
+    PeerMain    entry;      // NULL = never restarted (thread peer inside B)
+    int         fd;         // read end, -1 when CLOSED
+    pid_t       pid;        // writer process, -1 when unknown or reaped
+    ChanState   state;
+    int         restarts;   // restarts performed so far
+    double      retry_at;   // CLOSED: wall time of the next restart attempt
+    long        msgs;       // messages received over all incarnations
+} PeerChannel;
+
+// Starts in OPEN. pid == getpid() marks a thread peer (no reaping, no restarts).
+void chan_init(PeerChannel *c, const char *name, const char *log_name,
+               int fd, pid_t pid, PeerMain entry);
+
+// Read end to watch, or -1 if the channel is CLOSED.
+int  chan_fd(const PeerChannel *c);
+
+// Adds the channel to a select() set (no-op when CLOSED) and raises *maxfd.
+void chan_watch(const PeerChannel *c, fd_set *set, int *maxfd);
+
+// Accounts for one read() on the channel. Returns 1 if n bytes of data arrived,
+// 0 otherwise (EOF and hard errors close the channel).
+int  chan_on_read(PeerChannel *c, ssize_t n, const SimParams *p, double now, FILE *log);
+
+// Once per loop: reaps an exited writer, finishes draining, performs due restarts.
+// Returns 1 if the peer pid changed (the watchdog must be told).
+int  chan_poll(PeerChannel *c, const SimParams *p, double now, FILE *log);
+
+// 1 unless the channel is OPEN.
+int  chan_degraded(const PeerChannel *c);
+
+const char *chan_state_name(ChanState s);
+
+#endif // CHANNEL_H
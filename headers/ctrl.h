@@ -0,0 +1,126 @@
+// ctrl.h
+// External controller API (B side + wire protocol shared with arp1_ctrl)
+//   - transport: Unix SOCK_SEQPACKET socket at CTRL_SOCKET_PATH, one
+//     CtrlCmd / CtrlEvt per packet (message boundaries kept, no framing)
+//   - controllers send absolute user forces per drone with CLOCK_MONOTONIC
+//     timestamps and receive every D state in return
+//   - arbitration: one controller owns the drone at a time; while it does,
+//     directional keys are ignored. Brake 'd' on the keyboard (or owner
+//     silence for ctrl_timeout_sec) revokes it and zeroes the force.
+// ======================================================================
+
+#ifndef CTRL_H
+#define CTRL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/select.h>
+#include "messages.h"
+
+#define CTRL_SOCKET_PATH   "logs/ctrl.sock"
+#define CTRL_PROTO_VERSION 1
+#define CTRL_MAX_CLIENTS   4
+
+// Published round-trip budget (PING -> PONG through B's event loop), per transport.
+// arp1_ctrl ping reports PASS/FAIL against it.
+#define CTRL_RTT_BUDGET_US_SEQPACKET 1000
+
+// Controller -> B
+typedef enum {
+    CTRL_HELLO = 1,     // flags: CTRL_F_CONTROL to request control, CTRL_F_STATE to subscribe
+    CTRL_FORCE,         // owner only: user force (fx, fy) for `drone`
+    CTRL_PING,          // answered with CTRL_PONG at once
+    CTRL_RELEASE,       // owner gives control back to the keyboard
+    CTRL_LOG,           // any client: log category `drone` (LOGC_COUNT = all) to level
+                        // `flags`, 1 line in fx (0 = keep), fy lines/s (< 0 = keep)
+    CTRL_FAULT          // any client: fault `drone` (FaultId) to value fx; DENIED in
+                        // builds without fault injection (faults.h)
+} CtrlCmdType;
+
+#define CTRL_F_CONTROL 0x01
+#define CTRL_F_STATE   0x02
+
+typedef struct {
+    uint32_t type;      // CtrlCmdType
+    uint32_t version;   // CTRL_PROTO_VERSION
+    uint32_t drone;     // drone index (this build has one drone: 0)
+    uint32_t flags;
+    uint32_t seq;       // controller's own counter, echoed back
+    uint32_t reserved;
+    int64_t  t_ns;      // controller CLOCK_MONOTONIC at send time
+    double   fx, fy;    // CTRL_FORCE: absolute user force in N
+} CtrlCmd;
+
+// B -> controller
+typedef enum {
+    CTRL_WELCOME = 1,   // reply to HELLO (flags: CTRL_F_CONTROL if control was granted)
+    CTRL_STATE,         // one per D tick to subscribers
+    CTRL_PONG,          // reply to PING
+    CTRL_DENIED,        // command refused (not the owner, bad drone, bad version)
+    CTRL_REVOKED,       // control taken back (keyboard brake or timeout)
+    CTRL_ACK            // command applied (CTRL_LOG, CTRL_FAULT)
+} CtrlEvtType;
+
+typedef struct {
+    uint32_t type;      // CtrlEvtType
+    uint32_t drone;
+    uint32_t flags;
+    uint32_t seq;       // seq of the command answered / last applied
+    int64_t  t_ns;      // B's CLOCK_MONOTONIC at send time
+    int64_t  echo_t_ns; // t_ns of that command (PONG, STATE: last applied force)
+    int32_t  tick;      // CTRL_STATE: D tick index
+    int32_t  reserved;
+    DroneStateMsg state;
+    double   fx, fy;    // user force in effect
+} CtrlEvt;
+
+// ---------------------------------------------------------------------
+// B side
+// ---------------------------------------------------------------------
+typedef struct {
+    int  fd;            // -1 = free slot
+    int  subscribed;
+    long dropped;       // states not delivered (socket full)
+} CtrlClient;
+
+typedef struct {
+    int        listen_fd;          // -1 = API disabled
+    CtrlClient cl[CTRL_MAX_CLIENTS];
+    int        owner;              // client slot in control, -1 = keyboard
+    double     owner_last;         // wall time of the owner's last command
+    uint32_t   last_seq;           // last applied command
+    int64_t    last_t_ns;
+    long       cmds;               // force commands applied
+    long       denied;
+    double     cmd_age_ms;         // send -> applied age of the last force command
+} CtrlServer;
+
+// Binds and listens at path (stale socket file replaced). Returns 0 on success.
+int  ctrl_open(CtrlServer *c, const char *path, FILE *log);
+
+// Adds the listening socket and every client to a select() set.
+void ctrl_watch(const CtrlServer *c, fd_set *set, int *maxfd);
+
+// Accepts clients and handles their commands. Returns 1 if the owner changed
+// the user force in *user_force (the caller requests a force update).
+int  ctrl_handle(CtrlServer *c, const fd_set *rfds, ForceStateMsg *user_force, FILE *log);
+
+// Sends one D state to every subscriber (never blocks; full sockets drop it).
+void ctrl_publish_state(CtrlServer *c, const DroneStateMsg *s, int tick,
+                        const ForceStateMsg *user_force);
+
+// Gives control back to the keyboard (tells the owner why). No-op without owner.
+void ctrl_revoke(CtrlServer *c, const char *why, FILE *log);
+
+// Revokes control if the owner has been silent for timeout_sec. Returns 1 if revoked.
+int  ctrl_check_timeout(CtrlServer *c, double now, double timeout_sec, FILE *log);
+
+int  ctrl_has_owner(const CtrlServer *c);
+
+// Closes every socket and removes the socket file.
+void ctrl_close(CtrlServer *c, const char *path);
+
+// CLOCK_MONOTONIC in ns (the timestamp base of the protocol).
+int64_t ctrl_now_ns(void);
+
+#endif // CTRL_H
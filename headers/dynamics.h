@@ -14,5 +14,10 @@
 //   - Sends DroneStateMsg to state_fd (to B)
 void run_dynamics_process(int force_fd, int state_fd, SimParams params);
 
+// Runs a hot-standby replica of D in a process forked from B:
+//   - same loop and force stream as the primary, log in logs/dynamics_standby_<generation>.log
+//   - closes every inherited fd except its two channel ends, never returns
+void run_dynamics_replica(int force_fd, int state_fd, SimParams params, int generation);
+
 #endif // DYNAMICS_H
 
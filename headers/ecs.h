@@ -0,0 +1,169 @@
+// ecs.h
+// Entity-component store and system scheduler
+//   - archetypes are fixed component sets (drone, obstacle, target); each
+//     keeps its entities' components in contiguous columns, dense: removing
+//     an entity moves the archetype's last row into the hole
+//   - entity ids are stable (index + generation): the id of a removed entity
+//     never resolves to the entity that later reuses its index
+//   - every column is sized at ecs_init; spawning into a full archetype fails
+//     instead of allocating (steady-state ticks stay allocation-free)
+//   - systems declare the components / resources they read and write; the
+//     scheduler packs them into stages of non-conflicting systems (conflicting
+//     systems keep their declaration order) and runs the systems of a stage on
+//     a fixed pool of worker threads
+//   - removals during a stage go through ecs_destroy_later() and are applied
+//     between stages
+//   - B keeps its obstacles and targets here (one world, capacity
+//     NUM_OBSTACLES / NUM_TARGETS); each carries the slot B gave it, which the
+//     world hash and scenario waves address
+// arp1_ecsbench runs the same per-tick work on plain arrays and on the ECS and
+// checks the results match.
+// ======================================================================
+
+#ifndef ECS_H
+#define ECS_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "params.h"
+
+// Components and shared resources (bit masks, used for conflict detection)
+#define ECS_POS       (1u << 0)   // x, y
+#define ECS_VEL       (1u << 1)   // vx, vy
+#define ECS_FORCE     (1u << 2)   // ux, uy (commanded) and fx, fy (total)
+#define ECS_LIFE      (1u << 3)   // steps left (0 = expires)
+#define ECS_SENSE     (1u << 4)   // range finder: distance to the nearest obstacle
+#define ECS_RES_SCORE (1u << 5)   // resource: hits
+#define ECS_RES_FRAME (1u << 6)   // resource: rendered cell grid
+#define ECS_SLOT      (1u << 7)   // B's slot index (world hash, scenario waves)
+
+typedef enum {
+    ECS_DRONE = 0,    // POS VEL FORCE SENSE
+    ECS_OBSTACLE,     // POS LIFE SLOT
+    ECS_TARGET,       // POS LIFE SLOT
+    ECS_ARCH_COUNT
+} EcsArch;
+
+#define ECS_ARCH_MASKS { ECS_POS | ECS_VEL | ECS_FORCE | ECS_SENSE, \
+                         ECS_POS | ECS_LIFE | ECS_SLOT, \
+                         ECS_POS | ECS_LIFE | ECS_SLOT }   // by EcsArch
+#define ECS_ARCH_NAMES { "drone", "obstacle", "target" }
+
+typedef uint32_t EcsId;                 // 0 = no entity
+#define ECS_INDEX_BITS 20               // up to ~1M entities
+#define ECS_INDEX_MASK ((1u << ECS_INDEX_BITS) - 1u)
+
+// Columns of one archetype (NULL where the archetype lacks the component)
+typedef struct {
+    unsigned mask;
+    int      cap;
+    int      n;
+    EcsId   *id;          // row -> entity
+    double  *x, *y;
+    double  *vx, *vy;
+    double  *ux, *uy;
+    double  *fx, *fy;
+    int     *life;
+    double  *sense;
+    int     *slot;
+} EcsArchetype;
+
+typedef struct {
+    EcsArchetype arch[ECS_ARCH_COUNT];
+
+    // Entity table, by index
+    uint16_t *gen;         // current generation (bumped on removal)
+    uint8_t  *arch_of;
+    int      *row;         // -1 = free
+    int      *free_idx;    // free-list stack
+    int       n_free;
+    int       cap;
+
+    // Deferred removals (filled by systems, applied between stages)
+    EcsId    *pending;
+    int       n_pending;   // atomic
+} EcsWorld;
+
+int   ecs_init(EcsWorld *w, const int cap[ECS_ARCH_COUNT]);   // 0 or -1
+void  ecs_free(EcsWorld *w);
+
+EcsId ecs_spawn(EcsWorld *w, EcsArch a);        // 0 if the archetype is full
+void  ecs_destroy(EcsWorld *w, EcsId id);       // not while a stage runs
+void  ecs_destroy_later(EcsWorld *w, EcsId id); // from systems (thread-safe)
+void  ecs_apply_pending(EcsWorld *w);
+
+// Row of a live entity (and its archetype), or -1 for a stale / unknown id.
+int   ecs_row(const EcsWorld *w, EcsId id, EcsArch *a);
+
+// Scheduler
+// ----------------------------------------------------------------------
+#define ECS_MAX_SYSTEMS 16
+#define ECS_MAX_WORKERS 8
+
+typedef void (*EcsSystemFn)(EcsWorld *w, void *ctx);
+
+typedef struct {
+    const char *name;
+    unsigned    reads;    // ECS_* bits
+    unsigned    writes;
+    EcsSystemFn fn;
+    void       *ctx;
+} EcsSystem;
+
+typedef struct EcsSched EcsSched;
+
+typedef struct {
+    EcsSched *sched;
+    int       me;
+} EcsWorkerArg;
+
+struct EcsSched {
+    EcsSystem sys[ECS_MAX_SYSTEMS];
+    int       stage[ECS_MAX_SYSTEMS];   // stage of each system
+    int       lane[ECS_MAX_SYSTEMS];    // worker that runs it
+    int       n;
+    int       n_stages;
+    double    sys_sec[ECS_MAX_SYSTEMS]; // cumulative time per system
+    long      ticks;
+
+    // Worker pool (workers - 1 threads; the caller is worker 0)
+    int               workers;
+    pthread_t         tid[ECS_MAX_WORKERS];
+    EcsWorkerArg      arg[ECS_MAX_WORKERS];
+    pthread_barrier_t start, done;
+    EcsWorld         *world;
+    int               cur_stage;        // -1 = shut down
+};
+
+// Plans the stages and starts the workers. Returns 0 or -1.
+int  ecs_sched_init(EcsSched *s, const EcsSystem *systems, int n, int workers);
+
+// One tick: every stage in order, pending removals applied after each.
+void ecs_sched_run(EcsSched *s, EcsWorld *w);
+
+// Stage plan and mean time per system.
+void ecs_sched_report(const EcsSched *s, FILE *out);
+void ecs_sched_free(EcsSched *s);
+
+// Systems of the drone world (ecs_systems.c)
+// ----------------------------------------------------------------------
+typedef struct {
+    const SimParams *params;
+    const int       *obs_rows;           // repulse: obstacle rows to sum (NULL = every row)
+    int              n_obs_rows;
+    const int       *tgt_rows;           // hit: target rows to test (NULL = every row)
+    int              n_tgt_rows;
+    long             hits;               // ECS_RES_SCORE
+    char            *frame;              // ECS_RES_FRAME: rows x cols cells
+    int              rows, cols;
+} EcsSimCtx;
+
+void ecs_sys_repulse(EcsWorld *w, void *ctx);     // r POS, w FORCE  (obstacle field B adds)
+void ecs_sys_sense(EcsWorld *w, void *ctx);       // r POS, w SENSE
+void ecs_sys_age(EcsWorld *w, void *ctx);         // w LIFE          (expired -> removed; 0 = no expiry)
+void ecs_sys_integrate(EcsWorld *w, void *ctx);   // r FORCE, w POS VEL (walls + Euler, as D)
+void ecs_sys_hit(EcsWorld *w, void *ctx);         // r POS, w LIFE SCORE (collected -> removed)
+void ecs_sys_render(EcsWorld *w, void *ctx);      // r POS LIFE, w FRAME
+
+#endif // ECS_H
@@ -0,0 +1,74 @@
+// faults.h
+// Fault and latency injection for performance / robustness testing
+//   - one table of fault values in a MAP_SHARED mapping created before the
+//     components are launched, so B can change a fault at runtime and every
+//     process (or thread) sees it on its next pass through the hook
+//   - set from faults.txt at startup, the control socket (CTRL_FAULT,
+//     arp1_ctrl fault) or scenario 'fault' lines
+//   - the hooks only exist in builds with -DARP_FAULTS (make FAULTS=1);
+//     release builds compile them to nothing and refuse to set faults
+// ======================================================================
+
+#ifndef FAULTS_H
+#define FAULTS_H
+
+#include <stdio.h>
+
+#define FAULTS_FILE "faults.txt"
+
+typedef enum {
+    FLT_D_DELAY_MS = 0,   // D: extra sleep after every state (ms)
+    FLT_D_STALL_SEC,      // D: one stall of this many seconds, then cleared
+    FLT_B_RENDER_MS,      // B: extra time spent per UI frame (ms)
+    FLT_FORCE_DROP,       // B -> D: probability a force command is lost
+    FLT_FORCE_DUP,        // B -> D: probability a force command is sent twice
+    FLT_O_DELAY_MS,       // O: delay before each obstacle batch (ms)
+    FLT_T_DELAY_MS,       // T: delay before each target batch (ms)
+    FLT_TERM_FPS,         // terminal throttle: at most this many frames/s drawn (0 = off)
+    FLT_COUNT
+} FaultId;
+
+#define FAULT_NAMES { "d_delay_ms", "d_stall_sec", "b_render_ms", "force_drop", \
+                      "force_dup", "o_delay_ms", "t_delay_ms", "term_fps" }   // by FaultId
+
+typedef struct {
+    volatile double value[FLT_COUNT];   // 0 = fault off
+    unsigned long   hits[FLT_COUNT];    // times each fault fired (atomic adds)
+} FaultTable;
+
+// Creates the shared table and loads FAULTS_FILE if present. Call before
+// the components are launched. No-op in builds without ARP_FAULTS.
+void fault_setup(void);
+
+// Sets one fault (B: control socket, scenario). Returns 0, or -1 if the id
+// is unknown or faults are not compiled in.
+int  fault_set(int id, double value, const char *why, FILE *log);
+
+int         fault_from_name(const char *name);   // -1 = unknown
+const char *fault_name(int id);
+int         fault_compiled_in(void);
+
+// Once per second while a fault is set: its value and hits since the last report.
+void fault_report(double now, FILE *log);
+
+#ifdef ARP_FAULTS
+double fault_value(FaultId id);
+void   fault_sleep_ms(FaultId id);                // sleeps value ms (and counts a hit)
+int    fault_chance(FaultId id);                  // 1 with probability value
+double fault_stall(FaultId id);                   // clears value, then sleeps it (s); returns it
+void   fault_hit(FaultId id);
+
+#define FAULT_VALUE(id)    fault_value(id)
+#define FAULT_SLEEP_MS(id) fault_sleep_ms(id)
+#define FAULT_CHANCE(id)   fault_chance(id)
+#define FAULT_STALL(id)    fault_stall(id)
+#define FAULT_HIT(id)      fault_hit(id)
+#else
+#define FAULT_VALUE(id)    0.0
+#define FAULT_SLEEP_MS(id) ((void)0)
+#define FAULT_CHANCE(id)   0
+#define FAULT_STALL(id)    0.0
+#define FAULT_HIT(id)      ((void)0)
+#endif
+
+#endif // FAULTS_H
@@ -0,0 +1,101 @@
+// iobatch.h
+// Optional io_uring-based batched output path for the server (B)
+//   - Queues force writes to D and log appends during a tick
+//   - Submits them to the kernel in ONE io_uring_enter() at the end of the tick
+//   - Falls back to plain write()/fflush() when io_uring is unavailable, or
+//     for good if io_uring_enter() fails mid-run
+// ======================================================================
+
+#ifndef IOBATCH_H
+#define IOBATCH_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <linux/io_uring.h>
+
+#define IOB_FORCE_SLOTS   8          // max force writes queued per tick before an early submit
+#define IOB_FORCE_SLOT_SZ 64         // bytes reserved per force write (>= sizeof(ForceStateMsg))
+#define IOB_LOG_BUF_SZ    (64 * 1024) // registered log append buffer
+#define IOB_RING_ENTRIES  16
+
+// Per-window I/O statistics, reported next to the select() path.
+typedef struct {
+    long ticks;          // loop iterations in the window
+    long enters;         // io_uring_enter() calls
+    long direct_writes;  // write() calls issued by the fallback path
+    long selects;        // select() calls (counted by the server loop)
+    long syscr0, syscw0; // /proc/self/io counters at window start
+    long nvcsw0, nivcsw0;// getrusage() context switches at window start
+} IoBatchStats;
+
+typedef struct {
+    int enabled;                 // 1 = io_uring backend active, 0 = fallback path
+    int ring_fd;
+
+    // Submission queue ring (mmap'ed)
+    void     *sq_ring;
+    size_t    sq_ring_sz;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    struct io_uring_sqe *sqes;
+    size_t    sqes_sz;
+
+    // Completion queue ring (mmap'ed)
+    void     *cq_ring;
+    size_t    cq_ring_sz;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    unsigned sq_entries;         // SQEs usable per batch (<= IOB_RING_ENTRIES)
+    int      fixed_bufs;         // 1 if IORING_REGISTER_BUFFERS succeeded
+    int      last_err;           // last negative cqe->res / enter errno (next stats line)
+    unsigned queued;             // SQEs queued since last submit
+
+    // What each queued SQE writes (by SQ position), for the synchronous
+    // fallback if the ring fails before the kernel took it
+    struct {
+        int         fd;
+        const void *buf;
+        size_t      len;
+    } pending[IOB_RING_ENTRIES];
+
+    // Registered buffers (index 0 = force slots, index 1 = log buffer)
+    unsigned char force_buf[IOB_FORCE_SLOTS * IOB_FORCE_SLOT_SZ];
+    int           force_used;
+    char          log_buf[IOB_LOG_BUF_SZ];
+    size_t        log_len;
+    int           log_fd;        // real log file fd (writes at current file position)
+
+    FILE *real_log;              // FILE opened by open_process_log()
+    FILE *log;                   // FILE the server should log to (cookie FILE once enabled,
+                                 // kept until shutdown if the ring fails)
+
+    IoBatchStats st;
+    double syscalls_per_tick;    // last reported window
+    double ctxsw_per_tick;
+} IoBatch;
+
+// Sets up the backend. When want_uring is non-zero, tries io_uring and falls
+// back silently to plain syscalls if the kernel refuses (ENOSYS, EPERM, ...).
+// real_log is the server log; iob->log is the FILE to use from now on.
+void iob_init(IoBatch *iob, int want_uring, FILE *real_log);
+
+// Queues (uring) or performs (fallback) a write of a small message to fd.
+// Returns 0 on success, -1 on failure (fallback path only reports errors here).
+int  iob_write(IoBatch *iob, int fd, const void *buf, size_t len);
+
+// Ends one server tick: submits all queued writes and log appends in one syscall.
+void iob_end_tick(IoBatch *iob);
+
+// Called by the server loop around select() so it shows up in the stats.
+void iob_count_select(IoBatch *iob);
+
+// Writes a stats line every `window` ticks. Returns 1 if a line was written.
+int  iob_report(IoBatch *iob, long window);
+
+// Flushes everything and releases the ring. iob->log becomes the real log again.
+void iob_shutdown(IoBatch *iob);
+
+const char *iob_backend_name(const IoBatch *iob);
+
+#endif // IOBATCH_H
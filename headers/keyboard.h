@@ -7,7 +7,7 @@
 
 // Runs the keyboard process:
 //   - Reads from stdin
-//   - Sends KeyMsg to B via write_fd
+//   - Sends one KeyBatchMsg per read() to B via write_fd
 void run_keyboard_process(int write_fd);
 
 #endif // KEYBOARD_H
@@ -0,0 +1,95 @@
+// logcat.h
+// Categorized hot-path logging for B
+//   - categories (state, force, keys, entity) each with a level threshold,
+//     1-in-N sampling, an optional "only on change" filter and a rate limit
+//   - LOGC() checks the category before formatting or evaluating arguments;
+//     categories/levels stripped at compile time (LOGC_MAX_LEVEL,
+//     LOGC_COMPILED_MASK) compile to nothing
+//   - runtime changes: SIGHUP re-reads the log_* keys of params.txt, and
+//     controllers can send CTRL_LOG on the control socket (arp1_ctrl log)
+// ======================================================================
+
+#ifndef LOGCAT_H
+#define LOGCAT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "params.h"
+
+typedef enum {
+    LOGC_STATE = 0,   // per-tick D states
+    LOGC_FORCE,       // force commands sent / held
+    LOGC_KEYS,        // key batches and ignored keys
+    LOGC_ENTITY,      // obstacle / target sets accepted or rejected
+    LOGC_COUNT
+} LogCat;
+
+#define LOGC_NAMES { "state", "force", "keys", "entity" }   // by LogCat
+
+typedef enum {
+    LOGL_OFF = 0,
+    LOGL_INFO,
+    LOGL_DEBUG,
+    LOGL_TRACE
+} LogLevel;
+
+// Compile-time stripping, e.g. make LOG_FLAGS="-DLOGC_MAX_LEVEL=1"
+#ifndef LOGC_MAX_LEVEL
+#define LOGC_MAX_LEVEL LOGL_TRACE
+#endif
+#ifndef LOGC_COMPILED_MASK
+#define LOGC_COMPILED_MASK 0xFFu   // bit c = category c compiled in
+#endif
+
+typedef struct {
+    int      level;        // LogLevel threshold
+    int      every;        // keep 1 line in `every` (1 = all)
+    int      on_change;    // 1 = skip a line whose key equals the last one written
+    double   rate;         // lines per second (0 = unlimited), burst of one second
+
+    long     seen;         // lines that passed the level check
+    long     written;
+    long     sampled_out;  // dropped by `every` / on_change
+    long     limited;      // dropped by the rate limit (current report window)
+    long     limited_total;
+    double   tokens;
+    double   last_refill;
+    uint64_t last_key;
+    int      have_key;
+} LogCatState;
+
+extern LogCatState g_logc[LOGC_COUNT];
+
+#define LOGC_ON(cat, lvl) \
+    ((lvl) <= LOGC_MAX_LEVEL && ((LOGC_COMPILED_MASK >> (cat)) & 1u) && (lvl) <= g_logc[cat].level)
+
+// key: fingerprint of the line's values for on_change (0 if unused)
+#define LOGC(cat, lvl, key, ...)                                              \
+    do {                                                                      \
+        if (LOGC_ON(cat, lvl) && logc_admit(cat, key)) logc_printf(__VA_ARGS__); \
+    } while (0)
+
+// Sets the output and the per-category settings from params.
+void logc_init(FILE *out, const SimParams *p);
+void logc_configure(const SimParams *p);
+
+// Changes one category (cat < 0: all). every < 1 / rate < 0 keep the current value.
+void logc_set(int cat, int level, int every, double rate);
+
+// Sampling, change filter and rate limit. Returns 1 if the line is written.
+int  logc_admit(LogCat cat, uint64_t key);
+void logc_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+// Re-reads the log_* keys of a params file (SIGHUP). Returns 0 on success.
+int  logc_reload(const char *path, SimParams *p);
+
+// Once per second: one line per category that lost lines to its rate limit.
+void logc_report(double now);
+
+const char *logc_name(int cat);
+int         logc_from_name(const char *name);   // -1 = unknown, LOGC_COUNT = "all"
+
+// Fingerprint helper for on_change (values rounded to the printed precision).
+uint64_t logc_key4(double a, double b, double c, double d, double scale);
+
+#endif // LOGCAT_H
@@ -11,21 +11,20 @@
 #define MAX_TARGETS   8
 
 // Defines message: Keyboard -> Server (I -> B)
-// Contains exactly one key pressed by the user.
+// Contains every key read from the TTY in one wakeup (one write per batch).
+// Repeated directional presses are coalesced into one event with a count.
+#define KEY_BATCH_MAX 32
 
 typedef struct {
-    char key;   // e.g. 'w', 'e', 'd', 'R', 'q', ...
-} KeyMsg;
-
-
-// Defines message: Server -> Dynamics (B -> D)
-// Contains the commanded force and a reset flag.
+    char          key;    // e.g. 'w', 'e', 'd', 'O', 'q', ...
+    unsigned char count;  // consecutive presses coalesced into this event (>= 1)
+    long long     t_ns;   // CLOCK_MONOTONIC time the first press was read
+} KeyEvent;
 
 typedef struct {
-    double Fx;   // total commanded force in x
-    double Fy;   // total commanded force in y
-    int    reset; // 0 = normal, 1 = reset state in D
-} ForceStateMsg;
+    int      n;                    // valid events in ev[]
+    KeyEvent ev[KEY_BATCH_MAX];
+} KeyBatchMsg;
 
 
 // Defines message: Dynamics -> Server (D -> B)
@@ -36,6 +35,21 @@ typedef struct {
     double vx, vy;  // velocity
 } DroneStateMsg;
 
+
+// Defines message: Server -> Dynamics (B -> D)
+// Contains the commanded force and a reset flag.
+#define FORCE_NORMAL      0
+#define FORCE_RESET       1   // D resets its state to zero
+#define FORCE_ADOPT_STATE 2   // D continues from `state` (hot-standby sync)
+#define FORCE_PROMOTE     3   // as FORCE_ADOPT_STATE, and the replica becomes the primary D
+
+typedef struct {
+    double Fx;   // total commanded force in x
+    double Fy;   // total commanded force in y
+    int    reset; // FORCE_NORMAL, FORCE_RESET, FORCE_ADOPT_STATE or FORCE_PROMOTE
+    DroneStateMsg state; // only read with FORCE_ADOPT_STATE / FORCE_PROMOTE
+} ForceStateMsg;
+
 // Defines message: Obstacles -> Server (O -> B)
 typedef struct {
     double x;
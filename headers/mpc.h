@@ -0,0 +1,79 @@
+// mpc.h
+// Sampling model-predictive autopilot (MPPI) run by B
+//   - every D tick: samples force sequences around the previous plan, rolls
+//     them all out over mpc_horizon ticks with D's model (M, K, walls) plus
+//     the obstacle repulsion B adds, and applies the first force of the
+//     cost-weighted average plan
+//   - rollout state is kept as structure-of-arrays with the sample index
+//     innermost, so every step is one vectorizable loop over all samples
+//   - the sample count adapts so a plan fits in MPC_BUDGET_FRAC of a tick
+//   - precision: rollout state and noise are mpc_real, float32 when built
+//     with make MPC_PRECISION=32 (twice the SIMD lanes, half the bytes);
+//     costs, weights and the plan itself stay double
+// ======================================================================
+
+#ifndef MPC_H
+#define MPC_H
+
+#include <stdio.h>
+#include "messages.h"
+#include "params.h"
+#include "ecs.h"
+#include "obstacles.h"   // NUM_OBSTACLES
+
+#define MPC_MAX_SAMPLES 1024
+#define MPC_MIN_SAMPLES 32
+#define MPC_MAX_HORIZON 64
+#define MPC_BUDGET_FRAC 0.25   // share of one tick (dt / time_scale) a plan may use
+
+#ifdef MPC_FLOAT32
+typedef float  mpc_real;
+#define MPC_PRECISION_NAME "f32"
+#else
+typedef double mpc_real;
+#define MPC_PRECISION_NAME "f64"
+#endif
+
+typedef struct {
+    int      active;            // autopilot engaged
+    int      samples;           // current sample count (adapts to the budget)
+    int      horizon;
+    unsigned long long rng;     // xorshift state for the exploration noise
+
+    double   ux[MPC_MAX_HORIZON], uy[MPC_MAX_HORIZON];   // nominal plan (warm start)
+
+    // Per-sample rollout state: [sample]
+    mpc_real x[MPC_MAX_SAMPLES], y[MPC_MAX_SAMPLES];
+    mpc_real vx[MPC_MAX_SAMPLES], vy[MPC_MAX_SAMPLES];
+    mpc_real fx[MPC_MAX_SAMPLES], fy[MPC_MAX_SAMPLES];   // scratch: force this step
+    double   cost[MPC_MAX_SAMPLES];                      // accumulated over the horizon
+    double   w[MPC_MAX_SAMPLES];
+
+    // Exploration noise: [step][sample]
+    mpc_real ex[MPC_MAX_HORIZON][MPC_MAX_SAMPLES];
+    mpc_real ey[MPC_MAX_HORIZON][MPC_MAX_SAMPLES];
+
+    // Throughput (rollouts per millisecond is the figure of merit)
+    double   last_ms;           // wall time of the last plan
+    long     plans;
+    double   win_start, win_ms, win_max_ms;
+    long     win_plans, win_rollouts;
+    double   rollouts_per_ms;   // last report window
+    size_t   plan_bytes;        // rollout arrays touched by the last plan
+} Mpc;
+
+void mpc_init(Mpc *m, const SimParams *p);
+
+// Engages / disengages the autopilot (the plan is reset on engage).
+void mpc_set_active(Mpc *m, int on, FILE *log);
+
+// Plans from cur_state and writes the force to apply now into *user_force.
+// Aims at the nearest target; without one it brakes to a stop.
+void mpc_plan(Mpc *m, const DroneStateMsg *cur_state, const SimParams *p,
+              const EcsArchetype *obs, const EcsArchetype *tgt,
+              ForceStateMsg *user_force);
+
+// Logs plans, samples and rollouts/ms once per second of wall time.
+void mpc_report(Mpc *m, double now, FILE *log);
+
+#endif // MPC_H
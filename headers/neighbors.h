@@ -0,0 +1,53 @@
+// neighbors.h
+// Verlet neighbor lists for B's per-tick entity queries
+//   - one list per query: obstacles within the repulsion radius
+//     (OBS_CLEARANCE_FRAC) for force sends, targets within the hit radius
+//     (TARGET_HIT_FRAC) for hit checks
+//   - a list holds the rows (of B's ECS archetype) within radius + skin of
+//     the drone at build time and is reused until the drone has moved more
+//     than half the skin or the entity set changed, so most ticks only look
+//     at a handful of entities instead of every row
+//   - the entity set version is the world hash group of the entities
+//     (worldhash.h): it changes whenever a slot is filled, moves or empties,
+//     which is also the only time rows are added, removed or reordered
+//   - candidates keep row order, so results are bit-identical to a full scan
+//   - nbr_skin = 0 turns the lists off (every query scans every row)
+// ======================================================================
+
+#ifndef NEIGHBORS_H
+#define NEIGHBORS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define NBR_MAX_SLOTS 64   // >= NUM_OBSTACLES, NUM_TARGETS
+
+typedef struct {
+    const char *name;
+    int         idx[NBR_MAX_SLOTS];   // candidate rows, ascending
+    int         n;
+    int         valid;
+    int         off;                  // last query ran with skin 0 (full scan)
+    double      x0, y0;               // drone position at the last build
+    double      radius;               // query radius used for that build
+    uint64_t    version;              // entity set version at that build
+
+    // Stats (since start / since the last report)
+    long queries, rebuilds, rebuilds_moved, rebuilds_changed;
+    long slots_checked;               // per query: candidates (hit) or every slot (rebuild)
+    long rep_queries, rep_rebuilds, rep_checked;
+    double rep_start;
+} NbrList;
+
+void nbr_init(NbrList *l, const char *name);
+
+// Candidate rows of the points (xs[i], ys[i]), i < count, for a query of
+// `radius` around (x, y). Rebuilds the list first if needed. Returns the
+// number of rows in l->idx.
+int  nbr_query(NbrList *l, double x, double y, double radius, double skin,
+               const double *xs, const double *ys, int count, uint64_t version);
+
+// Every 10 s and at exit (final = 1): hit rate, rebuilds, slots checked per query.
+void nbr_report(NbrList *l, double now, int final, FILE *log);
+
+#endif // NEIGHBORS_H
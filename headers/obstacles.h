@@ -7,15 +7,7 @@
 
 
 #define NUM_OBSTACLES 12 // Defines number of obstacles
-
-typedef struct {
-    double x;
-    double y;
-    int    active;      // 1 = currently present, 0 = off
-    int    life_steps;  // Indicates how many state updates left before disappearing
-} Obstacle;
-
-extern Obstacle g_obstacles[NUM_OBSTACLES];
+#define OBS_SPAWN_INTERVAL_SEC 45   // simulated seconds between batches (40 did good visually, test more)
 
 // Runs the obstacle process:
 //   - fd_write     : write-end of pipe O->B
@@ -17,6 +17,45 @@ typedef struct {
     double wall_gain;      // Strength of repulsive force
     int   wd_warn_sec;    // Watchdog warning timeout (sec)
     int   wd_kill_sec;    // Watchdog kill timeout (sec)
+
+    int   io_uring;       // 1 = B batches force writes/log appends through io_uring (falls back if unavailable)
+
+    double time_scale;      // Simulated seconds per wall second (D, O, T sleep dt / time_scale)
+    double soak_sim_sec;    // Soak mode: headless run for this many simulated seconds (0 = off)
+    double soak_sample_sec; // Soak mode: wall seconds between resource samples
+
+    int   telemetry;      // 1 = B records one row per D tick under logs/telemetry/
+
+    int   standby_d;          // 1 = B runs a hot-standby D replica and fails over to it
+    int   standby_miss_ticks; // primary silent for this many ticks -> failover
+
+    int    peer_max_restarts; // B restarts a dead O/T process at most this many times
+    double peer_restart_sec;  // delay before the first restart (doubles after each one)
+
+    double force_epsilon;       // B sends a force command only if Fx or Fy moved more than this
+    double force_keepalive_sec; // ... or this much simulated time passed since the last send
+
+    int   render_full;    // 1 = repaint the whole screen every frame (0 = incremental)
+
+    int    ctrl_socket;      // 1 = B accepts external controllers on logs/ctrl.sock
+    double ctrl_timeout_sec; // owner silent this long -> control back to the keyboard
+
+    int    mpc_samples;    // autopilot: sampled force sequences per plan (upper bound)
+    int    mpc_horizon;    // autopilot: planning horizon in D ticks
+    double mpc_sigma;      // autopilot: exploration noise (N, per axis)
+    double mpc_max_force;  // autopilot: force limit per axis (N)
+
+    int    log_state;            // log levels per category: 0 off, 1 info, 2 debug, 3 trace
+    int    log_force;
+    int    log_keys;
+    int    log_entity;
+    int    log_state_every;      // write 1 STATE line in N
+    int    log_state_on_change;  // 1 = skip STATE lines equal to the last one written
+    double log_rate;             // per-category limit (lines/s, 0 = unlimited)
+
+    double nbr_skin;       // neighbor-list skin (world units, 0 = scan every entity each query)
+
+    int    perf_counters;  // 1 = hardware counters per loop phase in B and D (perfctr.h)
 } SimParams;
 
 // Sets default values- just in case params.txt is not found
@@ -25,4 +64,7 @@ void init_default_params(SimParams *p);
 // Overrides default values with values from params.txt, if present.
 void load_params_from_file(const char *filename, SimParams *p);
 
+// Sets one parameter by name. Returns 0 on success, -1 if the key is unknown.
+int set_param_by_name(SimParams *p, const char *key, double d);
+
 #endif // PARAMS_H
@@ -0,0 +1,76 @@
+// perfctr.h
+// Hardware performance counters per loop phase (perf_event_open)
+//   - perf_counters = 1: B and D each open one counter group (cycles,
+//     instructions, cache misses, branch misses, context switches) on their
+//     loop thread, user space only
+//   - pc_lap(phase) reads the whole group with one read() and charges the
+//     counts since the previous lap to `phase`, so consecutive laps split
+//     the loop into phases with nothing left out
+//   - per-phase totals go to the process log every PC_REPORT_SEC and at
+//     exit, and to logs/perf_<role>.tsv at exit
+//   - counters the kernel refuses (perf_event_paranoid, no PMU in a VM,
+//     seccomp) are left out of the group; with none left pc_lap() returns
+//     at once and the log says why
+// ======================================================================
+
+#ifndef PERFCTR_H
+#define PERFCTR_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define PC_MAX_PHASES 8
+#define PC_REPORT_SEC 10.0
+#define PC_TSV_FMT    "logs/perf_%s.tsv"
+
+typedef enum {
+    PC_CYCLES = 0,
+    PC_INSTRUCTIONS,
+    PC_CACHE_MISSES,
+    PC_BRANCH_MISSES,
+    PC_CTX_SWITCHES,
+    PC_EVENT_COUNT
+} PcEvent;
+
+typedef struct {
+    long     laps;
+    double   wall_sec;
+    uint64_t v[PC_EVENT_COUNT];
+} PcPhase;
+
+typedef struct {
+    const char  *role;                 // "B", "D" (log tag and TSV name)
+    const char *const *names;          // phase names
+    int          n_phases;
+
+    int          leader;               // group leader fd, -1 = disabled
+    int          fd[PC_EVENT_COUNT];   // -1 = not counted
+    int          pos[PC_EVENT_COUNT];  // index in the group read, -1 = not counted
+    int          err[PC_EVENT_COUNT];  // errno of a refused counter
+    int          n;                    // counters in the group
+
+    uint64_t     last[PC_EVENT_COUNT];
+    uint64_t     enabled, running;     // group times at the last lap (multiplexing)
+    uint64_t     enabled0, running0;   // at open
+    double       last_wall;
+
+    PcPhase      total[PC_MAX_PHASES];
+    PcPhase      window[PC_MAX_PHASES];
+    double       rep_start;
+} PerfCounters;
+
+// Opens the group when `enable` is set and logs the counters it got (or why
+// none). Returns the number of counters; 0 leaves pc disabled.
+int  pc_open(PerfCounters *pc, const char *role, const char *const *phase_names,
+             int n_phases, int enable, FILE *log);
+
+// Charges the counts since the previous lap (or pc_open) to `phase`.
+void pc_lap(PerfCounters *pc, int phase);
+
+// Last window's phases every PC_REPORT_SEC (now = monotonic seconds);
+// final = 1 prints the totals and writes the TSV.
+void pc_report(PerfCounters *pc, double now, int final, FILE *log);
+
+void pc_close(PerfCounters *pc);
+
+#endif // PERFCTR_H
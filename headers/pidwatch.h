@@ -0,0 +1,50 @@
+// pidwatch.h
+// Process-exit detection with pidfds
+//   - pidfd_open() gives an fd that becomes readable the moment its process
+//     exits (crash included), so an exit wakes the owner's select()/poll()
+//     at once instead of after a heartbeat timeout or a pipe EOF
+//   - the exit reason is read without reaping (waitid WNOWAIT) when the
+//     process is our child, else from its zombie's /proc/<pid>/stat; the
+//     existing reap paths (channels, standby, final wait) stay as they are
+//   - kernels without pidfds (< 5.3) make pw_add() fail with ENOSYS: the
+//     owner logs it once and keeps the heartbeat / EOF detection
+// ======================================================================
+
+#ifndef PIDWATCH_H
+#define PIDWATCH_H
+
+#include <sys/select.h>
+#include <sys/types.h>
+
+#define PW_MAX 8
+
+typedef struct {
+    const char *name[PW_MAX];   // component letter ("D", "W", ...)
+    pid_t       pid[PW_MAX];
+    int         fd[PW_MAX];     // pidfd, -1 = free entry
+    int         n;
+} PidWatch;
+
+void pw_init(PidWatch *w);
+
+// Watches pid under name (replaces the entry of that name unless it has the
+// same pid). pid <= 0 only drops the old entry. Returns 0, or -1 with errno (ENOSYS: no pidfds).
+int  pw_add(PidWatch *w, const char *name, pid_t pid);
+void pw_remove(PidWatch *w, const char *name);
+
+// Adds every pidfd to a select() set and raises *maxfd (like chan_watch).
+void pw_watch(const PidWatch *w, fd_set *set, int *maxfd);
+
+// Next watched process that has exited (among the fds ready in `set` if
+// given, else all; each is confirmed with a non-blocking poll): its entry
+// is dropped and its name and pid returned.
+// Returns 0, or -1 if none.
+int  pw_next_exit(PidWatch *w, const fd_set *set, const char **name, pid_t *pid);
+
+// "exit status N", "killed by SIGSEGV (core dumped)", ... or "exited" when
+// the reason is gone (already reaped). The process must have exited.
+void pw_exit_reason(pid_t pid, char *buf, size_t len);
+
+void pw_close(PidWatch *w);
+
+#endif // PIDWATCH_H
@@ -0,0 +1,83 @@
+// pool.h
+// Warm session pool (arp1 --pool K / arp1 --attach)
+//   - the pool daemon keeps K worlds fully launched and parked: each world
+//     is a B process with its own session and directory (sessions/<n>/),
+//     channels created and I, D, O, T, W forked, every component blocked
+//     on its gate before it opens a log or touches the terminal
+//   - a session (arp1 --attach) connects to POOL_SOCKET_PATH and passes its
+//     stdin/stdout/stderr with SCM_RIGHTS; the first parked world accepts,
+//     hands the fds to every component through the gates and starts, and
+//     the daemon forks a replacement in the background
+//   - time to first tick (main() entry to B's first D state) is logged by
+//     B for cold starts and pooled sessions alike, and printed by --attach
+// ======================================================================
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include "topology.h"
+
+#define POOL_SOCKET_PATH  "logs/pool.sock"
+#define POOL_SESSION_DIR  "sessions"    // worlds run in sessions/<n>/ (own logs/)
+#define POOL_MAX          16
+#define POOL_MAGIC        0x41525031u   // "ARP1"
+
+// Session -> world (with SCM_RIGHTS: stdin, stdout, stderr)
+typedef struct {
+    uint32_t magic;
+    uint32_t reserved;
+    double   t_start;       // CLOCK_MONOTONIC at the session's main() entry
+    char     term[64];      // session's TERM (ncurses)
+} PoolClaimMsg;
+
+// World -> session
+typedef enum {
+    POOL_CLAIMED = 1,       // world started for this session
+    POOL_FIRST_TICK,        // us = time to first tick
+    POOL_DONE               // world finished (B and children reaped), status = exit status
+} PoolReplyType;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t type;          // PoolReplyType
+    int32_t  pid;           // world's B (also its process group)
+    int32_t  session;       // n in sessions/<n>/
+    double   us;
+    int32_t  status;        // POOL_DONE: world's exit status
+    int32_t  reserved;
+} PoolReplyMsg;
+
+// Every run: main() entry time, the start of time to first tick.
+void pool_mark_start(void);
+
+// Builds and runs one world (channels, launch, B); returns its exit status.
+typedef int (*PoolWorldMain)(void);
+
+// Pool daemon: keeps k worlds parked until SIGINT/SIGTERM, then stops the
+// parked ones (claimed sessions keep running). Returns the exit status.
+int  pool_run(int k, PoolWorldMain world);
+
+// Pooled world only (no-ops for a cold start):
+// - pool_world_init: own session, directory and component gates; call
+//   after the setup that reads files from the working directory
+// - pool_park: first call of every component entry; blocks until claimed
+//   and puts the session's terminal on fds 0-2
+// - pool_claim: B after topo_launch; blocks until a session claims the world
+// - pool_finish: B after reaping its children; tells the session the status
+void pool_world_init(Topology *t);
+void pool_park(ComponentId id);
+void pool_claim(void);
+void pool_finish(int exit_status);
+
+// B's first tick: logs the time since the start (and tells the session).
+void pool_first_tick(FILE *log);
+
+// arp1 --attach: claims a parked world for this terminal, waits for it to
+// finish and prints claim and first-tick times. Returns the world's exit
+// status (failure if the world went away without POOL_DONE).
+int  pool_attach(void);
+
+#endif // POOL_H
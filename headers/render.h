@@ -0,0 +1,63 @@
+// render.h
+// ncurses drawing of the drone world (shared by B and arp1_renderbench)
+//   - RENDER_INCREMENTAL: ncurses sends only the cells that changed
+//   - RENDER_FULL:        the whole screen is repainted every frame
+// ======================================================================
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "messages.h"
+#include "params.h"
+#include "ecs.h"
+#include "trail.h"
+
+// Color pairs set up by render_init_colors()
+#define RENDER_PAIR_OBSTACLE 1
+#define RENDER_PAIR_TARGET   2
+#define RENDER_PAIR_WARNING  3
+
+typedef enum {
+    RENDER_INCREMENTAL = 0,
+    RENDER_FULL        = 1
+} RenderMode;
+
+// Cell rectangle of the world view (rows [top, top+height), cols [left, left+width))
+typedef struct {
+    int top;
+    int left;
+    int height;
+    int width;
+} RenderRect;
+
+// Maps a world position to a cell inside the area (clamped to its border);
+// sx, sy are cells per world unit.
+static inline void render_cell(const RenderRect *a, double sx, double sy,
+                               double x, double y, int *row, int *col) {
+    int c = (int)(x * sx) + a->width / 2 + a->left;
+    int r = (int)(-y * sy) + a->top + a->height / 2;
+
+    if (c < a->left) c = a->left;
+    if (c > a->left + a->width - 1) c = a->left + a->width - 1;
+    if (r < a->top) r = a->top;
+    if (r > a->top + a->height - 1) r = a->top + a->height - 1;
+    *row = r;
+    *col = c;
+}
+
+// Color pairs for obstacles, targets and warnings (no-op without color support).
+void render_init_colors(void);
+
+// Draws trail (optional, may be NULL), drone, and the world's obstacles and targets.
+void render_world(const RenderRect    *area,
+                  double               world_half,
+                  const DroneStateMsg *drone,
+                  const EcsWorld      *world,
+                  const Trail         *trail);
+
+// Pushes the frame to the terminal with the given mode.
+void render_present(RenderMode mode);
+
+const char *render_mode_name(RenderMode mode);
+
+#endif // RENDER_H
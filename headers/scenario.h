@@ -0,0 +1,93 @@
+// scenario.h
+// Scenario files: reproducible worlds for benchmarks and regressions
+//   - initial drone state, parameter overrides, RNG seed
+//   - timed obstacle and target waves (replace the random O/T generators)
+//   - scripted key track and expected outcomes
+//   - timed fault injections (builds with FAULTS=1, see faults.h)
+// All times are in D ticks: B fires an event when it has received that many
+// D states. D free-runs and drains forces without blocking, so the D step
+// that first feels a scripted key or wave can still shift with scheduling;
+// runs usually match, but replays are not guaranteed to be identical.
+// ======================================================================
+
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stdio.h>
+#include "messages.h"
+#include "params.h"
+
+#define SCN_MAX_WAVES   64    // obstacle waves and target waves (each)
+#define SCN_MAX_KEYS    512   // scripted key events
+#define SCN_MAX_EXPECTS 8
+#define SCN_MAX_FAULTS  32    // timed fault settings
+
+typedef struct {
+    int            tick;      // tick at which the wave replaces the current set
+    ObstacleSetMsg set;
+} ScnObstacleWave;
+
+typedef struct {
+    int          tick;
+    TargetSetMsg set;
+} ScnTargetWave;
+
+typedef struct {
+    int  tick;
+    char key;                 // same keys as the keyboard ('f', 'p', 'O', ...)
+} ScnKey;
+
+typedef struct {
+    int    tick;
+    int    id;                // FaultId
+    double value;             // 0 = off
+} ScnFault;
+
+typedef enum { SCN_METRIC_SCORE = 0, SCN_METRIC_COLLECTED } ScnMetric;
+typedef enum { SCN_OP_GE = 0, SCN_OP_LE, SCN_OP_EQ } ScnOp;
+
+typedef struct {
+    ScnMetric metric;
+    ScnOp     op;
+    int       value;
+} ScnExpect;
+
+typedef struct {
+    int  loaded;              // 1 once a scenario was loaded
+    char path[256];
+    char name[64];
+
+    int      has_seed;
+    unsigned seed;
+
+    int           has_drone;
+    DroneStateMsg drone;      // initial drone state
+
+    int             n_obstacle_waves;
+    ScnObstacleWave obstacle_waves[SCN_MAX_WAVES];
+    int             n_target_waves;
+    ScnTargetWave   target_waves[SCN_MAX_WAVES];
+
+    int    n_keys;
+    ScnKey keys[SCN_MAX_KEYS];
+
+    int      n_faults;
+    ScnFault faults[SCN_MAX_FAULTS];
+
+    int       end_tick;       // 0 = run until quit
+    int       n_expects;
+    ScnExpect expects[SCN_MAX_EXPECTS];
+} Scenario;
+
+// mmap()s and parses a scenario file, validates it against params, and applies
+// its parameter overrides to params. Exits with a message on any error.
+void scenario_load(const char *path, SimParams *params);
+
+// Returns the loaded scenario, or NULL if the run is not scenario-driven.
+// Set before the components are launched, so every process/thread sees it.
+const Scenario *scenario_active(void);
+
+// Checks the expected outcomes. Returns 1 if all pass; writes one line per check to log.
+int scenario_check_expects(const Scenario *scn, int score, int collected, FILE *log);
+
+#endif // SCENARIO_H
@@ -7,6 +7,7 @@
 
 #include <sys/types.h>   // for pid_t
 #include "params.h"
+#include "watchdog.h"    // WatchPids
 
 // Runs the server process:
 //   - fd_kb     : read-end of pipe I->B
@@ -14,10 +15,13 @@
 //   - fd_from_d : read-end of pipe D->B
 //   - fd_obs    : read-end of pipe O->B
 //   - fd_tgt    : read-end of pipe T->B
+//   - fd_to_w   : write-end of the watchdog config channel (pid updates)
+//   - peers     : pids of B, I, D, O, T as sent to W (B's pid for threads)
 //   - pid_W     : watchdog PID (heartbeat target)
 //   - params    : simulation parameters
-void run_server_process(int fd_kb, int fd_to_d, int fd_from_d,
+// Returns the exit status (the caller reaps the children).
+int  run_server_process(int fd_kb, int fd_to_d, int fd_from_d,
                         int fd_obs, int fd_tgt,
-                        pid_t pid_W,
+                        int fd_to_w, WatchPids peers, pid_t pid_W,
                         SimParams params);
 #endif // SERVER_H
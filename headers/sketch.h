@@ -0,0 +1,35 @@
+// sketch.h
+// Mergeable quantile sketch (DDSketch-style log buckets)
+//   - relative-error guarantee: every quantile is within SKETCH_ALPHA of a true sample value
+//   - fixed memory (no allocation), O(1) insert, merge = bucket-wise sum
+//   - used to combine latency / time-to-target distributions across sessions
+// ======================================================================
+
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#define SKETCH_ALPHA    0.01    // 1% relative accuracy
+#define SKETCH_BUCKETS  2048    // covers ~[1e-4, 1e+13] at 1% accuracy
+#define SKETCH_MIN_VAL  1e-4    // values below this land in the zero bucket
+
+typedef struct {
+    long   counts[SKETCH_BUCKETS];
+    long   zero_count;          // values in [0, SKETCH_MIN_VAL)
+    long   n;
+    double min, max, sum;
+} QuantileSketch;
+
+void   sketch_init(QuantileSketch *s);
+
+// Adds one non-negative value (negative values are ignored).
+void   sketch_add(QuantileSketch *s, double v);
+
+// dst += src. Sketches of any sessions/threads can be merged in any order.
+void   sketch_merge(QuantileSketch *dst, const QuantileSketch *src);
+
+// Returns the q-quantile (0 <= q <= 1), or 0 for an empty sketch.
+double sketch_quantile(const QuantileSketch *s, double q);
+
+double sketch_mean(const QuantileSketch *s);
+
+#endif // SKETCH_H
@@ -0,0 +1,87 @@
+// soak.h
+// Accelerated-time soak test mode (headless B)
+//   - Runs the full topology for hours/days of simulated time
+//   - Samples memory, fd counts, log size, tick latency and tick-rate drift
+//   - Writes a trend report with pass/fail thresholds (logs/soak_report.txt)
+// ======================================================================
+
+#ifndef SOAK_H
+#define SOAK_H
+
+#include <stdio.h>
+#include <sys/types.h>
+#include "params.h"
+
+#define SOAK_MAX_SAMPLES   4096     // samples kept for the trend report
+#define SOAK_LAT_WINDOW    65536    // inter-tick intervals kept per sample window
+#define SOAK_INPUT_PERIOD  40       // ticks between random key presses
+#define SOAK_REPORT_PATH   "logs/soak_report.txt"
+#define SOAK_DEFAULT_TIME_SCALE 60.0  // --soak without --time-scale: one sim hour per wall minute
+
+// Pass/fail thresholds
+#define SOAK_MAX_RSS_SLOPE_KB    512.0  // RSS growth per simulated hour (whole process tree)
+#define SOAK_MAX_FD_GROWTH       0      // open fds at the end vs. the first sample
+#define SOAK_MAX_DRIFT_PCT       10.0   // |tick rate - expected| / expected
+#define SOAK_MAX_P99_FACTOR      3.0    // p99 inter-tick interval vs. nominal interval
+#define SOAK_MAX_LOG_RATE_GROWTH 1.5    // last/first window log bytes per tick
+#define SOAK_NEAR_MISS_FRACTION  0.5    // heartbeat gap >= this * wd_warn_sec is a near-miss
+
+typedef struct {
+    double sim_hours;       // simulated time at the sample
+    double wall_sec;        // wall time since start
+    long   rss_kb;          // B + children
+    int    fds;             // B + children
+    long   log_bytes;       // logs/*.log total size
+    double log_bytes_per_tick;
+    double p50_ms, p99_ms, max_ms;   // inter-tick interval in this window
+    double tick_rate;       // ticks per wall second in this window
+    double drift_pct;       // vs. expected time_scale / dt
+    int    near_misses;     // in this window
+} SoakSample;
+
+typedef struct {
+    double dt;              // simulated seconds per tick
+    double sim_sec_target;  // stop after this much simulated time
+    double sample_sec;      // wall seconds between samples
+    double nominal_ms;      // expected inter-tick interval (dt / time_scale)
+    double expected_rate;   // expected ticks per wall second
+    double near_miss_ms;
+
+    double start_wall;
+    double last_sample_wall;
+    double last_tick_wall;
+    long   ticks;
+    long   window_ticks;
+    long   window_start_log_bytes;
+
+    double lat_ms[SOAK_LAT_WINDOW];
+    int    n_lat;
+    int    window_near_misses;
+
+    int        n_samples;
+    SoakSample samples[SOAK_MAX_SAMPLES];
+
+    unsigned rng;           // random input generator state
+
+    int    proc_fd, logs_fd;  // /proc and logs/, listed on every sample (-1 = unavailable)
+} SoakMonitor;
+
+// Prepares the monitor from params (soak_sim_sec, soak_sample_sec, time_scale, dt).
+void soak_init(SoakMonitor *m, const SimParams *p, double now_wall);
+
+// Records the arrival of one D state at wall time now.
+void soak_on_tick(SoakMonitor *m, double now_wall);
+
+// Takes a sample if sample_sec elapsed. Returns 1 if a sample was taken.
+int  soak_maybe_sample(SoakMonitor *m, double now_wall, FILE *log);
+
+// Returns 1 once the target simulated time was reached.
+int  soak_done(const SoakMonitor *m, const SimParams *p);
+
+// Returns a random key for the headless input track, or 0 for "no key this tick".
+char soak_random_key(SoakMonitor *m);
+
+// Takes a final sample, writes the report, returns 1 if every threshold passed.
+int  soak_finish(SoakMonitor *m, const SimParams *p, double now_wall, FILE *log);
+
+#endif // SOAK_H
@@ -0,0 +1,56 @@
+// standby.h
+// Hot-standby dynamics replica (optional, standby_d = 1)
+//   - B forks a second D that receives the same force stream
+//   - the replica's states are drained and kept as a shadow; every
+//     STANDBY_SYNC_TICKS B re-syncs it to the authoritative state
+//   - if the primary misses its deadline, B promotes the replica within
+//     one tick and forks a new standby
+// ======================================================================
+
+#ifndef STANDBY_H
+#define STANDBY_H
+
+#include <stdio.h>
+#include <sys/types.h>
+#include "messages.h"
+#include "params.h"
+#include "iobatch.h"
+
+#define STANDBY_SYNC_TICKS 20     // primary ticks between state syncs
+#define STANDBY_MAX_SPAWNS 16     // replicas B may fork over a run
+
+typedef struct {
+    int    enabled;          // params.standby_d
+    pid_t  pid;              // replica pid, -1 when none is running
+    int    fd_force;         // B -> replica (write end)
+    int    fd_state;         // replica -> B (read end, non-blocking)
+    int    generation;       // replicas forked so far
+
+    DroneStateMsg shadow;    // latest replica state
+    long   shadow_ticks;     // replica states received since the last sync
+    double max_drift;        // largest |shadow - primary| position gap seen at a sync
+
+    int    failovers;
+    double last_switch_us;   // detection -> promoted (B-side work)
+} Standby;
+
+// Forks a new replica (logs to logs/dynamics_standby_<gen>.log). Returns 0 on success.
+int  standby_spawn(Standby *sb, const SimParams *p, FILE *log);
+
+// Reads every pending replica state (non-blocking). Returns -1 if the replica is gone.
+int  standby_drain(Standby *sb);
+
+// Makes the replica continue from `state` with force `f` (FORCE_ADOPT_STATE).
+void standby_sync(Standby *sb, IoBatch *iob, const ForceStateMsg *f,
+                  const DroneStateMsg *state, FILE *log);
+
+// Gives up the replica slot: fds and pid now belong to the caller (promotion).
+void standby_release(Standby *sb);
+
+// Stops the replica (closes its channel, kills and reaps it).
+void standby_stop(Standby *sb);
+
+// Kills and reaps a process-mode D that missed its deadline (no-op for thread D).
+void standby_retire_primary(pid_t pid);
+
+#endif // STANDBY_H
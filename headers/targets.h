@@ -8,15 +8,7 @@
 
 
 #define NUM_TARGETS 12  // Defines number of targets
-
-typedef struct {
-    double x;
-    double y;
-    int    active;      // 1 = visible, 0 = not
-    int    life_steps;  // Lifetime in steps
-} Target;
-
-extern Target g_targets[NUM_TARGETS];
+#define TGT_SPAWN_INTERVAL_SEC 50   // simulated seconds between batches
 
 // Runs the target process:
 //   - fd_write     : write-end of pipe T->B
@@ -0,0 +1,215 @@
+// telemetry.h
+// Per-session telemetry recordings (written by B, read by arp1_analyze)
+//   - one file per session: logs/telemetry/session_<date>_<pid>.tlm
+//   - fixed-size blocks of TLM_BLOCK_ROWS ticks, stored column by column,
+//     so a reader can mmap the file and scan only the columns it needs
+//   - next to it, session_<date>_<pid>.tlm.pyr: min/max/mean summaries of
+//     the numeric columns over 16, 256 and 4096 rows, built while recording,
+//     so an overview of any span reads O(width) summaries, not every row
+// ======================================================================
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "params.h"
+#include "worldhash.h"
+
+#define TLM_MAGIC       "ARPTLM1"
+#define TLM_VERSION     2   // 2: world hash columns
+#define TLM_BLOCK_ROWS  1024
+#define TLM_DIR         "logs/telemetry"
+
+// Columns (the order is the on-disk order inside every block)
+typedef enum {
+    TLM_COL_TICK = 0,   // int32   D tick index since start
+    TLM_COL_X,          // double  drone state
+    TLM_COL_Y,          // double
+    TLM_COL_VX,         // double
+    TLM_COL_VY,         // double
+    TLM_COL_FX,         // float   user force (keys), before obstacle/wall repulsion
+    TLM_COL_FY,         // float
+    TLM_COL_SCORE,      // int32
+    TLM_COL_COLLECTED,  // int32
+    TLM_COL_TICK_MS,    // float   wall time since the previous D state
+    TLM_COL_INPUT_MS,   // float   age of the oldest key batch applied this tick (-1 = none)
+    TLM_COL_FLAGS,      // uint8   TLM_FLAG_*
+    TLM_COL_HASH,       // uint64  world hash after this tick (worldhash.h)
+    TLM_COL_HASH_DRONE, // uint64  group hashes, in WhGroup order
+    TLM_COL_HASH_FORCE,
+    TLM_COL_HASH_OBS,
+    TLM_COL_HASH_TGT,
+    TLM_COL_HASH_SCORE,
+    TLM_COL_HASH_STREAMS,
+    TLM_COL_COUNT
+} TlmColumn;
+
+#define TLM_FLAG_PAUSED 0x01
+#define TLM_FLAG_CTRL   0x02   // an external controller had control
+
+// One tick as handed to the writer
+typedef struct {
+    int32_t tick;
+    double  x, y, vx, vy;
+    float   fx, fy;
+    int32_t score, collected;
+    float   tick_ms;
+    float   input_ms;
+    uint8_t flags;
+    uint64_t hash;
+    uint64_t group_hash[WH_COUNT];
+} TlmRow;
+
+// File header (followed by fixed-size blocks)
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t block_rows;
+    uint32_t n_columns;
+    uint32_t reserved;
+    double   dt;
+    double   world_half;
+    double   wall_clearance;
+    int64_t  start_unix;
+} TlmFileHeader;
+
+// Block header (followed by n_columns arrays of block_rows elements each)
+typedef struct {
+    uint32_t magic;      // TLM_BLOCK_MAGIC
+    uint32_t n_rows;     // valid rows (< block_rows only in the last block)
+} TlmBlockHeader;
+
+#define TLM_BLOCK_MAGIC 0x314B4C42u   // "BLK1"
+
+// Element size of each column
+extern const size_t TLM_COL_SIZE[TLM_COL_COUNT];
+
+// Size of one block on disk (header + all columns at full capacity)
+size_t tlm_block_bytes(void);
+
+// ---------------- Summary pyramid (.tlm.pyr) ----------------
+#define TLP_MAGIC         "ARPTLP1"
+#define TLP_VERSION       1
+#define TLP_SUFFIX        ".pyr"
+#define TLP_FANOUT        16    // rows per level-0 summary, summaries per next-level one
+#define TLP_LEVELS        3     // x16, x256, x4096 rows
+#define TLP_BLOCK_BUCKETS 64    // summaries per block on disk
+
+// Summarized columns (TLP_SERIES_COLS gives the TlmColumn of each)
+typedef enum {
+    TLP_S_X = 0, TLP_S_Y, TLP_S_VX, TLP_S_VY, TLP_S_FX, TLP_S_FY,
+    TLP_S_SCORE, TLP_S_COLLECTED, TLP_S_TICK_MS, TLP_S_INPUT_MS,
+    TLP_SERIES_COUNT
+} TlpSeries;
+
+extern const TlmColumn TLP_SERIES_COLS[TLP_SERIES_COUNT];
+extern const char     *TLP_SERIES_NAMES[TLP_SERIES_COUNT];
+
+typedef struct {
+    double   min, max, mean;   // 0 when n == 0
+    uint32_t n;                // rows with a value (input_ms < 0 has none)
+    uint32_t reserved;
+} TlpStat;
+
+// Summary of consecutive rows [first_row, first_row + rows)
+typedef struct {
+    int64_t  first_row;
+    int32_t  rows;
+    int32_t  paused;           // rows with TLM_FLAG_PAUSED
+    TlpStat  s[TLP_SERIES_COUNT];
+} TlpBucket;
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t fanout;
+    uint32_t levels;
+    uint32_t n_series;
+    uint32_t block_buckets;
+    uint32_t reserved;
+} TlpFileHeader;
+
+// Block header (followed by block_buckets TlpBucket of one level, in row order)
+typedef struct {
+    uint32_t magic;            // TLP_BLOCK_MAGIC
+    uint32_t level;
+    uint32_t n_buckets;        // valid summaries (< block_buckets only at the end)
+    uint32_t reserved;
+} TlpBlockHeader;
+
+#define TLP_BLOCK_MAGIC 0x31504C42u   // "BLP1"
+
+// ---------------- Writer (B) ----------------
+typedef struct {
+    int     fd;              // -1 when recording is off
+    char    path[256];
+    int     n_rows;          // rows buffered in the current block
+    long    blocks_written;
+    unsigned char *cols[TLM_COL_COUNT];  // column buffers (TLM_BLOCK_ROWS each)
+
+    // Summary pyramid: one open summary per level (sums, not means, until
+    // it closes) and one block buffer per level
+    int        pyr_fd;       // -1 = no pyramid (recording continues without)
+    long       pyr_rows;     // rows summarized so far
+    TlpBucket  pyr_acc[TLP_LEVELS];
+    int        pyr_children[TLP_LEVELS];
+    TlpBucket *pyr_block[TLP_LEVELS];
+    int        pyr_n[TLP_LEVELS];
+} TlmWriter;
+
+// Creates TLM_DIR, a new session file and its pyramid. Returns 0 on success,
+// -1 (fd = -1) otherwise.
+int  tlm_open(TlmWriter *w, const SimParams *p);
+
+// Buffers one row; writes the block when it is full.
+void tlm_append(TlmWriter *w, const TlmRow *row);
+
+// Writes the partial last block (and the partial summaries) and closes the files.
+void tlm_close(TlmWriter *w);
+
+// ---------------- Reader (analytics) ----------------
+typedef struct {
+    const unsigned char *base;
+    size_t               size;
+    const TlmFileHeader *hdr;
+    long                 n_blocks;
+} TlmFile;
+
+// mmap()s a recording and checks its header. Returns 0 on success, -1 on error.
+int  tlm_map(TlmFile *f, const char *path);
+
+// Returns column col of block b and stores its valid row count in *n_rows.
+const void *tlm_column(const TlmFile *f, long b, TlmColumn col, int *n_rows);
+
+void tlm_unmap(TlmFile *f);
+
+typedef struct {
+    const unsigned char *base;
+    size_t               size;
+    long                 n_buckets[TLP_LEVELS];
+    const TlpBucket    **block[TLP_LEVELS];   // per level, in row order
+    long                 n_blocks[TLP_LEVELS];
+} TlpFile;
+
+// Maps the pyramid of recording tlm_path. Returns 0, or -1 if there is none
+// (older recordings): tlm_summarize() then reads the rows.
+int  tlp_map(TlpFile *p, const char *tlm_path);
+void tlp_unmap(TlpFile *p);
+
+// What one tlm_summarize() call read
+typedef struct {
+    long buckets[TLP_LEVELS];
+    long rows;
+} TlpReadStats;
+
+// Summary of rows [row0, row1): whole pyramid summaries where they fit, the
+// next finer level (down to the rows) at the edges. p may be NULL. The
+// result has means, like the stored summaries. st (optional) accumulates.
+void tlm_summarize(const TlmFile *f, const TlpFile *p, long row0, long row1,
+                   TlpBucket *out, TlpReadStats *st);
+
+// Rows in the recording (complete blocks only).
+long tlm_rows(const TlmFile *f);
+
+#endif // TELEMETRY_H
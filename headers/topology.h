@@ -0,0 +1,98 @@
+// topology.h
+// Declarative process topology and channel configuration
+//   - Which component runs as a process or as a thread inside B
+//   - CPU affinity per component
+//   - Transport and kernel buffer capacity per channel
+// Loaded from "topology.txt" (key=value, same style as params.txt).
+// ======================================================================
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <sys/types.h>
+#include <pthread.h>
+
+// Components (B is the master process itself)
+typedef enum {
+    COMP_B = 0,
+    COMP_I,
+    COMP_D,
+    COMP_O,
+    COMP_T,
+    COMP_W,
+    COMP_COUNT
+} ComponentId;
+
+// Channels between components
+typedef enum {
+    CH_I_TO_B = 0,
+    CH_B_TO_D,
+    CH_D_TO_B,
+    CH_O_TO_B,
+    CH_T_TO_B,
+    CH_CFG_TO_W,
+    CH_COUNT
+} ChannelId;
+
+typedef enum {
+    RUN_PROCESS = 0,
+    RUN_THREAD  = 1    // runs inside B's process (I, D, O, T only)
+} RunMode;
+
+typedef enum {
+    TRANSPORT_PIPE = 0,      // pipe()
+    TRANSPORT_STREAM,        // socketpair(AF_UNIX, SOCK_STREAM)
+    TRANSPORT_SEQPACKET      // socketpair(AF_UNIX, SOCK_SEQPACKET), keeps message boundaries
+} Transport;
+
+typedef struct {
+    const char *name;
+    RunMode     mode;
+    int         cpu;         // -1 = no pinning
+    pid_t       pid;         // process id (B's pid for thread components)
+    pthread_t   tid;         // valid for RUN_THREAD
+} Component;
+
+typedef struct {
+    const char *name;
+    Transport   transport;
+    int         capacity;    // kernel buffer size in bytes, 0 = default
+    ComponentId writer;
+    ComponentId reader;
+    int         fds[2];      // [0] = read end, [1] = write end (-1 once closed)
+} Channel;
+
+typedef struct {
+    Component comp[COMP_COUNT];
+    Channel   ch[CH_COUNT];
+} Topology;
+
+// Entry point of a component: receives the topology to look up its channel ends.
+typedef void (*ComponentMain)(Topology *topo);
+
+// Fills the default layout (every component a process, all channels plain pipes).
+void topo_init_default(Topology *t);
+
+// Overrides the defaults from a key=value file. Missing file keeps defaults.
+void topo_load_from_file(const char *filename, Topology *t);
+
+// Creates every channel (with transport and capacity applied). Dies on failure.
+void topo_create_channels(Topology *t);
+
+// Builds the graph: forks every process component (each child closes all channel
+// ends it does not own, then runs its entry), closes the ends B does not need,
+// and finally starts the thread components inside B.
+// entries[COMP_B] is not called here; the caller becomes B afterwards.
+void topo_launch(Topology *t, const ComponentMain entries[COMP_COUNT]);
+
+// Read end / write end of a channel.
+int  topo_rfd(const Topology *t, ChannelId ch);
+int  topo_wfd(const Topology *t, ChannelId ch);
+
+// Pins the calling process or thread to the component's CPU (if configured).
+void topo_apply_affinity(const Topology *t, ComponentId id);
+
+// Ends a component: exit() for processes, pthread_exit() for thread components.
+void component_exit(int status);
+
+#endif // TOPOLOGY_H
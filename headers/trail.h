@@ -0,0 +1,72 @@
+// trail.h
+// Bounded-memory trajectory trails
+//   - fixed-capacity ring of simplified positions per drone
+//   - streaming simplification: distance decimation + windowed Douglas-Peucker test
+//   - per-drone point budgets so a swarm shares one fixed pool size
+//   - rendering touches each terminal cell at most once
+// ======================================================================
+
+#ifndef TRAIL_H
+#define TRAIL_H
+
+#define TRAIL_CAPACITY     256   // max kept vertices per drone
+#define TRAIL_MAX_DRONES   8
+#define TRAIL_TOTAL_BUDGET 1024  // vertices shared by all drones
+#define TRAIL_WINDOW       32    // raw points checked by the simplification test
+
+typedef struct {
+    double x;
+    double y;
+} TrailPoint;
+
+typedef struct {
+    // Committed (simplified) vertices, oldest overwritten when full
+    TrailPoint pts[TRAIL_CAPACITY];
+    int        head;         // next write slot
+    int        count;        // valid vertices
+    int        capacity;     // per-drone budget (<= TRAIL_CAPACITY)
+
+    // Open segment: last vertex -> latest raw point, plus skipped raw points
+    TrailPoint tip;          // latest raw point (drawn, not yet committed)
+    int        has_tip;
+    TrailPoint window[TRAIL_WINDOW];
+    int        n_window;
+
+    double     min_dist;     // decimation: ignore moves shorter than this
+    double     tolerance;    // max distance of a skipped point from the simplified line
+
+    long       raw_points;   // points offered
+    long       committed;    // vertices committed
+} Trail;
+
+typedef struct {
+    int   n_drones;
+    int   visible;           // toggled from the UI ('t')
+    Trail drone[TRAIL_MAX_DRONES];
+} TrailSet;
+
+// Splits TRAIL_TOTAL_BUDGET across n_drones and derives decimation distances
+// from the world size (fewer points per drone -> coarser simplification).
+void trail_set_init(TrailSet *set, int n_drones, double world_half);
+
+// Offers one raw position (every D tick). O(TRAIL_WINDOW) worst case, no allocation.
+void trail_push(Trail *t, double x, double y);
+
+// Forgets the trail (e.g. after a reset).
+void trail_clear(Trail *t);
+
+// Number of drawable vertices (committed + tip).
+int  trail_points(const Trail *t);
+
+// Callback used by trail_render() to put one cell on screen.
+typedef void (*TrailPutCell)(int row, int col, int age_bucket);
+
+// Rasterizes the trail newest-to-oldest into the cell rectangle
+// [top, top+height) x [left, left+width). Every cell is emitted at most once;
+// age_bucket is 0 for the newest third of the trail, 1 and 2 for older parts.
+// Returns the number of cells emitted.
+int  trail_render(const Trail *t, double world_half,
+                  int top, int left, int height, int width,
+                  TrailPutCell put);
+
+#endif // TRAIL_H
@@ -11,6 +11,7 @@
 #include "obstacles.h"   
 #include "targets.h"   
 
+#include <math.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <errno.h> 
@@ -33,14 +34,6 @@ typedef struct {
     double uy;   // unit vector y-component
 } Dir8;
 
-// Any object with x, y, active : to be treated as PointLike for latter calculated distance b/n the pointLikes
-typedef struct {
-    double x;
-    double y;
-    int    active;
-} PointLike;
-
-
 // Normalization factor for diagonals: 1/sqrt(2).
 extern const double INV_SQRT2;
 
@@ -58,25 +51,48 @@ int best_dir8_for_vector(double Px, double Py);
 // Does dot product of two vectors
 double dot2(double ax, double ay, double bx, double by);
 
-// Computes total force vector using a "virtual key" computed from obstacles or walls
-void send_total_force_to_d(const ForceStateMsg *user_force,
-                                  const DroneStateMsg *cur_state,
+// Computes the total force command: user force + a "virtual key" from the
+// obstacle repulsion (Px, Py) at the drone (ecs_sys_repulse).
+// detail (optional) receives a short description for the SEND_FORCE log line.
+ForceStateMsg compute_total_force(const ForceStateMsg *user_force,
+                                  double               Px,
+                                  double               Py,
                                   const SimParams     *params,
-                                  const Obstacle      *obs,
-                                  int                  num_obs,
-                                  int                  fd_to_d,
-                                  FILE                *logfile,
-                                  const char          *reason);
-
-// Computes unified repulsive field from point obstacles
-void compute_repulsive_P(const DroneStateMsg *s,
-                         const SimParams     *params,
-                         const Obstacle      *obs,
-                         int                  num_obs,
-                         bool                 include_walls,
-                         bool                 include_obstacles,
-                         double              *Px,
-                         double              *Py);
+                                  char                *detail,
+                                  size_t               detail_len);
+
+// Obstacle repulsion field (also used by the autopilot's rollout model)
+#define OBS_CLEARANCE_FRAC 0.30    // field radius as a share of world_half
+#define OBS_GAIN           120.0   // 120 behaved well
+
+// Target hit radius as a share of world_half
+#define TARGET_HIT_FRAC    0.08
+
+// Adds the push of one obstacle on a point (dx, dy) away from it.
+// Summed over the obstacles by ecs_sys_repulse.
+static inline void obstacle_push(double dx, double dy, double clearance,
+                                 double *Px, double *Py) {
+    double rho = sqrt(dx*dx + dy*dy);
+    if (rho < 1e-3) rho = 1e-3;
+    if (rho < clearance) {
+        double mag = OBS_GAIN * (1.0/rho - 1.0/clearance);
+        if (mag < 0.0) mag = 0.0;
+        *Px += mag * (dx / rho);
+        *Py += mag * (dy / rho);
+    }
+}
+
+// A target (dx, dy) away from the drone is collected (ecs_sys_hit).
+static inline int target_reached(double dx, double dy, const SimParams *params) {
+    double R_hit = params->world_half * TARGET_HIT_FRAC;
+    return dx*dx + dy*dy <= R_hit * R_hit;
+}
+
+// Computes the wall repulsion field (D adds it to B's command)
+void compute_wall_P(const DroneStateMsg *s,
+                    const SimParams     *params,
+                    double              *Px,
+                    double              *Py);
 
 // Checks if a point (x,y) is too close to the walls.
 int target_too_close_to_wall(double x,
@@ -84,23 +100,22 @@ int target_too_close_to_wall(double x,
                                     const SimParams *params,
                                     double wall_margin);
 
-// Checks if (x,y) is too close to any active obstacle.
-int too_close_to_any_pointlike(double px,
-                               double py,
-                               const PointLike *arr,
-                               int count,
-                               double min_dist);
-
-// Checks if the drone has "hit" any active target.
-int check_target_hits(const DroneStateMsg *cur_state,
-                      Target              *targets,
-                      int                  num_targets,
-                      const SimParams     *params,
-                      int                 *score,
-                      int                 *targets_collected,
-                      int                 *last_hit_step,
-                      int                  current_step);
+// Checks if (x,y) is within min_dist of any of the points (xs[i], ys[i]).
+int too_close_to_any_point(double px,
+                           double py,
+                           const double *xs,
+                           const double *ys,
+                           int count,
+                           double min_dist);
+
+
+// Sleeps for sim_sec simulated seconds, i.e. sim_sec / time_scale wall seconds.
+void sleep_sim_sec(double sim_sec, const SimParams *params);
 
+// Fixed-rate loops: sleeps until the next deadline, sim_sec simulated seconds
+// after the previous one (absolute, so the loop's own run time does not add up).
+// *next holds the schedule; start it at -1.
+void pace_sim_sec(double *next, double sim_sec, const SimParams *params);
 
 // Helper to perform uniform random double in [min, max].
 double rand_in_range(double min, double max);
@@ -0,0 +1,67 @@
+// vclock.h
+// Clock used by every component for timing (sleeps, heartbeats, timeouts)
+//   - real (default): CLOCK_MONOTONIC and nanosleep, as before
+//   - virtual: time is a counter in a MAP_SHARED page that only a driver
+//     moves (arp1_vclock). Sleepers block on a futex in that page; each
+//     attached component owns a slot, and the driver advances time only
+//     when every attached component is asleep, straight to the earliest
+//     deadline. Minutes of watchdog / generator timing run in
+//     milliseconds, with the same event order on every run.
+// Latency measurements (key age, RTT, plan time) stay on the real clock.
+// ======================================================================
+
+#ifndef VCLOCK_H
+#define VCLOCK_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#define VCLOCK_MAX_SLOTS 8
+
+typedef enum {
+    VC_SLOT_FREE = 0,
+    VC_SLOT_RUNNING,
+    VC_SLOT_SLEEPING,
+    VC_SLOT_EXITED
+} VClockSlotState;
+
+typedef struct {
+    volatile uint32_t seq;       // futex word: bumped on every advance
+    uint32_t          pad;
+    volatile int64_t  now_ns;    // virtual time
+    struct {
+        volatile int32_t state;  // VClockSlotState
+        volatile int64_t deadline_ns;
+    } slot[VCLOCK_MAX_SLOTS];
+} VClockShared;
+
+// Seconds on the component clock (virtual time once vclock_use_virtual ran).
+double clock_now(void);
+
+// Sleeps sec seconds of component time (returns early on a signal in real mode).
+void   clock_sleep(double sec);
+
+// Sleeps until clock_now() reaches t (returns at once if it already has).
+void   clock_sleep_until(double t);
+
+// Driver side (before forking the components)
+// ----------------------------------------------------------------------
+// Switches this process, and every child forked afterwards, to virtual time at 0.
+int    vclock_use_virtual(void);
+int    vclock_is_virtual(void);
+
+// fork() for a component that owns `slot`: the slot counts as running from
+// before the fork, so time cannot move past the child before its first sleep.
+// The child releases the slot when it exits.
+pid_t  vclock_fork(int slot);
+void   vclock_mark_exited(int slot);   // driver: the slot's process was reaped
+
+// Waits until every attached component sleeps (or exited): whatever they do at
+// the current time has been done, e.g. their messages are in the pipes.
+void   vclock_settle(void);
+
+// Settles, then moves time to the earliest deadline (at most to limit_sec).
+// Returns the new virtual time in seconds.
+double vclock_advance(double limit_sec);
+
+#endif // VCLOCK_H
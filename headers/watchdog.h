@@ -5,7 +5,8 @@
 #include <sys/types.h> // pid_t
 
 // PIDs that Watchdog will supervise.
-// We send this struct from master to W *once* at startup.
+// Sent from master to W at startup, then again by B whenever one changes
+// (-1 = component gone).
 typedef struct {
     pid_t pid_B;   // Server / Blackboard
     pid_t pid_I;   // Keyboard
@@ -15,7 +16,7 @@ typedef struct {
 } WatchPids;
 
 // Run watchdog process.
-// - cfg_read_fd: W reads WatchPids from here at startup
+// - cfg_read_fd: W reads WatchPids from here (startup + later updates)
 // - warn_sec: seconds without heartbeat before sending warning to B
 // - kill_sec: seconds without heartbeat before terminating everyone
 void run_watchdog_process(int cfg_read_fd, int warn_sec, int kill_sec);
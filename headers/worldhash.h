@@ -0,0 +1,61 @@
+// worldhash.h
+// Incremental world-state hash for divergence detection
+//   - the world hash is the XOR of one hash per group (drone, force,
+//     obstacles, targets, score, streams); entity groups are themselves
+//     the XOR of one hash per slot, so changing one entity costs two XORs
+//   - values are hashed by bit pattern: two runs hash equal only if they
+//     are bit-identical
+//   - B records every group hash per tick in telemetry;
+//     `arp1_analyze -d a.tlm b.tlm` finds the first differing tick and field
+// ======================================================================
+
+#ifndef WORLDHASH_H
+#define WORLDHASH_H
+
+#include <stdint.h>
+#include "messages.h"
+#include "params.h"      // obstacles.h / targets.h use SimParams
+#include "obstacles.h"   // NUM_OBSTACLES
+#include "targets.h"     // NUM_TARGETS
+
+typedef enum {
+    WH_DRONE = 0,   // x, y, vx, vy
+    WH_FORCE,       // user force (keys / controller), before repulsion
+    WH_OBSTACLES,   // active slots: index, x, y (life_steps excluded)
+    WH_TARGETS,     // same for targets
+    WH_SCORE,       // score, targets collected
+    WH_STREAMS,     // positions in the random streams (see wh_set_streams)
+    WH_COUNT
+} WhGroup;
+
+// Stream positions: B cannot see O/T's rand() state, but each generator
+// batch consumes a fixed number of draws, so the batch count is the position.
+typedef struct {
+    uint64_t obs_batches;   // messages received from O
+    uint64_t tgt_batches;   // messages received from T
+    uint64_t soak_rng;      // soak key generator state (0 outside soak mode)
+    uint64_t scn_cursor;    // scenario waves + keys replayed so far
+} WhStreams;
+
+typedef struct {
+    uint64_t group[WH_COUNT];
+    uint64_t obs_slot[NUM_OBSTACLES];   // current contribution of each slot
+    uint64_t tgt_slot[NUM_TARGETS];
+    long     slot_updates;              // slots whose contribution changed
+} WorldHash;
+
+void wh_init(WorldHash *h);
+
+void wh_set_drone(WorldHash *h, const DroneStateMsg *s);
+void wh_set_force(WorldHash *h, const ForceStateMsg *user_force);
+void wh_set_score(WorldHash *h, int score, int collected);
+void wh_set_streams(WorldHash *h, const WhStreams *st);
+
+// Re-hashes one entity slot (no-op if its contribution did not change).
+void wh_set_obstacle(WorldHash *h, int i, double x, double y, int active);
+void wh_set_target(WorldHash *h, int i, double x, double y, int active);
+
+uint64_t    wh_world(const WorldHash *h);
+const char *wh_group_name(WhGroup g);
+
+#endif // WORLDHASH_H
@@ -0,0 +1,86 @@
+// alloccheck.c
+// malloc interposer and per-tick allocation counters (see alloccheck.h)
+// ======================================================================
+
+#include "headers/alloccheck.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#ifdef ARP_ALLOC_CHECK
+typedef struct {
+    unsigned long ticks;        // steady-state ticks checked
+    unsigned long bad_ticks;    // of which allocated
+    unsigned long allocs;       // allocations in those ticks
+    unsigned long frees;        // frees in steady-state ticks
+} AllocStats;
+
+static AllocStats *g_stats = NULL;   // [ALC_COUNT], shared with every component
+static const char *k_roles[ALC_COUNT] = { "B", "D" };
+
+// Interposer: glibc's own entry points do the work
+// ----------------------------------------------------------------------
+extern void *__libc_malloc(size_t n);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t n);
+extern void  __libc_free(void *p);
+
+static __thread unsigned long t_allocs;   // per thread: B and D may share a process
+static __thread unsigned long t_frees;
+
+void *malloc(size_t n)              { t_allocs++; return __libc_malloc(n); }
+void *calloc(size_t n, size_t size) { t_allocs++; return __libc_calloc(n, size); }
+void *realloc(void *p, size_t n)    { t_allocs++; return __libc_realloc(p, n); }
+void  free(void *p)                 { if (p) t_frees++; __libc_free(p); }
+
+void alloc_tick_init(AllocTick *t, AllocRole role) {
+    memset(t, 0, sizeof(*t));
+    t->role = role;
+}
+
+void alloc_tick(AllocTick *t, FILE *log) {
+    unsigned long a = t_allocs, f = t_frees;
+    if (t->open && t->ticks > ALLOC_WARMUP_TICKS && g_stats) {
+        AllocStats   *st = &g_stats[t->role];
+        unsigned long da = a - t->allocs0;
+        __atomic_add_fetch(&st->ticks, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&st->frees, f - t->frees0, __ATOMIC_RELAXED);
+        if (da > 0) {
+            unsigned long bad = __atomic_add_fetch(&st->bad_ticks, 1, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&st->allocs, da, __ATOMIC_RELAXED);
+            if (bad <= ALLOC_LOG_FIRST && log)
+                fprintf(log, "[%s] ALLOC: tick %lu allocated %lu time(s)\n", k_roles[t->role], t->ticks, da);
+        }
+    }
+    t->ticks++;
+    t->open    = 1;
+    t->allocs0 = t_allocs;   // after our own logging
+    t->frees0  = t_frees;
+}
+
+int alloc_check_finish(FILE *log) {
+    if (!g_stats) return 1;
+    int ok = 1;
+    for (int r = 0; r < ALC_COUNT; ++r) {
+        AllocStats *st = &g_stats[r];
+        if (log) fprintf(log, "[B] ALLOC %s: %lu steady-state tick(s), %lu allocating (%lu allocation(s), %lu free(s))\n",
+                         k_roles[r], st->ticks, st->bad_ticks, st->allocs, st->frees);
+        if (st->bad_ticks > 0) ok = 0;
+    }
+    return ok;
+}
+#endif
+
+void alloc_check_setup(void) {
+#ifdef ARP_ALLOC_CHECK
+    void *m = mmap(NULL, sizeof(AllocStats) * ALC_COUNT, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED) {
+        perror("[ALLOC] mmap");
+        return;
+    }
+    memset(m, 0, sizeof(AllocStats) * ALC_COUNT);
+    g_stats = m;
+#endif
+}
@@ -0,0 +1,578 @@
+// analyze.c
+// arp1_analyze: parallel session analytics over telemetry recordings
+//   - inputs: .tlm files and/or directories of them (default: logs/telemetry)
+//   - worker threads pull sessions from a shared index; each recording is
+//     mmap'ed and only the needed columns are scanned block by block
+//   - per-session rows + an aggregate row; distributions are merged across
+//     sessions with mergeable quantile sketches (sketch.c)
+//   - output: tab-separated summary table (label column for comparing versions)
+//   - -d a.tlm b.tlm: first tick where two recordings' world hashes differ,
+//     with the differing groups and recorded fields
+//   - -v file.tlm: min/mean/max overview of a time span in -w columns, read
+//     from the recording's summary pyramid (rows only where it has no cover)
+// ======================================================================
+
+#include "headers/telemetry.h"
+#include "headers/sketch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define MAX_INPUTS 4096
+
+typedef struct {
+    const char *path;
+    int    ok;                 // 0 if the file could not be read
+    size_t bytes;              // mapped size
+    long   ticks;
+    double active_min;         // simulated minutes, paused ticks excluded
+    int    collected;
+    double targets_per_min;
+    double ttt_p50, ttt_p90;   // time-to-target (simulated seconds)
+    double wall_prox_sec;      // time closer than wall_clearance to a wall
+    double wall_prox_pct;
+    double effort;             // sum |F|^2 dt over active ticks (N^2 s)
+    double mean_force;         // mean |F| over active ticks
+    double tick_p50, tick_p99; // wall ms between D states
+    double input_p50, input_p99;  // key batch age in ms
+} SessionResult;
+
+// Per-thread aggregate (merged at the end)
+typedef struct {
+    QuantileSketch ttt;
+    QuantileSketch tick_ms;
+    QuantileSketch input_ms;
+    QuantileSketch tpm;        // targets per minute, one value per session
+    QuantileSketch effort_per_min;
+} Aggregate;
+
+static const char   *g_paths[MAX_INPUTS];
+static SessionResult g_results[MAX_INPUTS];
+static int           g_n_paths = 0;
+static int           g_next    = 0;   // next session to analyze (atomic)
+
+static void aggregate_init(Aggregate *a) {
+    sketch_init(&a->ttt);
+    sketch_init(&a->tick_ms);
+    sketch_init(&a->input_ms);
+    sketch_init(&a->tpm);
+    sketch_init(&a->effort_per_min);
+}
+
+static void aggregate_merge(Aggregate *dst, const Aggregate *src) {
+    sketch_merge(&dst->ttt,      &src->ttt);
+    sketch_merge(&dst->tick_ms,  &src->tick_ms);
+    sketch_merge(&dst->input_ms, &src->input_ms);
+    sketch_merge(&dst->tpm,      &src->tpm);
+    sketch_merge(&dst->effort_per_min, &src->effort_per_min);
+}
+
+// Scans one recording. Session-local sketches are merged into agg.
+// ----------------------------------------------------------------------
+static void analyze_session(const char *path, SessionResult *r, Aggregate *agg,
+                            QuantileSketch *ttt, QuantileSketch *tick, QuantileSketch *input) {
+    memset(r, 0, sizeof(*r));
+    r->path = path;
+
+    TlmFile f;
+    if (tlm_map(&f, path) == -1) {
+        fprintf(stderr, "[ANALYZE] %s: not a readable telemetry file, skipped\n", path);
+        return;
+    }
+    r->ok    = 1;
+    r->bytes = f.size;
+
+    sketch_init(ttt);
+    sketch_init(tick);
+    sketch_init(input);
+
+    const double dt       = f.hdr->dt;
+    const double wh       = f.hdr->world_half;
+    const double clear    = f.hdr->wall_clearance;
+    long   active         = 0;
+    long   near_wall      = 0;
+    long   since_hit      = 0;     // active ticks since the last collection
+    int    prev_collected = 0;
+    double force_sum      = 0.0;
+
+    for (long b = 0; b < f.n_blocks; ++b) {
+        int n;
+        const double  *x     = tlm_column(&f, b, TLM_COL_X, &n);
+        const double  *y     = tlm_column(&f, b, TLM_COL_Y, &n);
+        const float   *fx    = tlm_column(&f, b, TLM_COL_FX, &n);
+        const float   *fy    = tlm_column(&f, b, TLM_COL_FY, &n);
+        const int32_t *coll  = tlm_column(&f, b, TLM_COL_COLLECTED, &n);
+        const float   *tms   = tlm_column(&f, b, TLM_COL_TICK_MS, &n);
+        const float   *ims   = tlm_column(&f, b, TLM_COL_INPUT_MS, &n);
+        const uint8_t *flags = tlm_column(&f, b, TLM_COL_FLAGS, &n);
+
+        for (int i = 0; i < n; ++i) {
+            r->ticks++;
+            if (r->ticks > 1) sketch_add(tick, tms[i]);   // first interval is startup
+            if (ims[i] >= 0.0f) sketch_add(input, ims[i]);
+
+            if (flags[i] & TLM_FLAG_PAUSED) continue;
+            active++;
+            since_hit++;
+
+            double ax = fabs(x[i]), ay = fabs(y[i]);
+            double wall_dist = wh - (ax > ay ? ax : ay);
+            if (wall_dist < clear) near_wall++;
+
+            double f2 = (double)fx[i] * fx[i] + (double)fy[i] * fy[i];
+            r->effort += f2 * dt;
+            force_sum += sqrt(f2);
+
+            if (coll[i] > prev_collected) {
+                sketch_add(ttt, since_hit * dt);
+                since_hit = 0;
+            }
+            prev_collected = coll[i];
+        }
+    }
+
+    r->collected       = prev_collected;
+    r->active_min      = active * dt / 60.0;
+    r->targets_per_min = r->active_min > 0.0 ? r->collected / r->active_min : 0.0;
+    r->wall_prox_sec   = near_wall * dt;
+    r->wall_prox_pct   = active > 0 ? 100.0 * near_wall / active : 0.0;
+    r->mean_force      = active > 0 ? force_sum / active : 0.0;
+    r->ttt_p50         = sketch_quantile(ttt, 0.50);
+    r->ttt_p90         = sketch_quantile(ttt, 0.90);
+    r->tick_p50        = sketch_quantile(tick, 0.50);
+    r->tick_p99        = sketch_quantile(tick, 0.99);
+    r->input_p50       = sketch_quantile(input, 0.50);
+    r->input_p99       = sketch_quantile(input, 0.99);
+
+    sketch_merge(&agg->ttt,      ttt);
+    sketch_merge(&agg->tick_ms,  tick);
+    sketch_merge(&agg->input_ms, input);
+    if (r->active_min > 0.0) {
+        sketch_add(&agg->tpm, r->targets_per_min);
+        sketch_add(&agg->effort_per_min, r->effort / r->active_min);
+    }
+
+    tlm_unmap(&f);
+}
+
+// Worker thread: pulls sessions until none are left.
+// ----------------------------------------------------------------------
+static void *worker(void *arg) {
+    Aggregate *agg = arg;
+
+    // Session-local sketches live on the heap (each is ~16 kB)
+    QuantileSketch *scratch = malloc(3 * sizeof(QuantileSketch));
+    if (!scratch) return NULL;
+
+    while (1) {
+        int i = __atomic_fetch_add(&g_next, 1, __ATOMIC_RELAXED);
+        if (i >= g_n_paths) break;
+        analyze_session(g_paths[i], &g_results[i], agg, &scratch[0], &scratch[1], &scratch[2]);
+    }
+    free(scratch);
+    return NULL;
+}
+
+// Divergence search (-d): hash columns are compared a block at a time
+// ----------------------------------------------------------------------
+static const char *k_col_names[TLM_COL_COUNT] = {
+    [TLM_COL_X] = "x", [TLM_COL_Y] = "y", [TLM_COL_VX] = "vx", [TLM_COL_VY] = "vy",
+    [TLM_COL_FX] = "fx", [TLM_COL_FY] = "fy",
+    [TLM_COL_SCORE] = "score", [TLM_COL_COLLECTED] = "collected",
+};
+
+// Recorded fields behind each hash group (-1 ends the list; entities are not recorded)
+static const int k_group_cols[WH_COUNT][5] = {
+    [WH_DRONE]     = { TLM_COL_X, TLM_COL_Y, TLM_COL_VX, TLM_COL_VY, -1 },
+    [WH_FORCE]     = { TLM_COL_FX, TLM_COL_FY, -1 },
+    [WH_OBSTACLES] = { -1 },
+    [WH_TARGETS]   = { -1 },
+    [WH_SCORE]     = { TLM_COL_SCORE, TLM_COL_COLLECTED, -1 },
+    [WH_STREAMS]   = { -1 },
+};
+
+static double field_value(const TlmFile *f, long b, int col, int row) {
+    int n;
+    const void *p = tlm_column(f, b, (TlmColumn)col, &n);
+    switch (col) {
+        case TLM_COL_FX:
+        case TLM_COL_FY:        return ((const float *)p)[row];
+        case TLM_COL_SCORE:
+        case TLM_COL_COLLECTED: return ((const int32_t *)p)[row];
+        default:                return ((const double *)p)[row];
+    }
+}
+
+static void report_divergence(FILE *out, const TlmFile *fa, const TlmFile *fb, long b, int row) {
+    int n;
+    const int32_t *tick = tlm_column(fa, b, TLM_COL_TICK, &n);
+    fprintf(out, "first divergence at tick %d (%.2f s simulated, row %ld)\n",
+            tick[row], tick[row] * fa->hdr->dt, b * TLM_BLOCK_ROWS + row);
+
+    for (int g = 0; g < WH_COUNT; ++g) {
+        const uint64_t *ha = tlm_column(fa, b, TLM_COL_HASH_DRONE + g, &n);
+        const uint64_t *hb = tlm_column(fb, b, TLM_COL_HASH_DRONE + g, &n);
+        if (ha[row] == hb[row]) continue;
+
+        fprintf(out, "  %-9s %016llx / %016llx", wh_group_name((WhGroup)g),
+                (unsigned long long)ha[row], (unsigned long long)hb[row]);
+        int shown = 0;
+        for (const int *c = k_group_cols[g]; *c >= 0; ++c) {
+            double va = field_value(fa, b, *c, row), vb = field_value(fb, b, *c, row);
+            if (va == vb) continue;
+            fprintf(out, "%s %s %.17g / %.17g", shown++ ? "," : ":", k_col_names[*c], va, vb);
+        }
+        if (!shown && k_group_cols[g][0] >= 0) fprintf(out, ": below recording precision");
+        if (k_group_cols[g][0] < 0) fprintf(out, ": not recorded per field (see the B logs)");
+        fprintf(out, "\n");
+    }
+}
+
+// How far apart the two drone trajectories are over the common ticks
+// (e.g. a float32 autopilot build against the double baseline).
+static void report_trajectory_error(FILE *out, const TlmFile *fa, const TlmFile *fb) {
+    double max_err = 0.0, sum_err = 0.0, last_err = 0.0;
+    long   rows = 0;
+    int    max_tick = 0;
+    long   n_blocks = fa->n_blocks < fb->n_blocks ? fa->n_blocks : fb->n_blocks;
+    for (long b = 0; b < n_blocks; ++b) {
+        int na, nb;
+        const int32_t *tick = tlm_column(fa, b, TLM_COL_TICK, &na);
+        const double  *xa = tlm_column(fa, b, TLM_COL_X, &na), *ya = tlm_column(fa, b, TLM_COL_Y, &na);
+        const double  *xb = tlm_column(fb, b, TLM_COL_X, &nb), *yb = tlm_column(fb, b, TLM_COL_Y, &nb);
+        int n = na < nb ? na : nb;
+        for (int i = 0; i < n; ++i) {
+            double e = hypot(xa[i] - xb[i], ya[i] - yb[i]);
+            if (e > max_err) { max_err = e; max_tick = tick[i]; }
+            sum_err += e;
+            last_err = e;
+        }
+        rows += n;
+        if (na != nb) break;
+    }
+    if (rows == 0) return;
+    fprintf(out, "  trajectory: position error mean %.4g, max %.4g (tick %d), final %.4g over %ld tick(s)\n",
+            sum_err / rows, max_err, max_tick, last_err, rows);
+}
+
+// Returns 0 if the common prefix of both recordings hashes equal, 1 otherwise.
+static int diff_sessions(const char *pa, const char *pb, FILE *out) {
+    TlmFile fa, fb;
+    if (tlm_map(&fa, pa) == -1 || tlm_map(&fb, pb) == -1) {
+        fprintf(stderr, "[ANALYZE] -d needs two readable telemetry files (version %d)\n", TLM_VERSION);
+        return EXIT_FAILURE;
+    }
+    fprintf(out, "%s vs %s: ", pa, pb);
+
+    long ticks = 0;
+    int  diverged = 0;
+    long n_blocks = fa.n_blocks < fb.n_blocks ? fa.n_blocks : fb.n_blocks;
+    int  na = 0, nb = 0;
+    for (long b = 0; b < n_blocks && !diverged; ++b) {
+        const uint64_t *ha = tlm_column(&fa, b, TLM_COL_HASH, &na);
+        const uint64_t *hb = tlm_column(&fb, b, TLM_COL_HASH, &nb);
+        int n = na < nb ? na : nb;
+        if (memcmp(ha, hb, (size_t)n * sizeof(uint64_t)) != 0) {
+            int i = 0;
+            while (ha[i] == hb[i]) ++i;
+            report_divergence(out, &fa, &fb, b, i);
+            diverged = 1;
+        }
+        ticks += n;
+        if (na != nb) break;   // one recording ends here
+    }
+    if (!diverged) {
+        long ra = 0, rb = 0;
+        for (long b = 0; b < fa.n_blocks; ++b) { tlm_column(&fa, b, TLM_COL_TICK, &na); ra += na; }
+        for (long b = 0; b < fb.n_blocks; ++b) { tlm_column(&fb, b, TLM_COL_TICK, &nb); rb += nb; }
+        fprintf(out, "identical for %ld tick(s)", ticks);
+        if (ra != rb) fprintf(out, " (lengths differ: %ld vs %ld)", ra, rb);
+        fprintf(out, "\n");
+    } else {
+        report_trajectory_error(out, &fa, &fb);
+    }
+    tlm_unmap(&fa);
+    tlm_unmap(&fb);
+    return diverged ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+// Overview (-v): one summary per output column
+// ----------------------------------------------------------------------
+static int parse_series(const char *list, int *sel) {
+    int n = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", list);
+    for (char *save = NULL, *tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        int found = -1;
+        for (int i = 0; i < TLP_SERIES_COUNT; ++i)
+            if (strcmp(tok, TLP_SERIES_NAMES[i]) == 0) found = i;
+        if (found < 0) {
+            fprintf(stderr, "[ANALYZE] unknown series '%s'\n", tok);
+            return -1;
+        }
+        if (n < TLP_SERIES_COUNT) sel[n++] = found;
+    }
+    return n;
+}
+
+static int overview(const char *path, int width, double from_s, double to_s,
+                    const char *series, FILE *out) {
+    int sel[TLP_SERIES_COUNT];
+    int n_sel = parse_series(series, sel);
+    if (n_sel <= 0) return EXIT_FAILURE;
+
+    TlmFile f;
+    if (tlm_map(&f, path) == -1) {
+        fprintf(stderr, "[ANALYZE] -v needs a readable telemetry file (version %d)\n", TLM_VERSION);
+        return EXIT_FAILURE;
+    }
+    TlpFile  p;
+    int      have_pyr = tlp_map(&p, path) == 0;
+    double   dt   = f.hdr->dt > 0.0 ? f.hdr->dt : 1.0;
+    long     rows = tlm_rows(&f);
+    long     r0   = from_s > 0.0 ? (long)(from_s / dt) : 0;
+    long     r1   = to_s   > 0.0 ? (long)(to_s / dt)   : rows;
+    if (r1 > rows) r1 = rows;
+    if (r0 > r1)   r0 = r1;
+    if (width > r1 - r0) width = (int)(r1 - r0);
+
+    fprintf(out, "col\tt_from_s\tt_to_s\trows\tpaused_pct");
+    for (int k = 0; k < n_sel; ++k) {
+        const char *nm = TLP_SERIES_NAMES[sel[k]];
+        fprintf(out, "\t%s_min\t%s_mean\t%s_max", nm, nm, nm);
+    }
+    fprintf(out, "\n");
+
+    TlpReadStats st;
+    memset(&st, 0, sizeof(st));
+    double t0 = now_sec();
+    for (int c = 0; c < width; ++c) {
+        long a = r0 + (r1 - r0) * c / width;
+        long b = r0 + (r1 - r0) * (c + 1) / width;
+        TlpBucket s;
+        tlm_summarize(&f, have_pyr ? &p : NULL, a, b, &s, &st);
+        fprintf(out, "%d\t%.2f\t%.2f\t%d\t%.1f", c, a * dt, b * dt, s.rows,
+                s.rows > 0 ? 100.0 * s.paused / s.rows : 0.0);
+        for (int k = 0; k < n_sel; ++k) {
+            const TlpStat *v = &s.s[sel[k]];
+            if (v->n == 0) fprintf(out, "\t-\t-\t-");
+            else           fprintf(out, "\t%.6g\t%.6g\t%.6g", v->min, v->mean, v->max);
+        }
+        fprintf(out, "\n");
+    }
+    double elapsed = now_sec() - t0;
+
+    fprintf(stderr, "[ANALYZE] overview: %ld row(s) in %d column(s) from %ld x4096 + %ld x256 + %ld x16 "
+                    "summaries and %ld row(s) in %.3f ms%s\n",
+            r1 - r0, width, st.buckets[2], st.buckets[1], st.buckets[0], st.rows, elapsed * 1e3,
+            have_pyr ? "" : " (no pyramid: rows only)");
+    if (have_pyr) tlp_unmap(&p);
+    tlm_unmap(&f);
+    return EXIT_SUCCESS;
+}
+
+// Input collection
+// ----------------------------------------------------------------------
+static void add_path(const char *p) {
+    if (g_n_paths >= MAX_INPUTS) {
+        fprintf(stderr, "[ANALYZE] more than %d inputs, ignoring %s\n", MAX_INPUTS, p);
+        return;
+    }
+    g_paths[g_n_paths++] = strdup(p);
+}
+
+static int cmp_str(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+static void add_input(const char *p) {
+    struct stat st;
+    if (stat(p, &st) == -1) {
+        fprintf(stderr, "[ANALYZE] %s: not found\n", p);
+        return;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        add_path(p);
+        return;
+    }
+
+    DIR *d = opendir(p);
+    if (!d) return;
+    int first = g_n_paths;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        size_t len = strlen(e->d_name);
+        if (len < 5 || strcmp(e->d_name + len - 4, ".tlm") != 0) continue;
+        char full[1024];
+        snprintf(full, sizeof(full), "%s/%s", p, e->d_name);
+        add_path(full);
+    }
+    closedir(d);
+    qsort(&g_paths[first], (size_t)(g_n_paths - first), sizeof(g_paths[0]), cmp_str);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-j threads] [-l label] [-o summary.tsv] [file.tlm|dir ...]\n"
+            "       %s -d a.tlm b.tlm\n"
+            "       %s -v file.tlm [-w columns] [-s from_s:to_s] [-f series,...]\n"
+            "  Default input: %s. Rows are tab-separated; the label column lets\n"
+            "  summaries of several software versions be concatenated and compared.\n"
+            "  -d reports the first tick where the world hashes of two recordings\n"
+            "  differ (exit status 1 if they do).\n"
+            "  -v prints min/mean/max per column over a span (default: all, 80\n"
+            "  columns, series x,y,tick_ms; also vx vy fx fy score collected input_ms).\n",
+            prog, prog, prog, TLM_DIR);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv) {
+    int         jobs     = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char *label    = "current";
+    const char *out_path = NULL;
+    int         diff     = 0;
+    int         view     = 0;
+    int         width    = 80;
+    double      from_s   = 0.0, to_s = 0.0;
+    const char *series   = "x,y,tick_ms";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "dj:l:o:vw:s:f:h")) != -1) {
+        switch (opt) {
+            case 'd': diff = 1; break;
+            case 'v': view = 1; break;
+            case 'w': width = atoi(optarg); break;
+            case 's': if (sscanf(optarg, "%lf:%lf", &from_s, &to_s) < 1) usage(argv[0]); break;
+            case 'f': series = optarg; break;
+            case 'j': jobs = atoi(optarg); break;
+            case 'l': label = optarg; break;
+            case 'o': out_path = optarg; break;
+            default:  usage(argv[0]);
+        }
+    }
+    if (diff) {
+        if (argc - optind != 2) usage(argv[0]);
+        return diff_sessions(argv[optind], argv[optind + 1], stdout);
+    }
+    if (view) {
+        if (argc - optind != 1 || width < 1) usage(argv[0]);
+        FILE *vout = stdout;
+        if (out_path && !(vout = fopen(out_path, "w"))) {
+            perror("[ANALYZE] open output");
+            return EXIT_FAILURE;
+        }
+        int rc = overview(argv[optind], width, from_s, to_s, series, vout);
+        if (vout != stdout) fclose(vout);
+        return rc;
+    }
+    for (int i = optind; i < argc; ++i) add_input(argv[i]);
+    if (optind == argc) add_input(TLM_DIR);
+    if (g_n_paths == 0) {
+        fprintf(stderr, "[ANALYZE] no telemetry files\n");
+        return EXIT_FAILURE;
+    }
+    if (jobs < 1) jobs = 1;
+    if (jobs > g_n_paths) jobs = g_n_paths;
+
+    FILE *out = stdout;
+    if (out_path && !(out = fopen(out_path, "w"))) {
+        perror("[ANALYZE] open output");
+        return EXIT_FAILURE;
+    }
+
+    // Runs the workers, each with its own aggregate (no locking on the hot path)
+    double t0 = now_sec();
+    Aggregate *aggs = calloc((size_t)jobs, sizeof(Aggregate));
+    pthread_t *tids = calloc((size_t)jobs, sizeof(pthread_t));
+    if (!aggs || !tids) {
+        perror("[ANALYZE] calloc");
+        return EXIT_FAILURE;
+    }
+    for (int t = 0; t < jobs; ++t) {
+        aggregate_init(&aggs[t]);
+        if (pthread_create(&tids[t], NULL, worker, &aggs[t]) != 0) {
+            perror("[ANALYZE] pthread_create");
+            return EXIT_FAILURE;
+        }
+    }
+    for (int t = 0; t < jobs; ++t) pthread_join(tids[t], NULL);
+    for (int t = 1; t < jobs; ++t) aggregate_merge(&aggs[0], &aggs[t]);
+    const Aggregate *all = &aggs[0];
+    double elapsed = now_sec() - t0;
+
+    // Per-session table (input order, independent of thread scheduling)
+    fprintf(out, "label\tsession\tticks\tactive_min\tcollected\ttargets_per_min\t"
+                 "ttt_p50_s\tttt_p90_s\twall_prox_s\twall_prox_pct\teffort_N2s\tmean_force_N\t"
+                 "tick_ms_p50\ttick_ms_p99\tinput_ms_p50\tinput_ms_p99\n");
+
+    long   total_ticks = 0, total_collected = 0;
+    double total_min = 0.0, total_effort = 0.0, total_prox = 0.0;
+    size_t total_bytes = 0;
+    int    n_ok = 0;
+    for (int i = 0; i < g_n_paths; ++i) {
+        const SessionResult *r = &g_results[i];
+        if (!r->ok) continue;
+        n_ok++;
+        total_ticks     += r->ticks;
+        total_min       += r->active_min;
+        total_collected += r->collected;
+        total_effort    += r->effort;
+        total_prox      += r->wall_prox_sec;
+        total_bytes     += r->bytes;
+
+        const char *base = strrchr(r->path, '/');
+        fprintf(out, "%s\t%s\t%ld\t%.3f\t%d\t%.3f\t%.2f\t%.2f\t%.2f\t%.2f\t%.2f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\n",
+                label, base ? base + 1 : r->path, r->ticks, r->active_min, r->collected,
+                r->targets_per_min, r->ttt_p50, r->ttt_p90, r->wall_prox_sec, r->wall_prox_pct,
+                r->effort, r->mean_force, r->tick_p50, r->tick_p99, r->input_p50, r->input_p99);
+    }
+
+    // Aggregate row: totals + merged-sketch quantiles
+    fprintf(out, "%s\tALL(%d)\t%ld\t%.3f\t%ld\t%.3f\t%.2f\t%.2f\t%.2f\t%.2f\t%.2f\t-\t%.3f\t%.3f\t%.3f\t%.3f\n",
+            label, n_ok, total_ticks, total_min, total_collected,
+            total_min > 0.0 ? total_collected / total_min : 0.0,
+            sketch_quantile(&all->ttt, 0.50), sketch_quantile(&all->ttt, 0.90),
+            total_prox, total_min > 0.0 ? 100.0 * total_prox / (total_min * 60.0) : 0.0,
+            total_effort,
+            sketch_quantile(&all->tick_ms, 0.50), sketch_quantile(&all->tick_ms, 0.99),
+            sketch_quantile(&all->input_ms, 0.50), sketch_quantile(&all->input_ms, 0.99));
+
+    // Distribution table (merged sketches)
+    fprintf(out, "\nlabel\tdistribution\tn\tp50\tp90\tp99\tmax\tmean\n");
+    const struct { const char *name; const QuantileSketch *s; } dists[] = {
+        { "time_to_target_s",      &all->ttt },
+        { "tick_interval_ms",      &all->tick_ms },
+        { "input_latency_ms",      &all->input_ms },
+        { "targets_per_min",       &all->tpm },
+        { "effort_N2s_per_min",    &all->effort_per_min },
+    };
+    for (size_t d = 0; d < sizeof(dists) / sizeof(dists[0]); ++d) {
+        const QuantileSketch *s = dists[d].s;
+        fprintf(out, "%s\t%s\t%ld\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\n",
+                label, dists[d].name, s->n,
+                sketch_quantile(s, 0.50), sketch_quantile(s, 0.90), sketch_quantile(s, 0.99),
+                s->max, sketch_mean(s));
+    }
+
+    if (out != stdout) fclose(out);
+
+    fprintf(stderr, "[ANALYZE] %d session(s), %.1f MB in %.3f s (%.0f MB/s) with %d thread(s)\n",
+            n_ok, total_bytes / 1e6, elapsed, elapsed > 0.0 ? total_bytes / 1e6 / elapsed : 0.0, jobs);
+
+    free(aggs);
+    free(tids);
+    return n_ok > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,42 @@
+// arena.c
+// Per-tick scratch arena (see arena.h)
+// ======================================================================
+
+#include "headers/arena.h"
+
+#include <stdlib.h>
+
+int arena_init(Arena *a, size_t cap) {
+    a->used = a->high = 0;
+    a->overflows = 0;
+    a->base = malloc(cap);
+    a->cap  = a->base ? cap : 0;
+    return a->base ? 0 : -1;
+}
+
+void *arena_alloc(Arena *a, size_t n) {
+    size_t off = (a->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (!a->base || off + n > a->cap) {
+        a->overflows++;
+        return NULL;
+    }
+    a->used = off + n;
+    if (a->used > a->high) a->high = a->used;
+    return a->base + off;
+}
+
+void arena_reset(Arena *a) {
+    a->used = 0;
+}
+
+void arena_free(Arena *a) {
+    free(a->base);
+    a->base = NULL;
+    a->cap  = a->used = 0;
+}
+
+void arena_report(const Arena *a, const char *name, FILE *log) {
+    if (!log) return;
+    fprintf(log, "[B] ARENA %s: %zu of %zu byte(s) used at most, %lu overflow(s)\n",
+            name, a->high, a->cap, a->overflows);
+}
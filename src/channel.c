@@ -0,0 +1,185 @@
+// channel.c
+// Generator channel lifecycle in B: EOF/exit detection, draining, restarts
+// ======================================================================
+
+#include "headers/channel.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+
+static const char *k_state_names[] = { "open", "draining", "closed", "restarting" };
+
+const char *chan_state_name(ChanState s) {
+    return (s >= CHAN_OPEN && s <= CHAN_RESTARTING) ? k_state_names[s] : "?";
+}
+
+void chan_init(PeerChannel *c, const char *name, const char *log_name,
+               int fd, pid_t pid, PeerMain entry) {
+    memset(c, 0, sizeof(*c));
+    c->name     = name;
+    c->log_name = log_name;
+    c->fd       = fd;
+    c->state    = (fd >= 0) ? CHAN_OPEN : CHAN_CLOSED;
+    if (pid == getpid()) {
+        // Thread peer: lives and dies with B, nothing to reap or fork
+        c->pid   = -1;
+        c->entry = NULL;
+    } else {
+        c->pid   = pid;
+        c->entry = entry;
+    }
+}
+
+int chan_fd(const PeerChannel *c) {
+    return (c->state == CHAN_CLOSED) ? -1 : c->fd;
+}
+
+void chan_watch(const PeerChannel *c, fd_set *set, int *maxfd) {
+    int fd = chan_fd(c);
+    if (fd < 0) return;
+    FD_SET(fd, set);
+    if (fd > *maxfd) *maxfd = fd;
+}
+
+int chan_degraded(const PeerChannel *c) {
+    return c->state != CHAN_OPEN;
+}
+
+// Takes the fd out of the event set and schedules the next restart (if any is left).
+// ----------------------------------------------------------------------
+static void chan_close(PeerChannel *c, const char *why, const SimParams *p, double now, FILE *log) {
+    if (c->fd >= 0) close(c->fd);
+    c->fd    = -1;
+    c->state = CHAN_CLOSED;
+
+    if (c->entry && c->restarts < p->peer_max_restarts) {
+        double delay = p->peer_restart_sec;
+        for (int i = 0; i < c->restarts; ++i) delay *= 2.0;   // backoff
+        c->retry_at = now + delay;
+        if (log) fprintf(log, "[B] CHAN %s: closed (%s), restart %d/%d in %.1fs\n",
+                         c->name, why, c->restarts + 1, p->peer_max_restarts, delay);
+    } else if (log) {
+        fprintf(log, "[B] CHAN %s: closed (%s), no restart left -> degraded\n", c->name, why);
+    }
+    if (log) fflush(log);
+}
+
+// Forks a fresh generator on a new pipe (process peers only).
+// ----------------------------------------------------------------------
+static int chan_respawn(PeerChannel *c, const SimParams *p, FILE *log) {
+    // The previous incarnation must be gone before the new one takes its log
+    if (c->pid > 0) {
+        kill(c->pid, SIGKILL);
+        waitpid(c->pid, NULL, 0);
+        c->pid = -1;
+    }
+
+    int fds[2];
+    if (pipe(fds) == -1) {
+        if (log) fprintf(log, "[B] CHAN %s: pipe failed: %s\n", c->name, strerror(errno));
+        return -1;
+    }
+
+    // Keeps the crashed incarnation's log: logs/<name>.log -> logs/<name>.<n>.log
+    char from[128], to[128];
+    snprintf(from, sizeof(from), "logs/%s.log", c->log_name);
+    snprintf(to,   sizeof(to),   "logs/%s.%d.log", c->log_name, c->restarts);
+    rename(from, to);
+
+    fflush(NULL);   // the child must not flush B's buffered output a second time
+    pid_t pid = fork();
+    if (pid == -1) {
+        if (log) fprintf(log, "[B] CHAN %s: fork failed: %s\n", c->name, strerror(errno));
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        // CHILD: default signals, only the new write end stays open
+        signal(SIGTERM, SIG_DFL);
+        signal(SIGUSR1, SIG_DFL);
+        signal(SIGUSR2, SIG_DFL);
+        signal(SIGPIPE, SIG_DFL);
+        long max_fd = sysconf(_SC_OPEN_MAX);
+        if (max_fd < 0 || max_fd > 4096) max_fd = 4096;
+        for (int fd = 3; fd < max_fd; ++fd) {
+            if (fd != fds[1]) close(fd);
+        }
+        c->entry(fds[1], *p);   // ends with component_exit()
+        _exit(EXIT_SUCCESS);
+    }
+
+    close(fds[1]);
+    c->fd    = fds[0];
+    c->pid   = pid;
+    c->state = CHAN_RESTARTING;
+    c->restarts++;
+    if (log) {
+        fprintf(log, "[B] CHAN %s: restarted as pid %d (%d/%d)\n",
+                c->name, (int)pid, c->restarts, p->peer_max_restarts);
+        fflush(log);
+    }
+    return 0;
+}
+
+int chan_on_read(PeerChannel *c, ssize_t n, const SimParams *p, double now, FILE *log) {
+    if (n > 0) {
+        c->msgs++;
+        if (c->state == CHAN_RESTARTING) {
+            c->state = CHAN_OPEN;
+            if (log) {
+                fprintf(log, "[B] CHAN %s: open again (first message from pid %d)\n",
+                        c->name, (int)c->pid);
+                fflush(log);
+            }
+        }
+        return 1;
+    }
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) return 0;
+
+    chan_close(c, n == 0 ? "EOF" : strerror(errno), p, now, log);
+    return 0;
+}
+
+int chan_poll(PeerChannel *c, const SimParams *p, double now, FILE *log) {
+    int changed = 0;
+
+    // Reaps an exited writer; unread messages are still delivered (DRAINING)
+    if (c->pid > 0) {
+        int st = 0;
+        if (waitpid(c->pid, &st, WNOHANG) == c->pid) {
+            if (log) {
+                if (WIFSIGNALED(st)) fprintf(log, "[B] CHAN %s: pid %d killed by signal %d\n",
+                                             c->name, (int)c->pid, WTERMSIG(st));
+                else                 fprintf(log, "[B] CHAN %s: pid %d exited (status %d)\n",
+                                             c->name, (int)c->pid, WEXITSTATUS(st));
+                fflush(log);
+            }
+            c->pid  = -1;
+            changed = 1;
+            if (c->state == CHAN_OPEN || c->state == CHAN_RESTARTING) c->state = CHAN_DRAINING;
+        }
+    }
+
+    // Draining ends as soon as nothing is buffered (EOF may never come if the
+    // write end leaked into another process)
+    if (c->state == CHAN_DRAINING) {
+        int pending = 0;
+        if (ioctl(c->fd, FIONREAD, &pending) == -1 || pending == 0) {
+            chan_close(c, "writer exited", p, now, log);
+        }
+    }
+
+    if (c->state == CHAN_CLOSED && c->entry &&
+        c->restarts < p->peer_max_restarts && now >= c->retry_at) {
+        if (chan_respawn(c, p, log) == 0) changed = 1;
+        else                              c->retry_at = now + p->peer_restart_sec;
+    }
+    return changed;
+}
@@ -0,0 +1,275 @@
+// ctrl.c
+// External controller API in B: seqpacket listener, command handling,
+// arbitration against the keyboard, state stream
+// ======================================================================
+
+#define _GNU_SOURCE
+#include "headers/ctrl.h"
+#include "headers/logcat.h"
+#include "headers/faults.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+int64_t ctrl_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static double now_sec(void) {
+    return 1e-9 * (double)ctrl_now_ns();
+}
+
+// Never blocks: a controller that does not read loses packets, not B's time.
+static int send_evt(CtrlClient *cl, CtrlEvt *e) {
+    e->t_ns = ctrl_now_ns();
+    return (send(cl->fd, e, sizeof(*e), MSG_DONTWAIT | MSG_NOSIGNAL) == (ssize_t)sizeof(*e)) ? 0 : -1;
+}
+
+static void reply(CtrlClient *cl, uint32_t type, const CtrlCmd *cmd, uint32_t flags) {
+    CtrlEvt e;
+    memset(&e, 0, sizeof(e));
+    e.type      = type;
+    e.drone     = cmd->drone;
+    e.flags     = flags;
+    e.seq       = cmd->seq;
+    e.echo_t_ns = cmd->t_ns;
+    send_evt(cl, &e);
+}
+
+int ctrl_open(CtrlServer *c, const char *path, FILE *log) {
+    memset(c, 0, sizeof(*c));
+    c->listen_fd = -1;
+    c->owner     = -1;
+    for (int i = 0; i < CTRL_MAX_CLIENTS; ++i) c->cl[i].fd = -1;
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        if (log) fprintf(log, "[B] CTRL: socket failed: %s\n", strerror(errno));
+        return -1;
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    unlink(path);   // stale socket from a previous run
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(fd, CTRL_MAX_CLIENTS) == -1) {
+        if (log) fprintf(log, "[B] CTRL: cannot listen on %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    c->listen_fd = fd;
+    if (log) fprintf(log, "[B] CTRL: listening on %s (seqpacket, budget %d us RTT)\n",
+                     path, CTRL_RTT_BUDGET_US_SEQPACKET);
+    return 0;
+}
+
+void ctrl_watch(const CtrlServer *c, fd_set *set, int *maxfd) {
+    if (c->listen_fd < 0) return;
+    FD_SET(c->listen_fd, set);
+    if (c->listen_fd > *maxfd) *maxfd = c->listen_fd;
+    for (int i = 0; i < CTRL_MAX_CLIENTS; ++i) {
+        int fd = c->cl[i].fd;
+        if (fd < 0) continue;
+        FD_SET(fd, set);
+        if (fd > *maxfd) *maxfd = fd;
+    }
+}
+
+int ctrl_has_owner(const CtrlServer *c) {
+    return c->owner >= 0;
+}
+
+void ctrl_revoke(CtrlServer *c, const char *why, FILE *log) {
+    if (c->owner < 0) return;
+    CtrlClient *cl = &c->cl[c->owner];
+    if (cl->fd >= 0) {
+        CtrlEvt e;
+        memset(&e, 0, sizeof(e));
+        e.type = CTRL_REVOKED;
+        e.seq  = c->last_seq;
+        send_evt(cl, &e);
+    }
+    if (log) fprintf(log, "[B] CTRL: control of client %d revoked (%s) -> keyboard\n", c->owner, why);
+    c->owner = -1;
+}
+
+int ctrl_check_timeout(CtrlServer *c, double now, double timeout_sec, FILE *log) {
+    if (c->owner < 0 || now - c->owner_last < timeout_sec) return 0;
+    ctrl_revoke(c, "controller silent", log);
+    return 1;
+}
+
+static void drop_client(CtrlServer *c, int i, FILE *log) {
+    if (log) fprintf(log, "[B] CTRL: client %d disconnected (%ld state(s) dropped)\n",
+                     i, c->cl[i].dropped);
+    close(c->cl[i].fd);
+    c->cl[i].fd         = -1;
+    c->cl[i].subscribed = 0;
+    c->cl[i].dropped    = 0;
+}
+
+// Handles one command. Returns 1 if the user force changed.
+static int handle_cmd(CtrlServer *c, int i, const CtrlCmd *cmd, ForceStateMsg *user_force, FILE *log) {
+    CtrlClient *cl = &c->cl[i];
+    if (cmd->version != CTRL_PROTO_VERSION) {
+        reply(cl, CTRL_DENIED, cmd, 0);
+        c->denied++;
+        return 0;
+    }
+    if (c->owner == i) c->owner_last = now_sec();
+
+    switch (cmd->type) {
+        case CTRL_HELLO: {
+            cl->subscribed = (cmd->flags & CTRL_F_STATE) != 0;
+            uint32_t granted = 0;
+            if ((cmd->flags & CTRL_F_CONTROL) && (c->owner < 0 || c->owner == i)) {
+                c->owner      = i;
+                c->owner_last = now_sec();
+                c->last_t_ns  = 0;
+                granted       = CTRL_F_CONTROL;
+                if (log) fprintf(log, "[B] CTRL: client %d has control\n", i);
+            }
+            reply(cl, CTRL_WELCOME, cmd, granted | (cl->subscribed ? CTRL_F_STATE : 0));
+            return 0;
+        }
+        case CTRL_FORCE:
+            if (c->owner != i || cmd->drone != 0) {
+                reply(cl, CTRL_DENIED, cmd, 0);
+                c->denied++;
+                return 0;
+            }
+            if (cmd->t_ns < c->last_t_ns) return 0;   // reordered / stale command
+            user_force->Fx = cmd->fx;
+            user_force->Fy = cmd->fy;
+            c->last_seq    = cmd->seq;
+            c->last_t_ns   = cmd->t_ns;
+            c->cmd_age_ms  = 1e-6 * (double)(ctrl_now_ns() - cmd->t_ns);
+            c->cmds++;
+            return 1;
+        case CTRL_PING:
+            reply(cl, CTRL_PONG, cmd, 0);
+            return 0;
+        case CTRL_RELEASE:
+            if (c->owner != i) return 0;
+            c->owner = -1;
+            if (log) fprintf(log, "[B] CTRL: client %d released control -> keyboard\n", i);
+            user_force->Fx = 0.0;   // nobody steers: stop pushing
+            user_force->Fy = 0.0;
+            return 1;
+        case CTRL_LOG:
+            // Logging is not part of the drone: no ownership needed
+            if (cmd->drone > LOGC_COUNT) {
+                reply(cl, CTRL_DENIED, cmd, 0);
+                c->denied++;
+                return 0;
+            }
+            logc_set(cmd->drone == LOGC_COUNT ? -1 : (int)cmd->drone, (int)cmd->flags,
+                     (int)cmd->fx, cmd->fy);
+            reply(cl, CTRL_ACK, cmd, 0);
+            return 0;
+        case CTRL_FAULT: {
+            char why[32];
+            snprintf(why, sizeof(why), "ctrl client %d", i);
+            if (fault_set((int)cmd->drone, cmd->fx, why, log) != 0) {
+                reply(cl, CTRL_DENIED, cmd, 0);
+                c->denied++;
+                return 0;
+            }
+            reply(cl, CTRL_ACK, cmd, 0);
+            return 0;
+        }
+        default:
+            reply(cl, CTRL_DENIED, cmd, 0);
+            c->denied++;
+            return 0;
+    }
+}
+
+int ctrl_handle(CtrlServer *c, const fd_set *rfds, ForceStateMsg *user_force, FILE *log) {
+    if (c->listen_fd < 0) return 0;
+    int changed = 0;
+
+    if (FD_ISSET(c->listen_fd, rfds)) {
+        int fd;
+        while ((fd = accept4(c->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+            int slot = -1;
+            for (int i = 0; i < CTRL_MAX_CLIENTS && slot < 0; ++i)
+                if (c->cl[i].fd < 0) slot = i;
+            if (slot < 0) {
+                if (log) fprintf(log, "[B] CTRL: client refused (%d already connected)\n", CTRL_MAX_CLIENTS);
+                close(fd);
+                continue;
+            }
+            c->cl[slot].fd = fd;
+            if (log) fprintf(log, "[B] CTRL: client %d connected\n", slot);
+        }
+    }
+
+    for (int i = 0; i < CTRL_MAX_CLIENTS; ++i) {
+        if (c->cl[i].fd < 0 || !FD_ISSET(c->cl[i].fd, rfds)) continue;
+        while (c->cl[i].fd >= 0) {
+            CtrlCmd cmd;
+            ssize_t n = recv(c->cl[i].fd, &cmd, sizeof(cmd), 0);
+            if (n == (ssize_t)sizeof(cmd)) {
+                changed |= handle_cmd(c, i, &cmd, user_force, log);
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (n < 0 && errno == EINTR) continue;
+            if (n > 0) {
+                c->denied++;   // wrong packet size: not our protocol
+                continue;
+            }
+            // EOF or error: an owner that goes away leaves the drone unpowered
+            if (c->owner == i) {
+                c->owner = -1;
+                user_force->Fx = 0.0;
+                user_force->Fy = 0.0;
+                changed = 1;
+                if (log) fprintf(log, "[B] CTRL: owner client %d gone -> keyboard\n", i);
+            }
+            drop_client(c, i, log);
+        }
+    }
+    return changed;
+}
+
+void ctrl_publish_state(CtrlServer *c, const DroneStateMsg *s, int tick,
+                        const ForceStateMsg *user_force) {
+    if (c->listen_fd < 0) return;
+    CtrlEvt e;
+    memset(&e, 0, sizeof(e));
+    e.type      = CTRL_STATE;
+    e.drone     = 0;
+    e.flags     = (c->owner >= 0) ? CTRL_F_CONTROL : 0;
+    e.seq       = c->last_seq;
+    e.echo_t_ns = c->last_t_ns;
+    e.tick      = tick;
+    e.state     = *s;
+    e.fx        = user_force->Fx;
+    e.fy        = user_force->Fy;
+    for (int i = 0; i < CTRL_MAX_CLIENTS; ++i) {
+        if (c->cl[i].fd < 0 || !c->cl[i].subscribed) continue;
+        if (send_evt(&c->cl[i], &e) == -1) c->cl[i].dropped++;
+    }
+}
+
+void ctrl_close(CtrlServer *c, const char *path) {
+    if (c->listen_fd < 0) return;
+    for (int i = 0; i < CTRL_MAX_CLIENTS; ++i) {
+        if (c->cl[i].fd >= 0) close(c->cl[i].fd);
+        c->cl[i].fd = -1;
+    }
+    close(c->listen_fd);
+    c->listen_fd = -1;
+    unlink(path);
+}
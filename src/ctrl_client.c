@@ -0,0 +1,275 @@
+// ctrl_client.c
+// arp1_ctrl: reference client for the controller API (ctrl.h)
+//   ping   RTT through B's event loop, checked against the published budget
+//   watch  prints the state stream (TSV)
+//   force  takes control and streams a constant force, one command per
+//          state; reports command -> first state carrying it
+//   log    changes B's log level / sampling / rate limit for a category
+//   fault  sets an injected fault (builds with FAULTS=1)
+// ======================================================================
+
+#define _GNU_SOURCE
+#include "headers/ctrl.h"
+#include "headers/logcat.h"   // LogCat, LOGC_NAMES
+#include "headers/faults.h"   // FaultId, FAULT_NAMES
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static uint32_t g_seq = 0;
+
+// Same clock as B (CLOCK_MONOTONIC); ctrl.c is not linked into the client
+int64_t ctrl_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int connect_b(const char *path) {
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (fd == -1) {
+        perror("[CTRL] socket");
+        exit(EXIT_FAILURE);
+    }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        fprintf(stderr, "[CTRL] cannot connect to %s: %s (is arp1 running with ctrl_socket = 1?)\n",
+                path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    return fd;
+}
+
+static void send_cmd(int fd, uint32_t type, uint32_t flags, double fx, double fy, int64_t *t_out) {
+    CtrlCmd c;
+    memset(&c, 0, sizeof(c));
+    c.type    = type;
+    c.version = CTRL_PROTO_VERSION;
+    c.drone   = 0;
+    c.flags   = flags;
+    c.seq     = ++g_seq;
+    c.fx      = fx;
+    c.fy      = fy;
+    c.t_ns    = ctrl_now_ns();
+    if (t_out) *t_out = c.t_ns;
+    if (send(fd, &c, sizeof(c), 0) != (ssize_t)sizeof(c)) {
+        perror("[CTRL] send");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Waits up to timeout_ms for one event. Returns 0 on success, -1 on timeout/EOF.
+static int recv_evt(int fd, CtrlEvt *e, int timeout_ms) {
+    struct pollfd p = { .fd = fd, .events = POLLIN };
+    if (poll(&p, 1, timeout_ms) <= 0) return -1;
+    ssize_t n = recv(fd, e, sizeof(*e), 0);
+    return (n == (ssize_t)sizeof(*e)) ? 0 : -1;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void print_quantiles(const char *what, double *v, int n) {
+    qsort(v, (size_t)n, sizeof(double), cmp_double);
+    printf("%s: n=%d p50=%.1fus p99=%.1fus max=%.1fus\n",
+           what, n, v[n / 2], v[(int)(0.99 * (n - 1))], v[n - 1]);
+}
+
+// Commands
+// ----------------------------------------------------------------------
+static int cmd_ping(int fd, int n) {
+    double *rtt = calloc((size_t)n, sizeof(double));
+    if (!rtt) return EXIT_FAILURE;
+    int got = 0;
+    for (int i = 0; i < n; ++i) {
+        int64_t t0;
+        send_cmd(fd, CTRL_PING, 0, 0.0, 0.0, &t0);
+        CtrlEvt e;
+        while (recv_evt(fd, &e, 1000) == 0) {
+            if (e.type == CTRL_PONG && e.echo_t_ns == t0) {
+                rtt[got++] = 1e-3 * (double)(ctrl_now_ns() - t0);
+                break;
+            }
+        }
+    }
+    if (got == 0) {
+        fprintf(stderr, "[CTRL] no PONG received\n");
+        return EXIT_FAILURE;
+    }
+    print_quantiles("seqpacket rtt", rtt, got);
+    double p99 = rtt[(int)(0.99 * (got - 1))];
+    printf("budget %dus (p99): %s\n", CTRL_RTT_BUDGET_US_SEQPACKET,
+           p99 <= CTRL_RTT_BUDGET_US_SEQPACKET ? "PASS" : "FAIL");
+    free(rtt);
+    return p99 <= CTRL_RTT_BUDGET_US_SEQPACKET ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int cmd_watch(int fd, int n) {
+    send_cmd(fd, CTRL_HELLO, CTRL_F_STATE, 0.0, 0.0, NULL);
+    printf("tick\tx\ty\tvx\tvy\tfx\tfy\tcontrolled\n");
+    for (int i = 0; i < n; ) {
+        CtrlEvt e;
+        if (recv_evt(fd, &e, 2000) != 0) break;
+        if (e.type != CTRL_STATE) continue;
+        printf("%d\t%.3f\t%.3f\t%.3f\t%.3f\t%.2f\t%.2f\t%d\n", e.tick, e.state.x, e.state.y,
+               e.state.vx, e.state.vy, e.fx, e.fy, (e.flags & CTRL_F_CONTROL) != 0);
+        ++i;
+    }
+    return EXIT_SUCCESS;
+}
+
+// Sends one settings command (CTRL_LOG, CTRL_FAULT) and waits for its ACK / DENIED.
+static int send_setting(int fd, uint32_t type, uint32_t drone, uint32_t flags, double fx, double fy,
+                        const char *what, const char *name) {
+    CtrlCmd m;
+    memset(&m, 0, sizeof(m));
+    m.type    = type;
+    m.version = CTRL_PROTO_VERSION;
+    m.drone   = drone;
+    m.flags   = flags;
+    m.seq     = ++g_seq;
+    m.t_ns    = ctrl_now_ns();
+    m.fx      = fx;
+    m.fy      = fy;
+    if (send(fd, &m, sizeof(m), 0) != (ssize_t)sizeof(m)) {
+        perror("[CTRL] send");
+        return EXIT_FAILURE;
+    }
+    CtrlEvt e;
+    while (recv_evt(fd, &e, 2000) == 0) {
+        if (e.seq != m.seq) continue;
+        printf("%s %s: %s\n", what, name, e.type == CTRL_ACK ? "applied" : "refused");
+        return e.type == CTRL_ACK ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    fprintf(stderr, "[CTRL] no reply from B\n");
+    return EXIT_FAILURE;
+}
+
+static int cmd_log(int fd, const char *cat, int level, int every, double rate) {
+    static const char *names[LOGC_COUNT] = LOGC_NAMES;
+    uint32_t c = LOGC_COUNT;   // "all"
+    if (strcmp(cat, "all") != 0) {
+        for (c = 0; c < LOGC_COUNT && strcmp(cat, names[c]) != 0; ++c) {}
+        if (c == LOGC_COUNT) {
+            fprintf(stderr, "[CTRL] unknown log category '%s' (state, force, keys, entity, all)\n", cat);
+            return EXIT_FAILURE;
+        }
+    }
+
+    return send_setting(fd, CTRL_LOG, c, (uint32_t)level, every, rate, "log", cat);
+}
+
+static int cmd_fault(int fd, const char *name, double value) {
+    static const char *names[FLT_COUNT] = FAULT_NAMES;
+    uint32_t id;
+    for (id = 0; id < FLT_COUNT && strcmp(name, names[id]) != 0; ++id) {}
+    if (id == FLT_COUNT) {
+        fprintf(stderr, "[CTRL] unknown fault '%s' (", name);
+        for (int i = 0; i < FLT_COUNT; ++i) fprintf(stderr, "%s%s", i ? ", " : "", names[i]);
+        fprintf(stderr, ")\n");
+        return EXIT_FAILURE;
+    }
+    int rc = send_setting(fd, CTRL_FAULT, id, 0, value, 0.0, "fault", name);
+    if (rc != EXIT_SUCCESS) fprintf(stderr, "[CTRL] is arp1 built with make FAULTS=1?\n");
+    return rc;
+}
+
+static int cmd_force(int fd, double fx, double fy, double secs) {
+    send_cmd(fd, CTRL_HELLO, CTRL_F_CONTROL | CTRL_F_STATE, 0.0, 0.0, NULL);
+    CtrlEvt e;
+    if (recv_evt(fd, &e, 2000) != 0 || e.type != CTRL_WELCOME || !(e.flags & CTRL_F_CONTROL)) {
+        fprintf(stderr, "[CTRL] control not granted (another controller owns the drone?)\n");
+        return EXIT_FAILURE;
+    }
+
+    int     cap = 100000, n = 0;
+    double *lat = calloc((size_t)cap, sizeof(double));
+    if (!lat) return EXIT_FAILURE;
+    int64_t pending = 0;     // t_ns of the command not yet seen in a state
+    int64_t end = ctrl_now_ns() + (int64_t)(secs * 1e9);
+    send_cmd(fd, CTRL_FORCE, 0, fx, fy, &pending);
+
+    while (ctrl_now_ns() < end) {
+        if (recv_evt(fd, &e, 1000) != 0) break;
+        if (e.type == CTRL_REVOKED) {
+            fprintf(stderr, "[CTRL] control revoked by B\n");
+            break;
+        }
+        if (e.type != CTRL_STATE) continue;
+        if (pending && e.echo_t_ns == pending) {
+            if (n < cap) lat[n++] = 1e-3 * (double)(ctrl_now_ns() - pending);
+            pending = 0;
+        }
+        // One command per state keeps the owner alive and the force fresh
+        if (!pending) send_cmd(fd, CTRL_FORCE, 0, fx, fy, &pending);
+    }
+    send_cmd(fd, CTRL_RELEASE, 0, 0.0, 0.0, NULL);
+    if (n > 0) print_quantiles("command -> state", lat, n);
+    free(lat);
+    return EXIT_SUCCESS;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-s socket] [-n count] [-t seconds] ping | watch | force <fx> <fy>\n"
+            "       %s log <state|force|keys|entity|all> <level 0-3> [every] [rate]\n"
+            "       %s fault <name> <value>\n"
+            "  ping   round trips through B (default 1000), p99 checked against %dus\n"
+            "  watch  print count states (default 100)\n"
+            "  force  take control, stream (fx, fy) for t seconds (default 5), then release\n"
+            "  log    set a log category: level, 1 line in every, rate lines/s (omitted = kept)\n"
+            "  fault  set an injected fault, 0 = off (d_delay_ms, d_stall_sec, force_drop, ...)\n",
+            prog, prog, prog, CTRL_RTT_BUDGET_US_SEQPACKET);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv) {
+    const char *path = CTRL_SOCKET_PATH;
+    int    count = -1;
+    double secs  = 5.0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:t:h")) != -1) {
+        switch (opt) {
+            case 's': path = optarg; break;
+            case 'n': count = atoi(optarg); break;
+            case 't': secs = strtod(optarg, NULL); break;
+            default:  usage(argv[0]);
+        }
+    }
+    if (optind >= argc) usage(argv[0]);
+    const char *what = argv[optind];
+
+    int fd = connect_b(path);
+    int rc;
+    if (strcmp(what, "ping") == 0) {
+        rc = cmd_ping(fd, count > 0 ? count : 1000);
+    } else if (strcmp(what, "watch") == 0) {
+        rc = cmd_watch(fd, count > 0 ? count : 100);
+    } else if (strcmp(what, "force") == 0 && optind + 2 < argc) {
+        rc = cmd_force(fd, strtod(argv[optind + 1], NULL), strtod(argv[optind + 2], NULL), secs);
+    } else if (strcmp(what, "log") == 0 && optind + 2 < argc) {
+        rc = cmd_log(fd, argv[optind + 1], atoi(argv[optind + 2]),
+                     optind + 3 < argc ? atoi(argv[optind + 3]) : 0,
+                     optind + 4 < argc ? strtod(argv[optind + 4], NULL) : -1.0);
+    } else if (strcmp(what, "fault") == 0 && optind + 2 < argc) {
+        rc = cmd_fault(fd, argv[optind + 1], strtod(argv[optind + 2], NULL));
+    } else {
+        usage(argv[0]);
+        rc = EXIT_FAILURE;
+    }
+    close(fd);
+    return rc;
+}
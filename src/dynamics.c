@@ -6,12 +6,24 @@
 #include "headers/dynamics.h"
 #include "headers/messages.h"
 #include "headers/util.h"
+#include "headers/topology.h"  // component_exit()
+#include "headers/scenario.h"
+#include "headers/faults.h"
+#include "headers/alloccheck.h"
+#include "headers/perfctr.h"
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>     // exit, strtod
 #include <errno.h>
 #include <time.h>
 #include <fcntl.h>
+#include <signal.h>
+
+static void dynamics_loop(int force_fd, int state_fd, SimParams params, int primary, FILE *log);
+
+// Loop phases for the hardware counters (perf_counters = 1)
+enum { DPH_READ, DPH_STEP, DPH_WRITE, DPH_SLEEP, DPH_COUNT };
+static const char *const k_d_phases[DPH_COUNT] = { "read", "step", "write", "sleep" };
 
 /**
  * @brief Main loop for the Dynamics (D) process.
@@ -39,9 +51,46 @@ void run_dynamics_process(int force_fd, int state_fd, SimParams params) {
             "[D] Dynamics process started | PID = %d\n, M=%.3f, K=%.3f, dt=%.3f\n",
             getpid(), params.mass, params.visc, params.dt);
 
+    dynamics_loop(force_fd, state_fd, params, 1, log);
+
+    close(force_fd);
+    close(state_fd);
+    component_exit(EXIT_SUCCESS);   // pthread_exit() when running as a thread in B
+}
+
+// Hot-standby replica: same loop, own log, forked from B at any time.
+// ----------------------------------------------------------------------
+void run_dynamics_replica(int force_fd, int state_fd, SimParams params, int generation) {
+    // Forked from B: drop B's signal handlers and every inherited fd but ours
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGUSR1, SIG_DFL);
+    signal(SIGUSR2, SIG_DFL);
+    long max_fd = sysconf(_SC_OPEN_MAX);
+    if (max_fd < 0 || max_fd > 4096) max_fd = 4096;
+    for (int fd = 3; fd < max_fd; ++fd) {
+        if (fd != force_fd && fd != state_fd) close(fd);
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "dynamics_standby_%d", generation);
+    FILE *log = open_process_log(name, "D");
+    if (!log) log = stderr;
+    fprintf(log, "[D] Standby replica #%d started | PID = %d\n", generation, getpid());
+
+    dynamics_loop(force_fd, state_fd, params, 0, log);   // primary once promoted
+
+    fprintf(log, "[D] Standby replica #%d exiting.\n", generation);
+    fclose(log);
+    _exit(EXIT_SUCCESS);    // never run B's atexit handlers / stdio buffers
+}
+
+// Integrates until B closes the force channel (or a write fails).
+// ----------------------------------------------------------------------
+static void dynamics_loop(int force_fd, int state_fd, SimParams params, int primary, FILE *log) {
     double M = params.mass;
     double K = params.visc;
     double T = params.dt;
+    double next_step = -1.0;   // absolute deadline of the next step (pace_sim_sec)
 
     ForceStateMsg f;
     f.Fx = 0.0;
@@ -50,6 +99,19 @@ void run_dynamics_process(int force_fd, int state_fd, SimParams params) {
 
     DroneStateMsg s = (DroneStateMsg){0.0, 0.0, 0.0, 0.0};
 
+    // Scenario runs start from the scripted initial state
+    const Scenario *scn = scenario_active();
+    if (scn && scn->has_drone) {
+        s = scn->drone;
+        fprintf(log, "[D] Scenario initial state x=%.2f y=%.2f vx=%.2f vy=%.2f\n",
+                s.x, s.y, s.vx, s.vy);
+    }
+
+    AllocTick at;
+    ALLOC_TICK_INIT(&at, ALC_D);
+    PerfCounters pc;
+    pc_open(&pc, "D", k_d_phases, DPH_COUNT, params.perf_counters, log);
+
     int flags = fcntl(force_fd, F_GETFL, 0);
     if (flags == -1) flags = 0;
     if (fcntl(force_fd, F_SETFL, flags | O_NONBLOCK) == -1) {
@@ -58,20 +120,29 @@ void run_dynamics_process(int force_fd, int state_fd, SimParams params) {
     }
 
     while (1) {
-        // Reads any new force command from B (non-blocking).
-        ForceStateMsg new_f;
-        int n = read(force_fd, &new_f, sizeof(new_f));
+        ALLOC_TICK(&at, log);   // steady-state ticks must not allocate (ALLOC_CHECK=1)
 
-        if (n == (int)sizeof(new_f)) {
-            if (new_f.reset != 0) {
+        // Reads every pending force command from B (non-blocking) and keeps the
+        // latest one; B sends only on change, so f is held until the next command.
+        ForceStateMsg new_f;
+        int n;
+        while ((n = read(force_fd, &new_f, sizeof(new_f))) == (int)sizeof(new_f)) {
+            if (new_f.reset == FORCE_RESET) {
                 s.x  = 0.0;
                 s.y  = 0.0;
                 s.vx = 0.0;
                 s.vy = 0.0;
+            } else if (new_f.reset == FORCE_ADOPT_STATE || new_f.reset == FORCE_PROMOTE) {
+                s = new_f.state;    // standby sync / promotion: continue from B's state
+                if (new_f.reset == FORCE_PROMOTE && !primary) {
+                    primary = 1;
+                    fprintf(log, "[D] Promoted to primary\n");
+                }
             }
             f = new_f;
             f.reset = 0;
-        } else if (n == 0) {
+        }
+        if (n == 0) {
             fprintf(log, "[D] EOF on force pipe, exiting.\n");
             break;
         } else if (n < 0) {
@@ -83,17 +154,11 @@ void run_dynamics_process(int force_fd, int state_fd, SimParams params) {
         } else {
             fprintf(log, "[D] Partial read (%d bytes) on force pipe.\n", n);
         }
+        pc_lap(&pc, DPH_READ);
 
         // Computes wall repulsive force from current state
         double Pwx = 0.0, Pwy = 0.0;
-        compute_repulsive_P(&s, 
-                    &params, 
-                    0,
-                    0,
-                    true,   // calculate wall repulsion here
-                    false,   // obstactles treated in server side
-                    &Pwx, 
-                    &Pwy);
+        compute_wall_P(&s, &params, &Pwx, &Pwy);   // obstacles are treated on the server side
         // Calculates total force = user force from B + wall repulsive force
         double Fx_total = f.Fx + Pwx;
         double Fy_total = f.Fy + Pwy;
@@ -116,21 +181,27 @@ void run_dynamics_process(int force_fd, int state_fd, SimParams params) {
 
         s.x  += s.vx * T;
         s.y  += s.vy * T;
+        pc_lap(&pc, DPH_STEP);
 
         // Sends state back to B
         if (write(state_fd, &s, sizeof(s)) == -1) {
             perror("[D] write state");
             break;
         }
-
-        // Sleeps until next time step
-        struct timespec ts;
-        ts.tv_sec  = 0;
-        ts.tv_nsec = (long)(T * 1e9);
-        nanosleep(&ts, NULL);
+        pc_lap(&pc, DPH_WRITE);
+
+        // Injected faults: a slow loop, or one long stall (watchdog, failover).
+        // The stall is one-shot in the shared table: only the primary takes it,
+        // a replica would consume it and leave the primary running.
+        FAULT_SLEEP_MS(FLT_D_DELAY_MS);
+        double stalled = primary ? FAULT_STALL(FLT_D_STALL_SEC) : 0.0;
+        if (stalled > 0.0) fprintf(log, "[D] FAULT: stalled %.2fs\n", stalled);
+
+        // Sleeps until the next time step (shortened by time_scale in soak runs)
+        pace_sim_sec(&next_step, T, &params);
+        pc_lap(&pc, DPH_SLEEP);
+        pc_report(&pc, pc.last_wall, 0, log);   // wall time of that lap
     }
-
-    close(force_fd);
-    close(state_fd);
-    exit(EXIT_SUCCESS);
+    pc_report(&pc, 0.0, 1, log);
+    pc_close(&pc);
 }
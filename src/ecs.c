@@ -0,0 +1,267 @@
+// ecs.c
+// Entity-component store and system scheduler (see ecs.h)
+// ======================================================================
+
+#define _GNU_SOURCE
+#include "headers/ecs.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const unsigned k_masks[ECS_ARCH_COUNT] = ECS_ARCH_MASKS;
+
+static EcsId make_id(int index, uint16_t gen) {
+    return ((EcsId)gen << ECS_INDEX_BITS) | (EcsId)index;
+}
+
+// Storage
+// ----------------------------------------------------------------------
+static int arch_init(EcsArchetype *a, unsigned mask, int cap) {
+    memset(a, 0, sizeof(*a));
+    a->mask = mask;
+    a->cap  = cap;
+    size_t n = (size_t)(cap > 0 ? cap : 1);
+    a->id = calloc(n, sizeof(EcsId));
+    if (!a->id) return -1;
+    if (mask & ECS_POS)   { a->x  = calloc(n, sizeof(double)); a->y  = calloc(n, sizeof(double)); if (!a->x  || !a->y)  return -1; }
+    if (mask & ECS_VEL)   { a->vx = calloc(n, sizeof(double)); a->vy = calloc(n, sizeof(double)); if (!a->vx || !a->vy) return -1; }
+    if (mask & ECS_FORCE) {
+        a->ux = calloc(n, sizeof(double)); a->uy = calloc(n, sizeof(double));
+        a->fx = calloc(n, sizeof(double)); a->fy = calloc(n, sizeof(double));
+        if (!a->ux || !a->uy || !a->fx || !a->fy) return -1;
+    }
+    if (mask & ECS_LIFE)  { a->life  = calloc(n, sizeof(int));    if (!a->life)  return -1; }
+    if (mask & ECS_SENSE) { a->sense = calloc(n, sizeof(double)); if (!a->sense) return -1; }
+    if (mask & ECS_SLOT)  { a->slot  = calloc(n, sizeof(int));    if (!a->slot)  return -1; }
+    return 0;
+}
+
+static void arch_free(EcsArchetype *a) {
+    free(a->id);
+    free(a->x);  free(a->y);
+    free(a->vx); free(a->vy);
+    free(a->ux); free(a->uy);
+    free(a->fx); free(a->fy);
+    free(a->life);
+    free(a->sense);
+    free(a->slot);
+    memset(a, 0, sizeof(*a));
+}
+
+// Copies row `from` over row `to` (every column the archetype has).
+static void arch_move_row(EcsArchetype *a, int to, int from) {
+    a->id[to] = a->id[from];
+    if (a->x)     { a->x[to]  = a->x[from];  a->y[to]  = a->y[from]; }
+    if (a->vx)    { a->vx[to] = a->vx[from]; a->vy[to] = a->vy[from]; }
+    if (a->ux)    { a->ux[to] = a->ux[from]; a->uy[to] = a->uy[from];
+                    a->fx[to] = a->fx[from]; a->fy[to] = a->fy[from]; }
+    if (a->life)  a->life[to]  = a->life[from];
+    if (a->sense) a->sense[to] = a->sense[from];
+    if (a->slot)  a->slot[to]  = a->slot[from];
+}
+
+int ecs_init(EcsWorld *w, const int cap[ECS_ARCH_COUNT]) {
+    memset(w, 0, sizeof(*w));
+    int total = 0;
+    for (int i = 0; i < ECS_ARCH_COUNT; ++i) {
+        if (arch_init(&w->arch[i], k_masks[i], cap[i]) != 0) {
+            ecs_free(w);
+            return -1;
+        }
+        total += cap[i];
+    }
+    if (total < 1 || total > (int)ECS_INDEX_MASK) {
+        ecs_free(w);
+        return -1;
+    }
+    w->cap      = total;
+    w->gen      = calloc((size_t)total, sizeof(uint16_t));
+    w->arch_of  = calloc((size_t)total, sizeof(uint8_t));
+    w->row      = malloc((size_t)total * sizeof(int));
+    w->free_idx = malloc((size_t)total * sizeof(int));
+    w->pending  = malloc((size_t)total * sizeof(EcsId));
+    if (!w->gen || !w->arch_of || !w->row || !w->free_idx || !w->pending) {
+        ecs_free(w);
+        return -1;
+    }
+    for (int i = 0; i < total; ++i) {
+        w->gen[i] = 1;                        // id 0 stays invalid
+        w->row[i] = -1;
+        w->free_idx[i] = total - 1 - i;       // lowest index first
+    }
+    w->n_free = total;
+    return 0;
+}
+
+void ecs_free(EcsWorld *w) {
+    for (int i = 0; i < ECS_ARCH_COUNT; ++i) arch_free(&w->arch[i]);
+    free(w->gen);
+    free(w->arch_of);
+    free(w->row);
+    free(w->free_idx);
+    free(w->pending);
+    memset(w, 0, sizeof(*w));
+}
+
+EcsId ecs_spawn(EcsWorld *w, EcsArch a) {
+    EcsArchetype *ar = &w->arch[a];
+    if (ar->n >= ar->cap || w->n_free == 0) return 0;
+
+    int index = w->free_idx[--w->n_free];
+    int r     = ar->n++;
+    EcsId id  = make_id(index, w->gen[index]);
+    w->arch_of[index] = (uint8_t)a;
+    w->row[index]     = r;
+
+    ar->id[r] = id;
+    if (ar->x)     { ar->x[r]  = 0.0; ar->y[r]  = 0.0; }
+    if (ar->vx)    { ar->vx[r] = 0.0; ar->vy[r] = 0.0; }
+    if (ar->ux)    { ar->ux[r] = ar->uy[r] = ar->fx[r] = ar->fy[r] = 0.0; }
+    if (ar->life)  ar->life[r]  = 0;
+    if (ar->sense) ar->sense[r] = 0.0;
+    if (ar->slot)  ar->slot[r]  = 0;
+    return id;
+}
+
+int ecs_row(const EcsWorld *w, EcsId id, EcsArch *a) {
+    int index = (int)(id & ECS_INDEX_MASK);
+    if (id == 0 || index >= w->cap || w->row[index] < 0) return -1;
+    if (w->gen[index] != (uint16_t)(id >> ECS_INDEX_BITS)) return -1;   // stale
+    if (a) *a = (EcsArch)w->arch_of[index];
+    return w->row[index];
+}
+
+void ecs_destroy(EcsWorld *w, EcsId id) {
+    EcsArch a;
+    int r = ecs_row(w, id, &a);
+    if (r < 0) return;
+
+    EcsArchetype *ar = &w->arch[a];
+    int last = --ar->n;
+    if (r != last) {
+        // Dense columns: the last row fills the hole
+        arch_move_row(ar, r, last);
+        w->row[ar->id[r] & ECS_INDEX_MASK] = r;
+    }
+    int index = (int)(id & ECS_INDEX_MASK);
+    w->row[index] = -1;
+    if (++w->gen[index] == 0) w->gen[index] = 1;
+    w->free_idx[w->n_free++] = index;
+}
+
+void ecs_destroy_later(EcsWorld *w, EcsId id) {
+    int slot = __atomic_fetch_add(&w->n_pending, 1, __ATOMIC_RELAXED);
+    if (slot < w->cap) w->pending[slot] = id;
+}
+
+void ecs_apply_pending(EcsWorld *w) {
+    int n = w->n_pending < w->cap ? w->n_pending : w->cap;
+    for (int i = 0; i < n; ++i) ecs_destroy(w, w->pending[i]);   // repeats are stale: no-op
+    w->n_pending = 0;
+}
+
+// Scheduler
+// ----------------------------------------------------------------------
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static int conflicts(const EcsSystem *a, const EcsSystem *b) {
+    return (a->writes & (b->reads | b->writes)) || (b->writes & a->reads);
+}
+
+// Worker `me` runs its lane of the current stage.
+static void run_lane(EcsSched *s, int me) {
+    for (int i = 0; i < s->n; ++i) {
+        if (s->stage[i] != s->cur_stage || s->lane[i] != me) continue;
+        double t0 = now_sec();
+        s->sys[i].fn(s->world, s->sys[i].ctx);
+        s->sys_sec[i] += now_sec() - t0;   // one writer per system
+    }
+}
+
+static void *worker_main(void *arg) {
+    EcsWorkerArg *wa = (EcsWorkerArg *)arg;
+    EcsSched     *s  = wa->sched;
+    for (;;) {
+        pthread_barrier_wait(&s->start);
+        if (s->cur_stage < 0) break;
+        run_lane(s, wa->me);
+        pthread_barrier_wait(&s->done);
+    }
+    return NULL;
+}
+
+int ecs_sched_init(EcsSched *s, const EcsSystem *systems, int n, int workers) {
+    memset(s, 0, sizeof(*s));
+    if (n < 1 || n > ECS_MAX_SYSTEMS) return -1;
+    if (workers < 1) workers = 1;
+    if (workers > ECS_MAX_WORKERS) workers = ECS_MAX_WORKERS;
+
+    // Earliest stage after every earlier system it conflicts with;
+    // within a stage, systems are dealt round-robin to the workers
+    int in_stage[ECS_MAX_SYSTEMS] = { 0 };
+    for (int i = 0; i < n; ++i) {
+        s->sys[i]   = systems[i];
+        s->stage[i] = 0;
+        for (int j = 0; j < i; ++j)
+            if (conflicts(&s->sys[i], &s->sys[j]) && s->stage[i] <= s->stage[j]) s->stage[i] = s->stage[j] + 1;
+        s->lane[i] = in_stage[s->stage[i]]++ % workers;
+        if (s->stage[i] + 1 > s->n_stages) s->n_stages = s->stage[i] + 1;
+    }
+    s->n       = n;
+    s->workers = workers;
+
+    if (workers > 1) {
+        if (pthread_barrier_init(&s->start, NULL, (unsigned)workers) != 0 ||
+            pthread_barrier_init(&s->done,  NULL, (unsigned)workers) != 0) return -1;
+        for (int i = 1; i < workers; ++i) {
+            s->arg[i] = (EcsWorkerArg){ s, i };
+            // Failure leaves the started workers parked on the barrier: callers give up
+            if (pthread_create(&s->tid[i], NULL, worker_main, &s->arg[i]) != 0) return -1;
+        }
+    }
+    return 0;
+}
+
+void ecs_sched_run(EcsSched *s, EcsWorld *w) {
+    s->world = w;
+    for (int st = 0; st < s->n_stages; ++st) {
+        s->cur_stage = st;
+        if (s->workers > 1) {
+            pthread_barrier_wait(&s->start);
+            run_lane(s, 0);
+            pthread_barrier_wait(&s->done);
+        } else {
+            run_lane(s, 0);
+        }
+        ecs_apply_pending(w);
+    }
+    s->ticks++;
+}
+
+void ecs_sched_report(const EcsSched *s, FILE *out) {
+    for (int st = 0; st < s->n_stages; ++st) {
+        fprintf(out, "  stage %d:", st);
+        for (int i = 0; i < s->n; ++i) {
+            if (s->stage[i] != st) continue;
+            fprintf(out, " %s (%.1f us)", s->sys[i].name,
+                    s->ticks ? 1e6 * s->sys_sec[i] / (double)s->ticks : 0.0);
+        }
+        fprintf(out, "\n");
+    }
+}
+
+void ecs_sched_free(EcsSched *s) {
+    if (s->workers > 1) {
+        s->cur_stage = -1;
+        pthread_barrier_wait(&s->start);
+        for (int i = 1; i < s->workers; ++i) pthread_join(s->tid[i], NULL);
+        pthread_barrier_destroy(&s->start);
+        pthread_barrier_destroy(&s->done);
+    }
+    s->workers = 0;
+}
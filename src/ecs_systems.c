@@ -0,0 +1,124 @@
+// ecs_systems.c
+// Systems of the drone world over ECS columns (see ecs.h)
+//   - B runs repulse (force sends), hit and age (every running tick) on its
+//     world; arp1_ecsbench runs all of them
+//   - the per-pair rules are util.h's obstacle_push() / target_reached() and
+//     D's compute_wall_P(), so there is one copy of each
+// ======================================================================
+
+#include "headers/ecs.h"
+#include "headers/util.h"     // obstacle_push(), target_reached(), compute_wall_P()
+#include "headers/render.h"   // render_cell()
+
+#include <math.h>
+#include <string.h>
+
+// Obstacle field on every drone: f = u + P (only the candidate rows, if given)
+void ecs_sys_repulse(EcsWorld *w, void *ctx) {
+    const EcsSimCtx    *c  = (const EcsSimCtx *)ctx;
+    EcsArchetype       *d  = &w->arch[ECS_DRONE];
+    const EcsArchetype *o  = &w->arch[ECS_OBSTACLE];
+    const double clearance = c->params->world_half * OBS_CLEARANCE_FRAC;
+    const int    n         = c->obs_rows ? c->n_obs_rows : o->n;
+
+    for (int i = 0; i < d->n; ++i) {
+        double Px = 0.0, Py = 0.0;
+        if (clearance > 0.0) {
+            for (int j = 0; j < n; ++j) {
+                int k = c->obs_rows ? c->obs_rows[j] : j;
+                obstacle_push(d->x[i] - o->x[k], d->y[i] - o->y[k], clearance, &Px, &Py);
+            }
+        }
+        d->fx[i] = d->ux[i] + Px;
+        d->fy[i] = d->uy[i] + Py;
+    }
+}
+
+// Range finder: distance to the nearest obstacle (INFINITY if none)
+void ecs_sys_sense(EcsWorld *w, void *ctx) {
+    (void)ctx;
+    EcsArchetype       *d = &w->arch[ECS_DRONE];
+    const EcsArchetype *o = &w->arch[ECS_OBSTACLE];
+    for (int i = 0; i < d->n; ++i) {
+        double best = INFINITY;
+        for (int k = 0; k < o->n; ++k) {
+            double dx = d->x[i] - o->x[k];
+            double dy = d->y[i] - o->y[k];
+            double d2 = dx*dx + dy*dy;
+            if (d2 < best) best = d2;
+        }
+        d->sense[i] = sqrt(best);
+    }
+}
+
+// One step off every lifetime; expired entities are removed after the stage
+// (life 0 never expires)
+void ecs_sys_age(EcsWorld *w, void *ctx) {
+    (void)ctx;
+    const EcsArch kinds[2] = { ECS_OBSTACLE, ECS_TARGET };
+    for (int t = 0; t < 2; ++t) {
+        EcsArchetype *a = &w->arch[kinds[t]];
+        for (int r = 0; r < a->n; ++r) {
+            if (a->life[r] > 0 && --a->life[r] == 0) ecs_destroy_later(w, a->id[r]);
+        }
+    }
+}
+
+// Wall repulsion + damped Euler step, as D
+void ecs_sys_integrate(EcsWorld *w, void *ctx) {
+    const EcsSimCtx *c = (const EcsSimCtx *)ctx;
+    const SimParams *p = c->params;
+    EcsArchetype    *d = &w->arch[ECS_DRONE];
+    for (int i = 0; i < d->n; ++i) {
+        DroneStateMsg s = { d->x[i], d->y[i], d->vx[i], d->vy[i] };
+        double Pwx, Pwy;
+        compute_wall_P(&s, p, &Pwx, &Pwy);
+        double ax = (d->fx[i] + Pwx - p->visc * s.vx) / p->mass;
+        double ay = (d->fy[i] + Pwy - p->visc * s.vy) / p->mass;
+        d->vx[i] += ax * p->dt;
+        d->vy[i] += ay * p->dt;
+        d->x[i]  += d->vx[i] * p->dt;
+        d->y[i]  += d->vy[i] * p->dt;
+    }
+}
+
+// Targets within the hit radius of a drone are collected (only the candidate
+// rows, if given); collected ones are marked with life -1 until the stage ends
+void ecs_sys_hit(EcsWorld *w, void *ctx) {
+    EcsSimCtx          *c = (EcsSimCtx *)ctx;
+    const EcsArchetype *d = &w->arch[ECS_DRONE];
+    EcsArchetype       *t = &w->arch[ECS_TARGET];
+    const int           n = c->tgt_rows ? c->n_tgt_rows : t->n;
+    for (int i = 0; i < d->n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            int r = c->tgt_rows ? c->tgt_rows[j] : j;
+            if (t->life[r] < 0) continue;   // collected this tick
+            if (target_reached(d->x[i] - t->x[r], d->y[i] - t->y[r], c->params)) {
+                t->life[r] = -1;
+                ecs_destroy_later(w, t->id[r]);
+                c->hits++;
+            }
+        }
+    }
+}
+
+// Cell grid of the world: obstacles 'o', targets 't', drones '+' (drawn in that
+// order, cells as in B's view)
+void ecs_sys_render(EcsWorld *w, void *ctx) {
+    EcsSimCtx *c = (EcsSimCtx *)ctx;
+    double h = c->params->world_half;
+    memset(c->frame, ' ', (size_t)c->rows * (size_t)c->cols);
+
+    const RenderRect area = { 0, 0, c->rows, c->cols };
+    const double     sx   = c->cols / (2.0 * h), sy = c->rows / (2.0 * h);
+    const EcsArch kinds[3] = { ECS_OBSTACLE, ECS_TARGET, ECS_DRONE };
+    const char    glyph[3] = { 'o', 't', '+' };
+    for (int k = 0; k < 3; ++k) {
+        const EcsArchetype *a = &w->arch[kinds[k]];
+        for (int r = 0; r < a->n; ++r) {
+            int row, col;
+            render_cell(&area, sx, sy, a->x[r], a->y[r], &row, &col);
+            c->frame[row * c->cols + col] = glyph[k];
+        }
+    }
+}
@@ -0,0 +1,324 @@
+// ecsbench.c
+// arp1_ecsbench: per-tick world work on slot arrays vs the ECS (ecs.h)
+//   - one synthetic world (drones with a constant commanded force,
+//     obstacles, targets that expire and come back in waves) stepped N ticks
+//     by both models: repulse, sense, age, integrate, hit-test, render
+//   - slot arrays: one struct per entity with an active flag (B's layout
+//     before the ECS), one loop after the other; ECS: the systems B runs,
+//     over archetype columns, run by the scheduler with 1..W workers; both
+//     use the same per-pair rules (util.h, render.h)
+//   - every run must end bit-identical to the slot-array run (drone states,
+//     hits, range readings, last frame) or the bench fails
+//   - output: tab-separated table (model, workers, us/tick, speedup) and the
+//     ECS stage plan
+// ======================================================================
+
+#define _GNU_SOURCE
+#include "headers/ecs.h"
+#include "headers/util.h"
+#include "headers/render.h"   // render_cell()
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FRAME_ROWS    40
+#define FRAME_COLS    120
+#define WAVE_TICKS    100    // targets: new wave every n ticks
+#define TARGET_LIFE   80     // so some expire before the next wave
+#define DRONE_FORCE   3.0    // commanded force magnitude (N)
+
+typedef struct {
+    int drones, obstacles, targets, ticks;
+} BenchSize;
+
+// One slot of the slot-array model
+typedef struct {
+    double x, y;
+    int    active;
+    int    life_steps;
+} Slot;
+
+// Final state of a run (compared bit for bit)
+typedef struct {
+    double *x, *y, *vx, *vy, *sense;
+    long    hits;
+    char    frame[FRAME_ROWS * FRAME_COLS];
+    double  us_per_tick;
+} BenchResult;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static double frand(unsigned *rng, double lo, double hi) {
+    return lo + (hi - lo) * ((double)rand_r(rng) / (double)RAND_MAX);
+}
+
+// Drone i: start position and commanded force (same for both models)
+static void drone_seed(int i, double h, double *x, double *y, double *ux, double *uy) {
+    unsigned rng = 1000u + (unsigned)i;
+    *x = frand(&rng, -0.8 * h, 0.8 * h);
+    *y = frand(&rng, -0.8 * h, 0.8 * h);
+    double a = frand(&rng, 0.0, 2.0 * M_PI);
+    *ux = DRONE_FORCE * cos(a);
+    *uy = DRONE_FORCE * sin(a);
+}
+
+static void result_alloc(BenchResult *r, int n) {
+    memset(r, 0, sizeof(*r));
+    r->x = calloc((size_t)n, sizeof(double));
+    r->y = calloc((size_t)n, sizeof(double));
+    r->vx = calloc((size_t)n, sizeof(double));
+    r->vy = calloc((size_t)n, sizeof(double));
+    r->sense = calloc((size_t)n, sizeof(double));
+}
+
+static void result_free(BenchResult *r) {
+    free(r->x); free(r->y); free(r->vx); free(r->vy); free(r->sense);
+}
+
+static void frame_put(char *frame, double h, double x, double y, char g) {
+    const RenderRect area = { 0, 0, FRAME_ROWS, FRAME_COLS };
+    int row, col;
+    render_cell(&area, FRAME_COLS / (2.0 * h), FRAME_ROWS / (2.0 * h), x, y, &row, &col);
+    frame[row * FRAME_COLS + col] = g;
+}
+
+// Slot arrays (today's model)
+// ----------------------------------------------------------------------
+static void run_slots(const BenchSize *z, const SimParams *p, BenchResult *out) {
+    double h = p->world_half;
+    DroneStateMsg *s  = calloc((size_t)z->drones, sizeof(DroneStateMsg));
+    double        *ux = calloc((size_t)z->drones, sizeof(double));
+    double        *uy = calloc((size_t)z->drones, sizeof(double));
+    double        *fx = calloc((size_t)z->drones, sizeof(double));
+    double        *fy = calloc((size_t)z->drones, sizeof(double));
+    Slot          *obs = calloc((size_t)z->obstacles, sizeof(Slot));
+    Slot          *tgt = calloc((size_t)z->targets, sizeof(Slot));
+    const double   clearance = h * OBS_CLEARANCE_FRAC;
+
+    for (int i = 0; i < z->drones; ++i) drone_seed(i, h, &s[i].x, &s[i].y, &ux[i], &uy[i]);
+    unsigned rng = 7u;
+    for (int k = 0; k < z->obstacles; ++k) {
+        obs[k].x = frand(&rng, -0.9 * h, 0.9 * h);
+        obs[k].y = frand(&rng, -0.9 * h, 0.9 * h);
+        obs[k].life_steps = z->ticks + 1;   // outlive the run: field sums keep slot order
+        obs[k].active = 1;
+    }
+    unsigned trng = 99u;
+
+    double t0 = now_sec();
+    for (int tick = 0; tick < z->ticks; ++tick) {
+        if (tick % WAVE_TICKS == 0) {
+            for (int k = 0; k < z->targets; ++k) {
+                tgt[k].x = frand(&trng, -0.9 * h, 0.9 * h);
+                tgt[k].y = frand(&trng, -0.9 * h, 0.9 * h);
+                tgt[k].life_steps = TARGET_LIFE;
+                tgt[k].active = 1;
+            }
+        }
+        // repulse
+        for (int i = 0; i < z->drones; ++i) {
+            double Px = 0.0, Py = 0.0;
+            for (int k = 0; k < z->obstacles && clearance > 0.0; ++k)
+                if (obs[k].active) obstacle_push(s[i].x - obs[k].x, s[i].y - obs[k].y, clearance, &Px, &Py);
+            fx[i] = ux[i] + Px;
+            fy[i] = uy[i] + Py;
+        }
+        // sense
+        for (int i = 0; i < z->drones; ++i) {
+            double best = INFINITY;
+            for (int k = 0; k < z->obstacles; ++k) {
+                if (!obs[k].active) continue;
+                double dx = s[i].x - obs[k].x;
+                double dy = s[i].y - obs[k].y;
+                double d2 = dx*dx + dy*dy;
+                if (d2 < best) best = d2;
+            }
+            out->sense[i] = sqrt(best);
+        }
+        // age
+        for (int k = 0; k < z->obstacles; ++k)
+            if (obs[k].active && obs[k].life_steps > 0 && --obs[k].life_steps == 0) obs[k].active = 0;
+        for (int k = 0; k < z->targets; ++k)
+            if (tgt[k].active && tgt[k].life_steps > 0 && --tgt[k].life_steps == 0) tgt[k].active = 0;
+        // integrate
+        for (int i = 0; i < z->drones; ++i) {
+            double Pwx, Pwy;
+            compute_wall_P(&s[i], p, &Pwx, &Pwy);
+            double ax = (fx[i] + Pwx - p->visc * s[i].vx) / p->mass;
+            double ay = (fy[i] + Pwy - p->visc * s[i].vy) / p->mass;
+            s[i].vx += ax * p->dt;
+            s[i].vy += ay * p->dt;
+            s[i].x  += s[i].vx * p->dt;
+            s[i].y  += s[i].vy * p->dt;
+        }
+        // hit
+        for (int i = 0; i < z->drones; ++i) {
+            for (int k = 0; k < z->targets; ++k) {
+                if (tgt[k].active && target_reached(s[i].x - tgt[k].x, s[i].y - tgt[k].y, p)) {
+                    tgt[k].active = 0;
+                    out->hits++;
+                }
+            }
+        }
+        // render
+        memset(out->frame, ' ', sizeof(out->frame));
+        for (int k = 0; k < z->obstacles; ++k) if (obs[k].active) frame_put(out->frame, h, obs[k].x, obs[k].y, 'o');
+        for (int k = 0; k < z->targets; ++k)   if (tgt[k].active) frame_put(out->frame, h, tgt[k].x, tgt[k].y, 't');
+        for (int i = 0; i < z->drones; ++i) frame_put(out->frame, h, s[i].x, s[i].y, '+');
+    }
+    out->us_per_tick = 1e6 * (now_sec() - t0) / (double)z->ticks;
+
+    for (int i = 0; i < z->drones; ++i) {
+        out->x[i] = s[i].x; out->y[i] = s[i].y; out->vx[i] = s[i].vx; out->vy[i] = s[i].vy;
+    }
+    free(s); free(ux); free(uy); free(fx); free(fy); free(obs); free(tgt);
+}
+
+// ECS
+// ----------------------------------------------------------------------
+static int run_ecs(const BenchSize *z, const SimParams *p, int workers, BenchResult *out, int show_plan) {
+    double h = p->world_half;
+    EcsWorld w;
+    int cap[ECS_ARCH_COUNT] = { z->drones, z->obstacles, z->targets };
+    if (ecs_init(&w, cap) != 0) return -1;
+
+    EcsId *drone = calloc((size_t)z->drones, sizeof(EcsId));
+    for (int i = 0; i < z->drones; ++i) {
+        drone[i] = ecs_spawn(&w, ECS_DRONE);
+        int r = ecs_row(&w, drone[i], NULL);
+        EcsArchetype *d = &w.arch[ECS_DRONE];
+        drone_seed(i, h, &d->x[r], &d->y[r], &d->ux[r], &d->uy[r]);
+    }
+    unsigned rng = 7u;
+    for (int k = 0; k < z->obstacles; ++k) {
+        EcsArchetype *o = &w.arch[ECS_OBSTACLE];
+        int r = ecs_row(&w, ecs_spawn(&w, ECS_OBSTACLE), NULL);
+        o->x[r] = frand(&rng, -0.9 * h, 0.9 * h);
+        o->y[r] = frand(&rng, -0.9 * h, 0.9 * h);
+        o->life[r] = z->ticks + 1;
+    }
+    unsigned trng = 99u;
+
+    EcsSimCtx ctx = { .params = p, .hits = 0, .frame = out->frame, .rows = FRAME_ROWS, .cols = FRAME_COLS };
+    const EcsSystem systems[] = {
+        { "repulse",   ECS_POS,            ECS_FORCE,                 ecs_sys_repulse,   &ctx },
+        { "sense",     ECS_POS,            ECS_SENSE,                 ecs_sys_sense,     &ctx },
+        { "age",       0,                  ECS_LIFE,                  ecs_sys_age,       &ctx },
+        { "integrate", ECS_FORCE,          ECS_POS | ECS_VEL,         ecs_sys_integrate, &ctx },
+        { "hit",       ECS_POS,            ECS_LIFE | ECS_RES_SCORE,  ecs_sys_hit,       &ctx },
+        { "render",    ECS_POS | ECS_LIFE, ECS_RES_FRAME,             ecs_sys_render,    &ctx },
+    };
+    EcsSched sched;
+    if (ecs_sched_init(&sched, systems, (int)(sizeof(systems) / sizeof(systems[0])), workers) != 0) {
+        fprintf(stderr, "[ECSBENCH] scheduler with %d worker(s) failed\n", workers);
+        exit(EXIT_FAILURE);   // workers may be parked on the barrier
+    }
+
+    double t0 = now_sec();
+    for (int tick = 0; tick < z->ticks; ++tick) {
+        if (tick % WAVE_TICKS == 0) {
+            // New wave: leftovers go, the same positions as the slot arrays come
+            EcsArchetype *t = &w.arch[ECS_TARGET];
+            while (t->n > 0) ecs_destroy(&w, t->id[t->n - 1]);
+            for (int k = 0; k < z->targets; ++k) {
+                int r = ecs_row(&w, ecs_spawn(&w, ECS_TARGET), NULL);
+                t->x[r] = frand(&trng, -0.9 * h, 0.9 * h);
+                t->y[r] = frand(&trng, -0.9 * h, 0.9 * h);
+                t->life[r] = TARGET_LIFE;
+            }
+        }
+        ecs_sched_run(&sched, &w);
+    }
+    out->us_per_tick = 1e6 * (now_sec() - t0) / (double)z->ticks;
+    out->hits = ctx.hits;
+
+    for (int i = 0; i < z->drones; ++i) {
+        EcsArchetype *d = &w.arch[ECS_DRONE];
+        int r = ecs_row(&w, drone[i], NULL);   // stable id -> current row
+        out->x[i] = d->x[r]; out->y[i] = d->y[r]; out->vx[i] = d->vx[r]; out->vy[i] = d->vy[r];
+        out->sense[i] = d->sense[r];
+    }
+    if (show_plan) {
+        fprintf(stderr, "ECS stage plan (%d worker(s), mean time per tick):\n", workers);
+        ecs_sched_report(&sched, stderr);
+    }
+    ecs_sched_free(&sched);
+    free(drone);
+    ecs_free(&w);
+    return 0;
+}
+
+static int same(const BenchResult *a, const BenchResult *b, int n) {
+    if (a->hits != b->hits || memcmp(a->frame, b->frame, sizeof(a->frame)) != 0) return 0;
+    size_t bytes = (size_t)n * sizeof(double);
+    return memcmp(a->x, b->x, bytes) == 0 && memcmp(a->y, b->y, bytes) == 0 &&
+           memcmp(a->vx, b->vx, bytes) == 0 && memcmp(a->vy, b->vy, bytes) == 0 &&
+           memcmp(a->sense, b->sense, bytes) == 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-d drones] [-o obstacles] [-t targets] [-n ticks] [-w max_workers]\n"
+            "  defaults: 64 drones, 2048 obstacles, 2048 targets, 300 ticks, 4 workers\n"
+            "  ECS runs use 1, 2, ... max_workers workers and must match the slot-array run.\n",
+            prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv) {
+    BenchSize z = { 64, 2048, 2048, 300 };
+    int max_workers = 4;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:o:t:n:w:h")) != -1) {
+        switch (opt) {
+            case 'd': z.drones    = atoi(optarg); break;
+            case 'o': z.obstacles = atoi(optarg); break;
+            case 't': z.targets   = atoi(optarg); break;
+            case 'n': z.ticks     = atoi(optarg); break;
+            case 'w': max_workers = atoi(optarg); break;
+            default:  usage(argv[0]);
+        }
+    }
+    if (z.drones < 1 || z.obstacles < 0 || z.targets < 0 || z.ticks < 1 ||
+        max_workers < 1 || max_workers > ECS_MAX_WORKERS) usage(argv[0]);
+
+    // Same world scale and physics as the game
+    SimParams params;
+    init_default_params(&params);
+    load_params_from_file("params.txt", &params);
+
+    BenchResult ref;
+    result_alloc(&ref, z.drones);
+    run_slots(&z, &params, &ref);
+
+    printf("model\tworkers\tus_per_tick\tspeedup\thits\tmatch\n");
+    printf("slots\t1\t%.1f\t1.00\t%ld\t-\n", ref.us_per_tick, ref.hits);
+
+    int ok = 1;
+    for (int wk = 1; wk <= max_workers; wk *= 2) {
+        BenchResult r;
+        result_alloc(&r, z.drones);
+        if (run_ecs(&z, &params, wk, &r, wk * 2 > max_workers) != 0) {   // plan of the widest run
+            fprintf(stderr, "[ECSBENCH] cannot allocate the ECS world\n");
+            return EXIT_FAILURE;
+        }
+        int match = same(&ref, &r, z.drones);
+        ok &= match;
+        printf("ecs\t%d\t%.1f\t%.2f\t%ld\t%s\n", wk, r.us_per_tick,
+               ref.us_per_tick / r.us_per_tick, r.hits, match ? "yes" : "NO");
+        result_free(&r);
+    }
+    result_free(&ref);
+
+    fprintf(stderr, "ECSBENCH %s\n", ok ? "PASS" : "FAIL (ECS result differs from the slot arrays)");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
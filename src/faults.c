@@ -0,0 +1,135 @@
+// faults.c
+// Fault and latency injection table and hooks (see faults.h)
+// ======================================================================
+
+#include "headers/faults.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+
+static const char *k_names[FLT_COUNT] = FAULT_NAMES;
+
+static FaultTable *g_ft = NULL;   // shared with every component once set up
+
+const char *fault_name(int id) {
+    return (id >= 0 && id < FLT_COUNT) ? k_names[id] : "?";
+}
+
+int fault_from_name(const char *name) {
+    for (int i = 0; i < FLT_COUNT; ++i)
+        if (strcmp(name, k_names[i]) == 0) return i;
+    return -1;
+}
+
+int fault_compiled_in(void) {
+#ifdef ARP_FAULTS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+int fault_set(int id, double value, const char *why, FILE *log) {
+    if (!g_ft || id < 0 || id >= FLT_COUNT) return -1;
+    if (value < 0.0) value = 0.0;
+    g_ft->value[id] = value;
+    if (log) fprintf(log, "[B] FAULT %s = %g (%s)\n", k_names[id], value, why);
+    return 0;
+}
+
+void fault_setup(void) {
+    if (!fault_compiled_in()) return;
+
+    g_ft = mmap(NULL, sizeof(FaultTable), PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (g_ft == MAP_FAILED) {
+        perror("[FAULTS] mmap");
+        g_ft = NULL;
+        return;
+    }
+    memset(g_ft, 0, sizeof(*g_ft));
+
+    FILE *fp = fopen(FAULTS_FILE, "r");
+    if (!fp) return;   // optional
+    char line[256];
+    int  n = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        char   key[64];
+        double d;
+        if (line[0] == '#' || sscanf(line, " %63[a-z_] = %lf", key, &d) != 2) continue;
+        int id = fault_from_name(key);
+        if (id < 0) {
+            fprintf(stderr, "[FAULTS] %s: unknown fault '%s'\n", FAULTS_FILE, key);
+            continue;
+        }
+        g_ft->value[id] = d < 0.0 ? 0.0 : d;
+        if (d > 0.0) n++;
+    }
+    fclose(fp);
+    fprintf(stderr, "[FAULTS] %d fault(s) set from %s\n", n, FAULTS_FILE);
+}
+
+void fault_report(double now, FILE *log) {
+    static double        window_start = 0.0;
+    static unsigned long reported[FLT_COUNT];
+    if (!g_ft || now - window_start < 1.0) return;
+    window_start = now;
+
+    char buf[512];
+    int  len = 0;
+    for (int i = 0; i < FLT_COUNT; ++i) {
+        unsigned long hits = __atomic_load_n(&g_ft->hits[i], __ATOMIC_RELAXED);
+        if (g_ft->value[i] == 0.0 && hits == reported[i]) continue;
+        len += snprintf(buf + len, sizeof(buf) - (size_t)len, " %s=%g(%lu hit(s))",
+                        k_names[i], g_ft->value[i], hits - reported[i]);
+        reported[i] = hits;
+        if (len >= (int)sizeof(buf)) break;
+    }
+    if (len > 0 && log) fprintf(log, "[B] FAULTS:%s\n", buf);
+}
+
+#ifdef ARP_FAULTS
+// Hooks (called from every component)
+// ----------------------------------------------------------------------
+void fault_hit(FaultId id) {
+    if (g_ft) __atomic_add_fetch(&g_ft->hits[id], 1, __ATOMIC_RELAXED);
+}
+
+double fault_value(FaultId id) {
+    return g_ft ? g_ft->value[id] : 0.0;
+}
+
+void fault_sleep_ms(FaultId id) {
+    double ms = fault_value(id);
+    if (ms <= 0.0) return;
+    fault_hit(id);
+    struct timespec ts = { (time_t)(ms / 1000.0), (long)(((long long)(ms * 1e6)) % 1000000000LL) };
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {}
+}
+
+int fault_chance(FaultId id) {
+    static unsigned long long rng = 0x2545F4914F6CDD1Dull;   // fixed: same sequence every run
+    double p = fault_value(id);
+    if (p <= 0.0) return 0;
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    if ((double)(rng >> 11) * (1.0 / 9007199254740992.0) >= p) return 0;
+    fault_hit(id);
+    return 1;
+}
+
+double fault_stall(FaultId id) {
+    if (!g_ft) return 0.0;
+    double sec = g_ft->value[id];
+    if (sec <= 0.0) return 0.0;
+    g_ft->value[id] = 0.0;   // one-shot: cleared before sleeping
+    fault_hit(id);
+    struct timespec ts = { (time_t)sec, (long)((sec - (double)(time_t)sec) * 1e9) };
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {}
+    return sec;
+}
+#endif
@@ -0,0 +1,431 @@
+// iobatch.c
+// Optional io_uring output path for the server (B)
+//   - Raw io_uring syscalls (no liburing dependency)
+//   - Force writes to D and log appends are queued during a tick and
+//     submitted with a single io_uring_enter() at the end of the tick
+//   - Registered (fixed) buffers for the force slots and the log buffer
+//   - Runtime detection: any setup failure falls back to write()/fflush();
+//     so does a failing io_uring_enter() later on (see fall_back)
+// ======================================================================
+
+#define _GNU_SOURCE
+#include "headers/iobatch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+// Thin syscall wrappers (glibc does not provide them)
+// ----------------------------------------------------------------------
+static int sys_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+// Reads syscr/syscw from /proc/self/io. Returns 0 on success.
+// Plain read() into a stack buffer: runs on the hot path, so no stdio (malloc).
+// ----------------------------------------------------------------------
+static int read_proc_io(long *syscr, long *syscw) {
+    int fd = open("/proc/self/io", O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return -1;
+
+    char buf[512];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+
+    const char *r = strstr(buf, "syscr: ");
+    const char *w = strstr(buf, "syscw: ");
+    *syscr = r ? strtol(r + 7, NULL, 10) : 0;
+    *syscw = w ? strtol(w + 7, NULL, 10) : 0;
+    return 0;
+}
+
+static void stats_window_start(IoBatch *iob) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+
+    memset(&iob->st, 0, sizeof(iob->st));
+    if (read_proc_io(&iob->st.syscr0, &iob->st.syscw0) != 0) {
+        iob->st.syscr0 = -1;
+    }
+    iob->st.nvcsw0  = ru.ru_nvcsw;
+    iob->st.nivcsw0 = ru.ru_nivcsw;
+}
+
+// Unmaps and closes the ring (buffers stay registered with it until the close).
+static void drop_ring(IoBatch *iob) {
+    munmap(iob->sqes, iob->sqes_sz);
+    munmap(iob->sq_ring, iob->sq_ring_sz);
+    close(iob->ring_fd);
+    iob->ring_fd = -1;
+    iob->enabled = 0;
+}
+
+// io_uring_enter() failed for good: the SQEs the kernel never took are written
+// with plain write() (in order), then the ring goes and B stays on the fallback
+// path. SQEs already taken are left to the ring teardown; force_buf and log_buf
+// are never written again, so they cannot be overwritten under them.
+// ----------------------------------------------------------------------
+static void fall_back(IoBatch *iob, int err) {
+    unsigned head = __atomic_load_n(iob->sq_head, __ATOMIC_ACQUIRE);
+    unsigned tail = *iob->sq_tail;
+    for (unsigned pos = head; pos != tail; ++pos) {
+        const unsigned i = pos & (IOB_RING_ENTRIES - 1);
+        if (write(iob->pending[i].fd, iob->pending[i].buf, iob->pending[i].len) == -1) {
+            iob->last_err = -errno;
+        }
+        iob->st.direct_writes++;
+    }
+    drop_ring(iob);
+
+    char msg[128];
+    int  n = snprintf(msg, sizeof(msg), "[B] io_uring_enter failed (%s), using select/write path\n",
+                      strerror(err));
+    if (write(iob->log_fd, msg, (size_t)n) == -1) iob->last_err = -errno;
+}
+
+// Submits every queued SQE and waits until all of them completed.
+// Buffers can be reused once this returns (or the ring is gone: fall_back).
+// ----------------------------------------------------------------------
+static void submit_and_wait(IoBatch *iob) {
+    unsigned inflight = iob->queued;
+
+    while (inflight > 0) {
+        // Not yet handed to the kernel: between its head and our tail
+        unsigned to_submit = *iob->sq_tail - __atomic_load_n(iob->sq_head, __ATOMIC_ACQUIRE);
+        int ret = sys_uring_enter(iob->ring_fd, to_submit, inflight, IORING_ENTER_GETEVENTS);
+        iob->st.enters++;
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            iob->last_err = -errno;
+            fall_back(iob, errno);
+            break;
+        }
+
+        // Reaps completions
+        unsigned head = *iob->cq_head;
+        unsigned tail = __atomic_load_n(iob->cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            struct io_uring_cqe *cqe = &iob->cqes[head & *iob->cq_mask];
+            if (cqe->res < 0) iob->last_err = cqe->res;
+            head++;
+            if (inflight > 0) inflight--;
+        }
+        __atomic_store_n(iob->cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    iob->queued     = 0;
+    iob->force_used = 0;
+    iob->log_len    = 0;
+}
+
+// Grabs the next free SQE (submitting first if the ring is full).
+// NULL if that submit made B fall back (the caller writes directly).
+// ----------------------------------------------------------------------
+static struct io_uring_sqe *next_sqe(IoBatch *iob) {
+    if (iob->queued >= iob->sq_entries) {
+        submit_and_wait(iob);
+        if (!iob->enabled) return NULL;
+    }
+
+    unsigned tail = *iob->sq_tail;
+    unsigned idx  = tail & *iob->sq_mask;
+    struct io_uring_sqe *sqe = &iob->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    iob->sq_array[idx] = idx;
+    __atomic_store_n(iob->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    iob->queued++;
+    return sqe;
+}
+
+// Queues a write; performs it directly if the ring failed meanwhile.
+static void prep_write(IoBatch *iob, int fd, const void *buf, size_t len, int buf_index) {
+    struct io_uring_sqe *sqe = next_sqe(iob);
+    if (!sqe) {
+        iob->st.direct_writes++;
+        if (write(fd, buf, len) == -1) iob->last_err = -errno;
+        return;
+    }
+    unsigned i = (*iob->sq_tail - 1) & (IOB_RING_ENTRIES - 1);   // the SQE just taken
+    iob->pending[i].fd  = fd;
+    iob->pending[i].buf = buf;
+    iob->pending[i].len = len;
+
+    sqe->opcode = iob->fixed_bufs ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe->fd     = fd;
+    sqe->addr   = (unsigned long)buf;
+    sqe->len    = (unsigned)len;
+    sqe->off    = (unsigned long long)-1;   // current file position (pipes and log file)
+    if (iob->fixed_bufs) sqe->buf_index = (unsigned short)buf_index;
+}
+
+// Queues the pending log bytes as one append.
+static void queue_log(IoBatch *iob) {
+    if (iob->log_len == 0) return;
+    prep_write(iob, iob->log_fd, iob->log_buf, iob->log_len, 1);
+}
+
+// fopencookie() write callback: copies log text into the registered buffer
+// (straight to the log file once the ring has failed).
+// ----------------------------------------------------------------------
+static ssize_t log_cookie_write(void *c, const char *buf, size_t size) {
+    IoBatch *iob = (IoBatch *)c;
+    size_t left = size;
+
+    while (left > 0) {
+        if (!iob->enabled) {
+            ssize_t n = write(iob->log_fd, buf, left);
+            if (n <= 0) return (ssize_t)(size - left);
+            buf  += n;
+            left -= (size_t)n;
+            continue;
+        }
+        size_t space = sizeof(iob->log_buf) - iob->log_len;
+        if (space == 0) {
+            // Buffer full mid-tick: flush early (rare, bursty logging only)
+            queue_log(iob);
+            submit_and_wait(iob);
+            continue;   // the ring may have failed meanwhile
+        }
+        size_t n = left < space ? left : space;
+        memcpy(iob->log_buf + iob->log_len, buf, n);
+        iob->log_len += n;
+        buf  += n;
+        left -= n;
+    }
+    return (ssize_t)size;
+}
+
+static int log_cookie_close(void *c) {
+    (void)c;
+    return 0;
+}
+
+// Public API
+// ----------------------------------------------------------------------
+void iob_init(IoBatch *iob, int want_uring, FILE *real_log) {
+    memset(iob, 0, sizeof(*iob));
+    iob->ring_fd  = -1;
+    iob->real_log = real_log;
+    iob->log      = real_log;
+    stats_window_start(iob);
+
+    if (!want_uring || !real_log) return;
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = sys_uring_setup(IOB_RING_ENTRIES, &p);
+    if (fd < 0) {
+        fprintf(real_log, "[B] io_uring unavailable (%s), using select/write path\n",
+                strerror(errno));
+        fflush(real_log);
+        return;
+    }
+    if (!(p.features & IORING_FEAT_RW_CUR_POS) || !(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        fprintf(real_log, "[B] io_uring too old (features=0x%x), using select/write path\n",
+                p.features);
+        fflush(real_log);
+        close(fd);
+        return;
+    }
+
+    // One mmap covers both SQ and CQ rings (IORING_FEAT_SINGLE_MMAP)
+    size_t sq_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    size_t cq_sz = p.cq_off.cqes  + p.cq_entries * sizeof(struct io_uring_cqe);
+    size_t ring_sz = sq_sz > cq_sz ? sq_sz : cq_sz;
+
+    void *ring = mmap(NULL, ring_sz, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (ring == MAP_FAILED) {
+        fprintf(real_log, "[B] io_uring ring mmap failed (%s), using select/write path\n",
+                strerror(errno));
+        fflush(real_log);
+        close(fd);
+        return;
+    }
+
+    size_t sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(NULL, sqes_sz, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        fprintf(real_log, "[B] io_uring sqe mmap failed (%s), using select/write path\n",
+                strerror(errno));
+        fflush(real_log);
+        munmap(ring, ring_sz);
+        close(fd);
+        return;
+    }
+
+    unsigned char *r = (unsigned char *)ring;
+    iob->ring_fd    = fd;
+    iob->sq_ring    = ring;
+    iob->sq_ring_sz = ring_sz;
+    iob->sq_head    = (unsigned *)(r + p.sq_off.head);
+    iob->sq_tail    = (unsigned *)(r + p.sq_off.tail);
+    iob->sq_mask    = (unsigned *)(r + p.sq_off.ring_mask);
+    iob->sq_array   = (unsigned *)(r + p.sq_off.array);
+    iob->sqes       = (struct io_uring_sqe *)sqes;
+    iob->sqes_sz    = sqes_sz;
+    iob->cq_ring    = ring;
+    iob->cq_ring_sz = 0;   // shared with sq_ring
+    iob->cq_head    = (unsigned *)(r + p.cq_off.head);
+    iob->cq_tail    = (unsigned *)(r + p.cq_off.tail);
+    iob->cq_mask    = (unsigned *)(r + p.cq_off.ring_mask);
+    iob->cqes       = (struct io_uring_cqe *)(r + p.cq_off.cqes);
+    iob->sq_entries = p.sq_entries < IOB_RING_ENTRIES ? p.sq_entries : IOB_RING_ENTRIES;
+
+    // Registers the force slots and the log buffer (pinned once, no per-op page walks)
+    struct iovec iov[2];
+    iov[0].iov_base = iob->force_buf;
+    iov[0].iov_len  = sizeof(iob->force_buf);
+    iov[1].iov_base = iob->log_buf;
+    iov[1].iov_len  = sizeof(iob->log_buf);
+    iob->fixed_bufs = (sys_uring_register(fd, IORING_REGISTER_BUFFERS, iov, 2) == 0);
+
+    // Redirects server logging into the registered buffer
+    fflush(real_log);
+    cookie_io_functions_t fns;
+    memset(&fns, 0, sizeof(fns));
+    fns.write = log_cookie_write;
+    fns.close = log_cookie_close;
+    FILE *cookie = fopencookie(iob, "w", fns);
+    if (!cookie) {
+        fprintf(real_log, "[B] fopencookie failed, using select/write path\n");
+        fflush(real_log);
+        munmap(sqes, sqes_sz);
+        munmap(ring, ring_sz);
+        close(fd);
+        iob->ring_fd = -1;
+        return;
+    }
+    setvbuf(cookie, NULL, _IOFBF, 4096);
+
+    iob->log_fd  = fileno(real_log);
+    iob->log     = cookie;
+    iob->enabled = 1;
+
+    fprintf(real_log, "[B] io_uring backend enabled (sq=%u cq=%u fixed_bufs=%s)\n",
+            p.sq_entries, p.cq_entries, iob->fixed_bufs ? "yes" : "no");
+    fflush(real_log);
+}
+
+int iob_write(IoBatch *iob, int fd, const void *buf, size_t len) {
+    if (!iob || !iob->enabled) {
+        if (iob) iob->st.direct_writes++;
+        return (write(fd, buf, len) == -1) ? -1 : 0;
+    }
+
+    if (len > IOB_FORCE_SLOT_SZ) {
+        // Not a force-sized message: keep ordering and write it directly
+        fflush(iob->log);
+        queue_log(iob);
+        submit_and_wait(iob);
+        iob->st.direct_writes++;
+        return (write(fd, buf, len) == -1) ? -1 : 0;
+    }
+
+    if (iob->force_used >= IOB_FORCE_SLOTS) {
+        fflush(iob->log);
+        queue_log(iob);
+        submit_and_wait(iob);
+    }
+    if (!iob->enabled) {
+        iob->st.direct_writes++;   // the ring failed in that submit
+        return (write(fd, buf, len) == -1) ? -1 : 0;
+    }
+
+    unsigned char *slot = iob->force_buf + (size_t)iob->force_used * IOB_FORCE_SLOT_SZ;
+    memcpy(slot, buf, len);
+    iob->force_used++;
+    prep_write(iob, fd, slot, len, 0);
+    return 0;
+}
+
+void iob_end_tick(IoBatch *iob) {
+    iob->st.ticks++;
+    if (!iob->enabled) return;
+
+    fflush(iob->log);   // pushes stdio's buffer into log_buf (no syscall)
+    if (!iob->enabled) return;   // the ring failed during that flush
+    queue_log(iob);
+    submit_and_wait(iob);
+}
+
+void iob_count_select(IoBatch *iob) {
+    iob->st.selects++;
+}
+
+int iob_report(IoBatch *iob, long window) {
+    if (iob->st.ticks < window) return 0;
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+
+    long syscr = 0, syscw = 0;
+    long rw = 0;
+    if (iob->st.syscr0 >= 0 && read_proc_io(&syscr, &syscw) == 0) {
+        rw = (syscr - iob->st.syscr0) + (syscw - iob->st.syscw0);
+    } else {
+        rw = iob->st.direct_writes;   // /proc unavailable: own writes only
+    }
+
+    double t     = (double)iob->st.ticks;
+    long   vcsw  = ru.ru_nvcsw  - iob->st.nvcsw0;
+    long   ivcsw = ru.ru_nivcsw - iob->st.nivcsw0;
+
+    iob->syscalls_per_tick = (double)(rw + iob->st.enters + iob->st.selects) / t;
+    iob->ctxsw_per_tick    = (double)(vcsw + ivcsw) / t;
+
+    fprintf(iob->log,
+            "[B] IOSTAT backend=%s ticks=%ld syscalls/tick=%.2f "
+            "(rw=%.2f enter=%.2f select=%.2f) ctxsw/tick=%.2f (vol=%.2f invol=%.2f)%s\n",
+            iob_backend_name(iob), iob->st.ticks, iob->syscalls_per_tick,
+            (double)rw / t, (double)iob->st.enters / t, (double)iob->st.selects / t,
+            iob->ctxsw_per_tick, (double)vcsw / t, (double)ivcsw / t,
+            iob->last_err ? " (last io_uring error)" : "");
+    if (iob->last_err) {
+        fprintf(iob->log, "[B] io_uring completion error: %s\n", strerror(-iob->last_err));
+        iob->last_err = 0;
+    }
+    fflush(iob->log);
+
+    stats_window_start(iob);
+    return 1;
+}
+
+void iob_shutdown(IoBatch *iob) {
+    if (iob->log == iob->real_log) return;   // never enabled
+
+    fflush(iob->log);
+    if (iob->enabled) {
+        queue_log(iob);
+        submit_and_wait(iob);
+    }
+
+    fclose(iob->log);   // cookie FILE; the real log stays open
+    iob->log = iob->real_log;
+
+    if (iob->enabled) drop_ring(iob);
+}
+
+const char *iob_backend_name(const IoBatch *iob) {
+    return iob->enabled ? "io_uring" : "select";
+}
@@ -5,15 +5,63 @@
 
 #include "headers/messages.h"
 #include "headers/util.h"
+#include "headers/topology.h"  // component_exit()
 
+#include <errno.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+
+// Directional keys are coalesced; the others (pause, reset, quit, brake)
+// keep one event per press so toggles are never merged.
+static int is_directional(char c) {
+    return c != 'd' && strchr("wersfxcv", c) != NULL;
+}
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Appends one key to the batch (coalescing with the previous event if possible).
+// Returns 0 if the batch is full.
+static int batch_add(KeyBatchMsg *b, char c, long long t_ns) {
+    if (b->n > 0) {
+        KeyEvent *last = &b->ev[b->n - 1];
+        if (last->key == c && is_directional(c) && last->count < 255) {
+            last->count++;
+            return 1;
+        }
+    }
+    if (b->n >= KEY_BATCH_MAX) return 0;
+
+    KeyEvent *e = &b->ev[b->n++];
+    e->key   = c;
+    e->count = 1;
+    e->t_ns  = t_ns;
+    return 1;
+}
+
+// Sends the batch to B in one write. Returns 0 if the write failed.
+static int batch_send(int write_fd, const KeyBatchMsg *b, int presses, FILE *log) {
+    fprintf(log, "[I] batch: %d key(s) -> %d event(s)\n", presses, b->n);
+    if (write(write_fd, b, sizeof(*b)) == -1) {
+        fprintf(log, "[I] write to B failed: %s\n", strerror(errno));
+        return 0;
+    }
+    return 1;
+}
 
 // ----------------------------------------------------------------------
 // Defines keyboard process:
-//   - Reads characters from stdin 
-//   - Wraps each into KeyMsg and writes to the pipe to B.
+//   - Puts the TTY in non-canonical mode (if stdin is a TTY)
+//   - Reads every available byte in one read() and timestamps it
+//   - Coalesces repeated directional keys and writes one KeyBatchMsg to B
+//     (more if a batch fills up)
 //   - Exits on EOF or 'q'.
 // ----------------------------------------------------------------------
 void run_keyboard_process(int write_fd) {
@@ -26,42 +74,66 @@ void run_keyboard_process(int write_fd) {
     "[I] 'd' = brake, 'p' = pause, 'O' = reset, 'q' = quit.\n");
     fflush(log);
 
-    // Unbuffers stdout so debug messages appear immediately.
-    setbuf(stdout, NULL);
-
+    // Raw-ish input: no line buffering, no echo, read() returns as soon as one byte is there.
+    // B's endwin() restores the shell's mode afterwards, so restoring here is just hygiene.
+    struct termios saved;
+    int have_tty = isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved) == 0;
+    if (have_tty) {
+        struct termios raw = saved;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN]  = 1;
+        raw.c_cc[VTIME] = 0;
+        if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) == -1) {
+            fprintf(log, "[I] tcsetattr failed, keeping terminal mode\n");
+            have_tty = 0;
+        }
+    }
 
-    while (1) {
-        // reads one character from stdin
-        int c = getchar(); // blocking read 
+    int quit = 0;
+    while (!quit) {
+        // Reads whatever is available (blocks for the first byte only)
+        char buf[64];
+        ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
 
-        if (c == EOF) {
+        if (n <= 0) {
             fprintf(log, "[I] EOF on stdin, exiting keyboard process.\n");
             break;
         }
 
-        KeyMsg km;
-        km.key = (char)c;
-        fprintf(log, "[I] key='%c' (%d)\n", km.key, (int)km.key);
+        long long t = now_ns();
+        KeyBatchMsg batch;
+        batch.n = 0;
+        int presses = 0;
 
-
-        // Sends key to B through pipe.
-        if (write(write_fd, &km, sizeof(km)) == -1) {
-            fprintf(log, "[I] write to B failed");
-
-            break;
-        }
-
-        if (km.key == 'q') {
-            fprintf(log, "[I] 'q' pressed, exiting keyboard process.\n");
-            break;
+        int failed = 0;
+        for (ssize_t i = 0; i < n && !quit; ++i) {
+            if (!batch_add(&batch, buf[i], t)) {
+                // Full: sends it and starts the next one, so no key (not even 'q') is lost
+                if (!batch_send(write_fd, &batch, presses, log)) {
+                    failed = 1;
+                    break;
+                }
+                batch.n = 0;
+                presses = 0;
+                batch_add(&batch, buf[i], t);
+            }
+            presses++;
+            if (buf[i] == 'q') {
+                fprintf(log, "[I] 'q' pressed, exiting keyboard process.\n");
+                quit = 1;
+            }
         }
+        if (failed || !batch_send(write_fd, &batch, presses, log)) break;
     }
+
+    if (have_tty) tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+
     // Final cleanup
     if (log) {
         fprintf(log, "[I] Exiting.\n");
         fclose(log);
     }
-    // Closes pipe to B 
+    // Closes pipe to B
     close(write_fd);
-    exit(EXIT_SUCCESS);  
+    component_exit(EXIT_SUCCESS);   // pthread_exit() when running as a thread in B
 }
@@ -0,0 +1,167 @@
+// logcat.c
+// Categorized, sampled and rate-limited logging (see logcat.h)
+// ======================================================================
+
+#include "headers/logcat.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+LogCatState g_logc[LOGC_COUNT];
+
+static FILE *g_out = NULL;
+
+static const char *k_names[LOGC_COUNT] = LOGC_NAMES;
+
+const char *logc_name(int cat) {
+    return (cat >= 0 && cat < LOGC_COUNT) ? k_names[cat] : "all";
+}
+
+int logc_from_name(const char *name) {
+    if (strcasecmp(name, "all") == 0) return LOGC_COUNT;
+    for (int c = 0; c < LOGC_COUNT; ++c)
+        if (strcasecmp(name, k_names[c]) == 0) return c;
+    return -1;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+void logc_set(int cat, int level, int every, double rate) {
+    int lo = (cat < 0 || cat >= LOGC_COUNT) ? 0 : cat;
+    int hi = (cat < 0 || cat >= LOGC_COUNT) ? LOGC_COUNT - 1 : cat;
+    for (int c = lo; c <= hi; ++c) {
+        LogCatState *s = &g_logc[c];
+        s->level = level < LOGL_OFF ? LOGL_OFF : (level > LOGL_TRACE ? LOGL_TRACE : level);
+        if (every >= 1) s->every = every;
+        if (rate >= 0.0) {
+            s->rate   = rate;
+            s->tokens = rate;   // a fresh limit starts with a full burst
+        }
+        s->have_key = 0;
+    }
+    if (g_out) {
+        fprintf(g_out, "[B] LOG %s: level=%d every=%d rate=%.0f/s\n",
+                logc_name(cat), g_logc[lo].level, g_logc[lo].every, g_logc[lo].rate);
+    }
+}
+
+void logc_configure(const SimParams *p) {
+    const int levels[LOGC_COUNT] = {
+        [LOGC_STATE]  = p->log_state,
+        [LOGC_FORCE]  = p->log_force,
+        [LOGC_KEYS]   = p->log_keys,
+        [LOGC_ENTITY] = p->log_entity,
+    };
+    double now = now_sec();
+    for (int c = 0; c < LOGC_COUNT; ++c) {
+        LogCatState *s = &g_logc[c];
+        s->level       = levels[c];
+        s->every       = 1;
+        s->on_change   = 0;
+        s->rate        = p->log_rate;
+        s->tokens      = p->log_rate;
+        s->last_refill = now;
+        s->have_key    = 0;
+    }
+    g_logc[LOGC_STATE].every     = p->log_state_every > 1 ? p->log_state_every : 1;
+    g_logc[LOGC_STATE].on_change = p->log_state_on_change;
+}
+
+void logc_init(FILE *out, const SimParams *p) {
+    memset(g_logc, 0, sizeof(g_logc));
+    g_out = out;
+    logc_configure(p);
+}
+
+int logc_admit(LogCat cat, uint64_t key) {
+    LogCatState *s = &g_logc[cat];
+    s->seen++;
+
+    if (s->every > 1 && (s->seen - 1) % s->every != 0) {
+        s->sampled_out++;
+        return 0;
+    }
+    if (s->on_change) {
+        if (s->have_key && key == s->last_key) {
+            s->sampled_out++;
+            return 0;
+        }
+        s->last_key = key;
+        s->have_key = 1;
+    }
+    if (s->rate > 0.0) {
+        // Token bucket: refills at `rate`, holds at most one second of lines
+        double now = now_sec();
+        s->tokens += (now - s->last_refill) * s->rate;
+        if (s->tokens > s->rate) s->tokens = s->rate;
+        s->last_refill = now;
+        if (s->tokens < 1.0) {
+            s->limited++;
+            s->limited_total++;
+            return 0;
+        }
+        s->tokens -= 1.0;
+    }
+    s->written++;
+    return 1;
+}
+
+void logc_printf(const char *fmt, ...) {
+    if (!g_out) return;
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(g_out, fmt, ap);
+    va_end(ap);
+}
+
+void logc_report(double now) {
+    static double window_start = 0.0;
+    if (now - window_start < 1.0) return;
+    window_start = now;
+    for (int c = 0; c < LOGC_COUNT; ++c) {
+        LogCatState *s = &g_logc[c];
+        if (s->limited == 0) continue;
+        if (g_out) fprintf(g_out, "[B] LOG %s: %ld line(s) dropped by the %.0f/s rate limit\n",
+                           k_names[c], s->limited, s->rate);
+        s->limited = 0;
+    }
+}
+
+int logc_reload(const char *path, SimParams *p) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+
+    // Only the log_* keys: everything else keeps its startup value
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        char   key[64];
+        double d;
+        if (sscanf(line, " %63[a-z_] = %lf", key, &d) == 2 && strncmp(key, "log_", 4) == 0)
+            set_param_by_name(p, key, d);
+    }
+    fclose(fp);
+    logc_configure(p);
+    if (g_out) {
+        fprintf(g_out, "[B] LOG reloaded from %s: state=%d(1/%d%s) force=%d keys=%d entity=%d rate=%.0f/s\n",
+                path, p->log_state, g_logc[LOGC_STATE].every, p->log_state_on_change ? ",on change" : "",
+                p->log_force, p->log_keys, p->log_entity, p->log_rate);
+    }
+    return 0;
+}
+
+uint64_t logc_key4(double a, double b, double c, double d, double scale) {
+    const double v[4] = { a, b, c, d };
+    uint64_t h = 0xcbf29ce484222325ull;   // FNV-1a over the rounded values
+    for (int i = 0; i < 4; ++i) {
+        h ^= (uint64_t)llround(v[i] * scale);
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
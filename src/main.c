@@ -1,26 +1,30 @@
 /**
  * @brief Entry point and Master Process orchestrator.
- * 
+ *
  * @details
  * This file is responsible for booting the entire system architecture.
- * 
- * **Process Topology**:
+ *
+ * **Process Topology** (default, see topology.txt):
  * The Master process spawns 5 children and then *transforms* into the Server (B).
- * 
- *       [Keyboard I] ---> pipe_I_to_B ---> [Server B]
- *       [Server B] <--- pipe_D_to_B <--- [Dynamics D]
- *       [Server B] ---> pipe_D_to_B ---> [Dynamics D]
- *       [Server B] <--- pipe_T_to_B <--- [Targets T]
- *       [Server B] <--- pipe_O_to_B <--- [Obstacles O]
- * 
+ *
+ *       [Keyboard I] ---> I_to_B ---> [Server B]
+ *       [Server B] <--- D_to_B <--- [Dynamics D]
+ *       [Server B] ---> B_to_D ---> [Dynamics D]
+ *       [Server B] <--- T_to_B <--- [Targets T]
+ *       [Server B] <--- O_to_B <--- [Obstacles O]
+ *
  *       [Watchdog W] <--- (Signals) ------ [All Processes]
- * 
+ *
  * **Key Responsibility**:
- * 1. Load configuration (params.txt).
- * 2. Create all communication pipes.
- * 3. Fork all child processes (I, D, O, T, W).
- * 4. Close unused pipe ends in each process (critical for EOF detection).
+ * 1. Load configuration (params.txt, topology.txt, optional scenario file,
+ *    command line: --scenario, --soak, --time-scale).
+ * 2. Create all communication channels (pipes or socketpairs).
+ * 3. Launch all components (I, D, O, T as processes or threads, W as a process).
+ * 4. Close unused channel ends in each process (done generically by topology.c).
  * 5. Parent process becomes the Server (B).
+ *
+ * With --pool <k> steps 2-5 run in k pre-launched worlds parked until an
+ * `arp1 --attach` session claims one (see pool.h).
  */
 
 #include "headers/params.h"
@@ -33,171 +37,162 @@
 #include "headers/targets.h"
 
 #include "headers/watchdog.h"
+#include "headers/topology.h"
+#include "headers/scenario.h"
+#include "headers/soak.h"
+#include "headers/faults.h"
+#include "headers/alloccheck.h"
+#include "headers/pool.h"
 
 #include <unistd.h>
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
+// Parameters are loaded before launching, so every component sees the same copy.
+static SimParams g_params;
+static Topology  g_topo;
 
-int main(void) {
-    // Ensures logs/ directory exists
-    ensure_logs_dir();
+// ---------------- Component entry points (look up their channel ends) ----------------
+static void start_keyboard(Topology *t) {
+    pool_park(COMP_I);
+    run_keyboard_process(topo_wfd(t, CH_I_TO_B));
+}
 
-    // 1) Loads parameters BEFORE forking so children inherit the struct.
-    SimParams params;
-    init_default_params(&params);
-    load_params_from_file("params.txt", &params);
-
-    // 2) Creates pipes:
-    //    - I -> B
-    //    - B -> D
-    //    - D -> B
-    int pipe_I_to_B[2];
-    int pipe_B_to_D[2];
-    int pipe_D_to_B[2];
-    // Creates pipes from obs and targets
-    //    - O -> B
-    //    - T -> B
-    int pipe_O_to_B[2];
-    int pipe_T_to_B[2];
-
-    // One-time configuration pipe: master -> watchdog
-    int pipe_CFG_to_W[2];
-
-    if (pipe(pipe_I_to_B) == -1) die("pipe I->B");
-    if (pipe(pipe_B_to_D) == -1) die("pipe B->D");
-    if (pipe(pipe_D_to_B) == -1) die("pipe D->B");
-    //
-    if (pipe(pipe_O_to_B) == -1) die("pipe O->B");
-    if (pipe(pipe_T_to_B) == -1) die("pipe T->B");
-
-    if (pipe(pipe_CFG_to_W) == -1) die("pipe CFG->W");
-    
-    // 3) Forks Keyboard process (I)
-    pid_t pid_I = fork();
-    if (pid_I == -1) die("fork I");
-
-    if (pid_I == 0) {
-        // CHILD: I
-        close(pipe_I_to_B[0]);   // I only writes to I->B[1]
-
-        // Closes all unused ends: B, D, O, T, CFG pipes
-        close(pipe_B_to_D[0]); close(pipe_B_to_D[1]);
-        close(pipe_D_to_B[0]); close(pipe_D_to_B[1]);
-        close(pipe_O_to_B[0]); close(pipe_O_to_B[1]);
-        close(pipe_T_to_B[0]); close(pipe_T_to_B[1]);
-        close(pipe_CFG_to_W[0]); close(pipe_CFG_to_W[1]);
-
-        run_keyboard_process(pipe_I_to_B[1]);
-    }
+static void start_dynamics(Topology *t) {
+    pool_park(COMP_D);
+    run_dynamics_process(topo_rfd(t, CH_B_TO_D), topo_wfd(t, CH_D_TO_B), g_params);
+}
 
-    // 4) Forks Dynamics process (D)
-    pid_t pid_D = fork();
-    if (pid_D == -1) die("fork D");
+static void start_obstacles(Topology *t) {
+    pool_park(COMP_O);
+    run_obstacle_process(topo_wfd(t, CH_O_TO_B), g_params);
+}
 
-    if (pid_D == 0) {
-        // CHILD: D
-        close(pipe_B_to_D[1]);   // D reads from B->D[0]
-        close(pipe_D_to_B[0]);   // D writes to D->B[1]
+static void start_targets(Topology *t) {
+    pool_park(COMP_T);
+    run_target_process(topo_wfd(t, CH_T_TO_B), g_params);
+}
 
-        // Closes all unused ends: I, O, T, CFG pipes
-        close(pipe_I_to_B[0]); close(pipe_I_to_B[1]);
-        close(pipe_O_to_B[0]); close(pipe_O_to_B[1]);
-        close(pipe_T_to_B[0]); close(pipe_T_to_B[1]);
-        close(pipe_CFG_to_W[0]); close(pipe_CFG_to_W[1]);
+static void start_watchdog(Topology *t) {
+    pool_park(COMP_W);
+    // warn after configured sec, kill after configured sec
+    run_watchdog_process(topo_rfd(t, CH_CFG_TO_W), g_params.wd_warn_sec, g_params.wd_kill_sec);
+}
 
-        run_dynamics_process(pipe_B_to_D[0], pipe_D_to_B[1], params);
-    }
 
-    // 5) Forks Obstacles process (O)
-    pid_t pid_O = fork();
-    if (pid_O == -1) die("fork O");
-
-    if (pid_O == 0) {
-        // CHILD: Obstacle generator
-        close(pipe_O_to_B[0]);   // O writes to O->B[1]
-
-        // Closes all unused endsq: I, D, T, CFG pipes
-        close(pipe_I_to_B[0]); close(pipe_I_to_B[1]);
-        close(pipe_B_to_D[0]); close(pipe_B_to_D[1]);
-        close(pipe_D_to_B[0]); close(pipe_D_to_B[1]);
-        close(pipe_T_to_B[0]); close(pipe_T_to_B[1]);
-        close(pipe_CFG_to_W[0]); close(pipe_CFG_to_W[1]);
-        run_obstacle_process(pipe_O_to_B[1], params);
-    }
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [--scenario <file>] [--soak <sim_hours>] [--time-scale <x>] [--pool <k>]\n"
+            "       %s --attach\n"
+            "  --soak <h>        headless run for h simulated hours, writes logs/soak_report.txt\n"
+            "  --time-scale <x>  simulated seconds per wall second (soak default: %.0f)\n"
+            "  --pool <k>        keep k worlds launched and parked for --attach sessions\n"
+            "  --attach          run this terminal's session on a parked world of the pool\n",
+            prog, prog, SOAK_DEFAULT_TIME_SCALE);
+    exit(EXIT_FAILURE);
+}
+
+// Steps 2-5: one world (cold start, or one of the pool's worlds)
+static int run_world(void) {
+    // Fault injection table (builds with FAULTS=1), shared with every component
+    fault_setup();
+
+    // Allocation counters (builds with ALLOC_CHECK=1), shared with every component
+    alloc_check_setup();
+
+    // Pooled world: own session, directory and component gates (no-op otherwise)
+    pool_world_init(&g_topo);
+
+    // 2) Creates every channel:
+    //    - I -> B, B -> D, D -> B, O -> B, T -> B
+    //    - one-time configuration channel: master -> watchdog
+    topo_create_channels(&g_topo);
+
+    // 3) Launches I, D, O, T, W (B is the master itself)
+    const ComponentMain entries[COMP_COUNT] = {
+        [COMP_B] = NULL,
+        [COMP_I] = start_keyboard,
+        [COMP_D] = start_dynamics,
+        [COMP_O] = start_obstacles,
+        [COMP_T] = start_targets,
+        [COMP_W] = start_watchdog,
+    };
+    topo_launch(&g_topo, entries);
+
+    // Pooled world: parks here until a session claims it (no-op otherwise)
+    pool_claim();
+
+    // 4) PARENT: Becomes Server B
+    // Send PIDs to watchdog; thread components report B's PID. The channel stays
+    // open so B can send updates when it restarts a component.
+    int cfg_fd = topo_wfd(&g_topo, CH_CFG_TO_W);
+    WatchPids wp;
+    wp.pid_B = getpid(); // B is the master process itself
+    wp.pid_I = g_topo.comp[COMP_I].pid;
+    wp.pid_D = g_topo.comp[COMP_D].pid;
+    wp.pid_O = g_topo.comp[COMP_O].pid;
+    wp.pid_T = g_topo.comp[COMP_T].pid;
 
-    // 6) Forks Targets process (T)
-    pid_t pid_T = fork();
-    if (pid_T == -1) die("fork T");
-
-    if (pid_T == 0) {
-        // CHILD: Target generator
-        close(pipe_T_to_B[0]);   // T writes to T->B[1]
-        
-        // Closes all unused ends: I, D, O, CFG pipes
-        close(pipe_I_to_B[0]); close(pipe_I_to_B[1]);
-        close(pipe_B_to_D[0]); close(pipe_B_to_D[1]);
-        close(pipe_D_to_B[0]); close(pipe_D_to_B[1]);
-        close(pipe_O_to_B[0]); close(pipe_O_to_B[1]);
-        close(pipe_CFG_to_W[0]); close(pipe_CFG_to_W[1]);
-        run_target_process(pipe_T_to_B[1], params);
+    if (write(cfg_fd, &wp, sizeof(wp)) != (int)sizeof(wp)) {
+        perror("[MAIN/B] write WatchPids to W failed");
     }
 
-    // 7) Fork Watchdog (W) — signal based
-    pid_t pid_W = fork();
-    if (pid_W == -1) die("fork W");
 
-    if (pid_W == 0) {
-        // CHILD: W
-        close(pipe_CFG_to_W[1]);    // W reads config from pipe_CFG_to_W[0]
+    int status = run_server_process(topo_rfd(&g_topo, CH_I_TO_B),
+                        topo_wfd(&g_topo, CH_B_TO_D),
+                        topo_rfd(&g_topo, CH_D_TO_B),
+                        topo_rfd(&g_topo, CH_O_TO_B),
+                        topo_rfd(&g_topo, CH_T_TO_B),
+                        cfg_fd, wp, g_topo.comp[COMP_W].pid, g_params);
 
-        // Close all other pipes (W doesn't use them)
-        close(pipe_I_to_B[0]); close(pipe_I_to_B[1]);
-        close(pipe_B_to_D[0]); close(pipe_B_to_D[1]);
-        close(pipe_D_to_B[0]); close(pipe_D_to_B[1]);
-        close(pipe_O_to_B[0]); close(pipe_O_to_B[1]);
-        close(pipe_T_to_B[0]); close(pipe_T_to_B[1]);
+    // 5) Waits for children to avoid zombies (good practice)
+    while (wait(NULL) > 0) {
+        // loop until all children are reaped
+    }
+    pool_finish(status);
+    return status;
+}
 
-        // warn after configured sec, kill after configured sec
-        run_watchdog_process(pipe_CFG_to_W[0], params.wd_warn_sec, params.wd_kill_sec);
+int main(int argc, char **argv) {
+    pool_mark_start();   // time to first tick counts from here
+
+    const char *scenario_path = NULL;
+    double soak_hours = 0.0;    // 0 = not given
+    double time_scale = 0.0;    // 0 = not given
+    int    pool_k     = 0;      // 0 = cold start
+    for (int i = 1; i < argc; ++i) {
+        if      (strcmp(argv[i], "--scenario")   == 0 && i + 1 < argc) scenario_path = argv[++i];
+        else if (strcmp(argv[i], "--soak")       == 0 && i + 1 < argc) soak_hours = strtod(argv[++i], NULL);
+        else if (strcmp(argv[i], "--time-scale") == 0 && i + 1 < argc) time_scale = strtod(argv[++i], NULL);
+        else if (strcmp(argv[i], "--pool")       == 0 && i + 1 < argc) pool_k = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--attach")     == 0 && argc == 2)    return pool_attach();
+        else usage(argv[0]);
     }
 
-    // 8) PARENT: Becomes Server B
-    close(pipe_I_to_B[1]);  // B reads from I->B[0]
-    close(pipe_B_to_D[0]);  // B writes to B->D[1]  // Close read end where B only writes
-    close(pipe_D_to_B[1]);  // B reads from D->B[0]
+    // Ensures logs/ directory exists
+    ensure_logs_dir();
 
-    close(pipe_O_to_B[1]);  // B reads from O->B[0]
-    close(pipe_T_to_B[1]);  // B reads from T->B[0]
+    // 1) Loads parameters BEFORE forking so children inherit the struct.
+    init_default_params(&g_params);
+    load_params_from_file("params.txt", &g_params);
 
-    // Send PIDs to watchdog (one-time config)
-    close(pipe_CFG_to_W[0]); // parent writes
-    WatchPids wp;
-    wp.pid_B = getpid(); // B is the master process itself
-    wp.pid_I = pid_I;
-    wp.pid_D = pid_D;
-    wp.pid_O = pid_O;
-    wp.pid_T = pid_T;
+    // Scenario (optional): validated now, overrides params, shared with every component
+    if (scenario_path) scenario_load(scenario_path, &g_params);
 
-    if (write(pipe_CFG_to_W[1], &wp, sizeof(wp)) != (int)sizeof(wp)) {
-        perror("[MAIN/B] write WatchPids to W failed");
+    // Command line wins over params.txt and the scenario
+    if (soak_hours > 0.0) {
+        g_params.soak_sim_sec = soak_hours * 3600.0;
+        if (g_params.time_scale == 1.0) g_params.time_scale = SOAK_DEFAULT_TIME_SCALE;
     }
-    close(pipe_CFG_to_W[1]);
-
+    if (time_scale > 0.0) g_params.time_scale = time_scale;
 
-    run_server_process(pipe_I_to_B[0],
-                        pipe_B_to_D[1],
-                        pipe_D_to_B[0],
-                        pipe_O_to_B[0],
-                        pipe_T_to_B[0],
-                        pid_W,params);
+    // Topology (process/thread placement, CPUs, transports)
+    topo_init_default(&g_topo);
+    topo_load_from_file("topology.txt", &g_topo);
 
-    // 9) Waits for children to avoid zombies (good practice)
-    // Forked 5 children: I, D, O, T, W
-    while (wait(NULL) > 0) {
-        // loop until all children are reaped
-    }
-    return 0;
+    if (pool_k > 0) return pool_run(pool_k, run_world);
+    return run_world();
 }
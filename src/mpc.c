@@ -0,0 +1,263 @@
+// mpc.c
+// Sampling MPC autopilot (MPPI) with batched rollouts (see mpc.h)
+// Built with -O3 -fno-math-errno -fno-trapping-math (Makefile) so the
+// per-sample loops, sqrt, divisions and max() included, are vectorized.
+// Rollout arithmetic is done in mpc_real; per-step costs are widened to
+// double before they are accumulated.
+// ======================================================================
+
+#include "headers/mpc.h"
+#include "headers/util.h"   // OBS_CLEARANCE_FRAC, OBS_GAIN
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+// Cost weights (distances in world units, forces in N)
+#define W_EFFORT  0.002   // per step, |F|^2
+#define W_OBS     0.5     // per step, obstacle repulsion magnitude felt
+#define W_TERM    5.0     // terminal distance^2
+#define W_BRAKE   4.0     // no target: per step |v|^2
+#define LAMBDA    0.1     // temperature, as a share of the mean cost spread
+
+#ifdef MPC_FLOAT32
+#define SQRT_R sqrtf
+#else
+#define SQRT_R sqrt
+#endif
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static double rand_unit(Mpc *m) {
+    unsigned long long z = m->rng;
+    z ^= z << 13;
+    z ^= z >> 7;
+    z ^= z << 17;
+    m->rng = z;
+    return ((double)(z >> 11) + 0.5) * (1.0 / 9007199254740992.0);   // (0, 1)
+}
+
+// Box-Muller: fills n normal samples with standard deviation sigma.
+// Drawn in double in both precisions, so f32 and f64 builds see the same noise.
+static void fill_noise(Mpc *m, mpc_real *out, int n, double sigma) {
+    for (int i = 0; i < n; i += 2) {
+        double r = sigma * sqrt(-2.0 * log(rand_unit(m)));
+        double a = 2.0 * M_PI * rand_unit(m);
+        out[i] = (mpc_real)(r * cos(a));
+        if (i + 1 < n) out[i + 1] = (mpc_real)(r * sin(a));
+    }
+}
+
+static inline double clampf(double v, double lim) {
+    return v > lim ? lim : (v < -lim ? -lim : v);
+}
+
+static inline mpc_real clampr(mpc_real v, mpc_real lim) {
+    return v > lim ? lim : (v < -lim ? -lim : v);
+}
+
+static inline mpc_real maxr(mpc_real a, mpc_real b) {
+    return a > b ? a : b;
+}
+
+// D's wall field for one border at distance d: 1/d - 1/clear is negative
+// beyond the clearance, so the max() replaces D's branch (same values).
+static inline mpc_real wall_push(mpc_real d, mpc_real inv_clear, mpc_real gain) {
+    return maxr(gain * ((mpc_real)1 / maxr(d, (mpc_real)1e-3) - inv_clear), (mpc_real)0);
+}
+
+void mpc_init(Mpc *m, const SimParams *p) {
+    memset(m, 0, sizeof(*m));
+    m->samples = p->mpc_samples;
+    if (m->samples > MPC_MAX_SAMPLES) m->samples = MPC_MAX_SAMPLES;
+    if (m->samples < MPC_MIN_SAMPLES) m->samples = MPC_MIN_SAMPLES;
+    m->horizon = p->mpc_horizon;
+    if (m->horizon > MPC_MAX_HORIZON) m->horizon = MPC_MAX_HORIZON;
+    if (m->horizon < 1) m->horizon = 1;
+    m->rng = 0x9E3779B97F4A7C15ull;
+    m->win_start = now_sec();
+}
+
+void mpc_set_active(Mpc *m, int on, FILE *log) {
+    if (m->active == on) return;
+    m->active = on;
+    memset(m->ux, 0, sizeof(m->ux));
+    memset(m->uy, 0, sizeof(m->uy));
+    if (log) fprintf(log, "[B] MPC: autopilot %s (%d samples x %d steps)\n",
+                     on ? "ON" : "OFF", m->samples, m->horizon);
+}
+
+// Rolls every sample out over the horizon. Sample 0 carries no noise, so the
+// previous plan always competes.
+// ----------------------------------------------------------------------
+static void rollout(Mpc *m, const DroneStateMsg *s0, const SimParams *p,
+                    const double *ox, const double *oy, int n_o,
+                    double tx, double ty, int brake)
+{
+    typedef mpc_real R;
+    const int S      = m->samples;
+    const R   dt     = (R)p->dt;
+    const R   inv_m  = (R)(1.0 / p->mass);
+    const R   k      = (R)p->visc;
+    const R   wh     = (R)p->world_half, inv_wc = (R)(1.0 / p->wall_clearance), wg = (R)p->wall_gain;
+    const R   inv_oc = (R)(1.0 / (p->world_half * OBS_CLEARANCE_FRAC));
+    const R   gain   = (R)OBS_GAIN;
+    const R   fmax   = (R)p->mpc_max_force;
+    const R   gx     = (R)tx, gy = (R)ty;
+    const R   w_pos  = brake ? (R)0 : (R)1;         // tracking: distance to the target
+    const R   w_vel  = brake ? (R)W_BRAKE : (R)0;   // no target: come to a stop
+
+    R *restrict x  = m->x,  *restrict y  = m->y;
+    R *restrict vx = m->vx, *restrict vy = m->vy;
+    R *restrict fx = m->fx, *restrict fy = m->fy;
+    double *restrict c = m->cost;
+
+    for (int i = 0; i < S; ++i) {
+        x[i] = (R)s0->x;  y[i] = (R)s0->y;
+        vx[i] = (R)s0->vx; vy[i] = (R)s0->vy;
+        c[i] = 0.0;
+    }
+
+    for (int t = 0; t < m->horizon; ++t) {
+        const R *restrict ex = m->ex[t];
+        const R *restrict ey = m->ey[t];
+        const R ux = (R)m->ux[t], uy = (R)m->uy[t];
+
+        // Candidate force (user force) and D's wall field
+        for (int i = 0; i < S; ++i) {
+            R f_x = clampr(ux + ex[i], fmax);
+            R f_y = clampr(uy + ey[i], fmax);
+            c[i] += W_EFFORT * (double)(f_x * f_x + f_y * f_y);
+            fx[i] = f_x + wall_push(wh + x[i], inv_wc, wg) - wall_push(wh - x[i], inv_wc, wg);
+            fy[i] = f_y + wall_push(wh + y[i], inv_wc, wg) - wall_push(wh - y[i], inv_wc, wg);
+        }
+
+        // Obstacle field B adds (continuous here; B rounds it to key steps)
+        for (int o = 0; o < n_o; ++o) {
+            const R px = (R)ox[o], py = (R)oy[o];
+            for (int i = 0; i < S; ++i) {
+                R dx  = x[i] - px, dy = y[i] - py;
+                R inv = (R)1 / maxr(SQRT_R(dx * dx + dy * dy), (R)1e-3);   // one division per pair
+                R mag = maxr(gain * (inv - inv_oc), (R)0);
+                fx[i] += mag * dx * inv;
+                fy[i] += mag * dy * inv;
+                c[i]  += W_OBS * (double)mag;
+            }
+        }
+
+        // D's integrator (semi-implicit Euler) and the tracking cost
+        for (int i = 0; i < S; ++i) {
+            vx[i] += (fx[i] - k * vx[i]) * inv_m * dt;
+            vy[i] += (fy[i] - k * vy[i]) * inv_m * dt;
+            x[i]  += vx[i] * dt;
+            y[i]  += vy[i] * dt;
+            R dx = x[i] - gx, dy = y[i] - gy;
+            c[i] += (double)(w_pos * (dx * dx + dy * dy) + w_vel * (vx[i] * vx[i] + vy[i] * vy[i]));
+        }
+    }
+
+    for (int i = 0; i < S; ++i) {
+        R dx = x[i] - gx, dy = y[i] - gy;
+        c[i] += W_TERM * (double)(dx * dx + dy * dy);
+    }
+}
+
+void mpc_plan(Mpc *m, const DroneStateMsg *cur_state, const SimParams *p,
+              const EcsArchetype *obs, const EcsArchetype *tgt,
+              ForceStateMsg *user_force)
+{
+    double t0 = now_sec();
+    const int S = m->samples, H = m->horizon;
+
+    // Goal: nearest target, else stop where we are
+    double tx = cur_state->x, ty = cur_state->y, best = -1.0;
+    for (int i = 0; i < tgt->n; ++i) {
+        double dx = tgt->x[i] - cur_state->x, dy = tgt->y[i] - cur_state->y;
+        double d2 = dx * dx + dy * dy;
+        if (best < 0.0 || d2 < best) { best = d2; tx = tgt->x[i]; ty = tgt->y[i]; }
+    }
+    int brake = best < 0.0;
+
+    double ox[NUM_OBSTACLES], oy[NUM_OBSTACLES];
+    int n_o = obs->n < NUM_OBSTACLES ? obs->n : NUM_OBSTACLES;
+    memcpy(ox, obs->x, (size_t)n_o * sizeof(double));
+    memcpy(oy, obs->y, (size_t)n_o * sizeof(double));
+
+    for (int t = 0; t < H; ++t) {
+        fill_noise(m, m->ex[t], S, p->mpc_sigma);
+        fill_noise(m, m->ey[t], S, p->mpc_sigma);
+        m->ex[t][0] = 0.0;
+        m->ey[t][0] = 0.0;
+    }
+
+    rollout(m, cur_state, p, ox, oy, n_o, tx, ty, brake);
+
+    // Path-integral weights: exp(-(c - c_min) / lambda)
+    double cmin = m->cost[0], cmean = 0.0;
+    for (int i = 0; i < S; ++i) {
+        if (m->cost[i] < cmin) cmin = m->cost[i];
+        cmean += m->cost[i];
+    }
+    cmean /= S;
+    double lambda = LAMBDA * (cmean - cmin) + 1e-12;
+    double wsum = 0.0;
+    for (int i = 0; i < S; ++i) {
+        m->w[i] = exp(-(m->cost[i] - cmin) / lambda);
+        wsum += m->w[i];
+    }
+
+    // New plan: weighted average of the sampled sequences
+    for (int t = 0; t < H; ++t) {
+        double ax = 0.0, ay = 0.0;
+        for (int i = 0; i < S; ++i) {
+            ax += m->w[i] * clampf(m->ux[t] + (double)m->ex[t][i], p->mpc_max_force);
+            ay += m->w[i] * clampf(m->uy[t] + (double)m->ey[t][i], p->mpc_max_force);
+        }
+        m->ux[t] = ax / wsum;
+        m->uy[t] = ay / wsum;
+    }
+
+    user_force->Fx = m->ux[0];
+    user_force->Fy = m->uy[0];
+
+    // Warm start for the next tick: shift the plan by one step
+    memmove(m->ux, m->ux + 1, (size_t)(H - 1) * sizeof(double));
+    memmove(m->uy, m->uy + 1, (size_t)(H - 1) * sizeof(double));
+
+    // Throughput bookkeeping, then fit the next plan into the tick budget
+    m->last_ms    = (now_sec() - t0) * 1000.0;
+    m->plan_bytes = (size_t)S * (6 * sizeof(mpc_real) + 2 * sizeof(double))   // state, force, cost, w
+                  + (size_t)2 * H * S * sizeof(mpc_real);                    // noise
+    m->plans++;
+    m->win_plans++;
+    m->win_rollouts += S;
+    m->win_ms += m->last_ms;
+    if (m->last_ms > m->win_max_ms) m->win_max_ms = m->last_ms;
+
+    double budget_ms = MPC_BUDGET_FRAC * 1000.0 * p->dt / (p->time_scale > 0.0 ? p->time_scale : 1.0);
+    if (m->last_ms > budget_ms && S > MPC_MIN_SAMPLES) {
+        m->samples = S / 2 < MPC_MIN_SAMPLES ? MPC_MIN_SAMPLES : S / 2;
+    } else if (m->last_ms < 0.25 * budget_ms && S * 2 <= p->mpc_samples && S * 2 <= MPC_MAX_SAMPLES) {
+        m->samples = S * 2;
+    }
+}
+
+void mpc_report(Mpc *m, double now, FILE *log) {
+    if (now - m->win_start < 1.0) return;
+    if (m->win_plans > 0 && m->win_ms > 0.0) {
+        m->rollouts_per_ms = m->win_rollouts / m->win_ms;
+        if (log) fprintf(log, "[B] MPC: %ld plan(s), %d samples x %d steps, mean %.3fms max %.3fms, "
+                              "%.0f rollouts/ms, %s %zu KiB/plan\n",
+                         m->win_plans, m->samples, m->horizon, m->win_ms / m->win_plans,
+                         m->win_max_ms, m->rollouts_per_ms, MPC_PRECISION_NAME, m->plan_bytes / 1024);
+    }
+    m->win_start    = now;
+    m->win_plans    = 0;
+    m->win_rollouts = 0;
+    m->win_ms       = 0.0;
+    m->win_max_ms   = 0.0;
+}
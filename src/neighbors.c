@@ -0,0 +1,96 @@
+// neighbors.c
+// Verlet neighbor lists (see neighbors.h)
+// ======================================================================
+
+#include "headers/neighbors.h"
+
+#include <string.h>
+
+#define NBR_REPORT_SEC 10.0
+
+void nbr_init(NbrList *l, const char *name) {
+    memset(l, 0, sizeof(*l));
+    l->name = name;
+}
+
+static void rebuild(NbrList *l, double x, double y, double reach,
+                    const double *xs, const double *ys, int count) {
+    double reach2 = reach * reach;
+    l->n = 0;
+    for (int i = 0; i < count && i < NBR_MAX_SLOTS; ++i) {
+        double dx = x - xs[i];
+        double dy = y - ys[i];
+        if (dx*dx + dy*dy <= reach2) l->idx[l->n++] = i;
+    }
+    l->x0 = x;
+    l->y0 = y;
+}
+
+int nbr_query(NbrList *l, double x, double y, double radius, double skin,
+              const double *xs, const double *ys, int count, uint64_t version) {
+    l->queries++;
+    l->rep_queries++;
+
+    if (skin <= 0.0) {
+        // Lists off: every row, as before
+        l->n = 0;
+        for (int i = 0; i < count && i < NBR_MAX_SLOTS; ++i) l->idx[l->n++] = i;
+        l->valid = 0;
+        l->off   = 1;
+        l->slots_checked += count;
+        l->rep_checked   += count;
+        return l->n;
+    }
+
+    l->off = 0;
+    double dx = x - l->x0;
+    double dy = y - l->y0;
+    int moved   = dx*dx + dy*dy > 0.25 * skin * skin;
+    int changed = version != l->version || radius != l->radius;
+    if (!l->valid || moved || changed) {
+        rebuild(l, x, y, radius + skin, xs, ys, count);
+        l->valid   = 1;
+        l->radius  = radius;
+        l->version = version;
+        l->rebuilds++;
+        l->rep_rebuilds++;
+        if (changed)    l->rebuilds_changed++;
+        else if (moved) l->rebuilds_moved++;
+        l->slots_checked += count;
+        l->rep_checked   += count;
+    } else {
+        l->slots_checked += l->n;
+        l->rep_checked   += l->n;
+    }
+    return l->n;
+}
+
+void nbr_report(NbrList *l, double now, int final, FILE *log) {
+    if (!log) return;
+    if (final) {
+        if (l->queries == 0) return;
+        if (l->off) {
+            fprintf(log, "[B] NBR %s: lists off (nbr_skin = 0), %.2f slot(s) checked per query\n",
+                    l->name, (double)l->slots_checked / (double)l->queries);
+            return;
+        }
+        fprintf(log, "[B] NBR %s: %ld queries, hit rate %.1f%%, %ld rebuild(s) (%ld moved, %ld set changed), "
+                     "%.2f slot(s) checked per query\n",
+                l->name, l->queries, 100.0 * (double)(l->queries - l->rebuilds) / (double)l->queries,
+                l->rebuilds, l->rebuilds_moved, l->rebuilds_changed,
+                (double)l->slots_checked / (double)l->queries);
+        return;
+    }
+    if (l->rep_start == 0.0) l->rep_start = now;
+    double span = now - l->rep_start;
+    if (span < NBR_REPORT_SEC) return;
+    if (l->rep_queries > 0 && !l->off) {
+        fprintf(log, "[B] NBR %s: hit rate %.1f%%, %.2f rebuild(s)/s, %.2f slot(s) checked per query, %d candidate(s)\n",
+                l->name, 100.0 * (double)(l->rep_queries - l->rep_rebuilds) / (double)l->rep_queries,
+                (double)l->rep_rebuilds / span, (double)l->rep_checked / (double)l->rep_queries, l->n);
+    }
+    l->rep_start   = now;
+    l->rep_queries = 0;
+    l->rep_rebuilds = 0;
+    l->rep_checked = 0;
+}
@@ -2,14 +2,16 @@
 #include "headers/params.h"
 #include "headers/obstacles.h"
 #include "headers/util.h"
+#include "headers/topology.h"  // component_exit()
+#include "headers/scenario.h"
+#include "headers/faults.h"
+#include "headers/vclock.h"
 
 #include <unistd.h>
 #include <stdlib.h>
 #include <time.h>
 #include <stdio.h>
 
-Obstacle g_obstacles[NUM_OBSTACLES];
-
 
 /**
  * @brief Run the Obstacle Generator (O) process.
@@ -32,6 +34,15 @@ void run_obstacle_process(int write_fd, SimParams params) {
     
     srand((unsigned)time(NULL) ^ getpid());
 
+    // Scenario runs: fixed seed, and no random batches when the scenario scripts the waves
+    const Scenario *scn = scenario_active();
+    if (scn && scn->has_seed) srand(scn->seed * 2u + 1u);
+    if (scn && scn->n_obstacle_waves > 0) {
+        fprintf(log, "[O] Scenario '%s' drives obstacles; generator idle.\n", scn->name);
+        fflush(log);
+        while (1) clock_sleep(60.0);   // keeps the channel open so B never sees EOF
+    }
+
     double world_half = params.world_half;
 
 
@@ -55,7 +66,7 @@ void run_obstacle_process(int write_fd, SimParams params) {
 
     // Determines how often to *try* to spawn a new batch of obstacles (in real seconds).
     // Decides how soon O tries to create the next batch
-    const unsigned spawn_interval_sec = 45;   // 40 did good visually, test more
+    const unsigned spawn_interval_sec = OBS_SPAWN_INTERVAL_SEC;
     
     
     while (1) {
@@ -107,6 +118,8 @@ void run_obstacle_process(int write_fd, SimParams params) {
             }
         }
 
+        FAULT_SLEEP_MS(FLT_O_DELAY_MS);   // injected: late batch
+
         // Sends the whole batch to B.
         if (write(write_fd, &msg, sizeof(msg)) == -1) {
             perror("[O] write to B failed");
@@ -118,7 +131,7 @@ void run_obstacle_process(int write_fd, SimParams params) {
         fflush(log);
 
         // Waits a while before attempting to spawn the next batch.
-        sleep(spawn_interval_sec);
+        sleep_sim_sec(spawn_interval_sec, &params);
     }
     // Final cleanup
     if (log) {
@@ -127,5 +140,5 @@ void run_obstacle_process(int write_fd, SimParams params) {
     }
     // Closes pipe to B
     close(write_fd);
-    exit(EXIT_SUCCESS);
+    component_exit(EXIT_SUCCESS);   // pthread_exit() when running as a thread in B
 }
\ No newline at end of file
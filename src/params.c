@@ -52,6 +52,100 @@ void init_default_params(SimParams *p) {
     // Watchdog defaults
     p->wd_warn_sec    = 2;
     p->wd_kill_sec    = 10;
+
+    // I/O backend for B (0 = select + write, 1 = try io_uring)
+    p->io_uring       = 0;
+
+    // Real time, soak mode off
+    p->time_scale      = 1.0;
+    p->soak_sim_sec    = 0.0;
+    p->soak_sample_sec = 10.0;
+
+    // Per-session telemetry recording (input of arp1_analyze)
+    p->telemetry       = 1;
+
+    // Hot-standby D (off by default)
+    p->standby_d          = 0;
+    p->standby_miss_ticks = 2;
+
+    // Generator channels: a few restarts with backoff, then degraded
+    p->peer_max_restarts = 3;
+    p->peer_restart_sec  = 1.0;
+
+    // Change-only force commands to D
+    p->force_epsilon       = 0.01;
+    p->force_keepalive_sec = 0.5;
+
+    // ncurses sends only changed cells
+    p->render_full = 0;
+
+    // External controller API
+    p->ctrl_socket      = 1;
+    p->ctrl_timeout_sec = 0.5;
+
+    // Sampling MPC autopilot (key 'a')
+    p->mpc_samples   = 256;
+    p->mpc_horizon   = 40;
+    p->mpc_sigma     = 4.0;
+    p->mpc_max_force = 15.0;
+
+    // Hot-path logging (debug keeps today's log lines)
+    p->log_state           = 2;
+    p->log_force           = 2;
+    p->log_keys            = 2;
+    p->log_entity          = 2;
+    p->log_state_every     = 1;
+    p->log_state_on_change = 0;
+    p->log_rate            = 200.0;
+
+    // Neighbor lists for repulsion / hit queries
+    p->nbr_skin = 4.0;
+
+    // Per-phase hardware counters (on: one read() per phase boundary)
+    p->perf_counters = 0;
+}
+
+// Sets one parameter by its params.txt key.
+// ----------------------------------------------------------------------
+int set_param_by_name(SimParams *p, const char *key, double d) {
+    if      (strcmp(key, "mass")           == 0) p->mass       = d;
+    else if (strcmp(key, "visc")           == 0) p->visc       = d;
+    else if (strcmp(key, "dt")             == 0) p->dt         = d;
+    else if (strcmp(key, "force_step")     == 0) p->force_step = d;
+    else if (strcmp(key, "world_half")     == 0) p->world_half = d;
+    else if (strcmp(key, "wall_clearance") == 0) p->wall_clearance = d;
+    else if (strcmp(key, "wall_gain")      == 0) p->wall_gain      = d;
+    else if (strcmp(key, "wd_warn_sec")    == 0) p->wd_warn_sec    = (int)d;
+    else if (strcmp(key, "wd_kill_sec")    == 0) p->wd_kill_sec    = (int)d;
+    else if (strcmp(key, "io_uring")       == 0) p->io_uring       = (int)d;
+    else if (strcmp(key, "time_scale")     == 0) p->time_scale     = d;
+    else if (strcmp(key, "soak_sim_sec")   == 0) p->soak_sim_sec   = d;
+    else if (strcmp(key, "soak_sample_sec")== 0) p->soak_sample_sec = d;
+    else if (strcmp(key, "telemetry")      == 0) p->telemetry       = (int)d;
+    else if (strcmp(key, "standby_d")      == 0) p->standby_d       = (int)d;
+    else if (strcmp(key, "standby_miss_ticks") == 0) p->standby_miss_ticks = (int)d;
+    else if (strcmp(key, "peer_max_restarts")  == 0) p->peer_max_restarts  = (int)d;
+    else if (strcmp(key, "peer_restart_sec")   == 0) p->peer_restart_sec   = d;
+    else if (strcmp(key, "force_epsilon")      == 0) p->force_epsilon      = d;
+    else if (strcmp(key, "force_keepalive_sec") == 0) p->force_keepalive_sec = d;
+    else if (strcmp(key, "render_full")        == 0) p->render_full        = (int)d;
+    else if (strcmp(key, "ctrl_socket")        == 0) p->ctrl_socket        = (int)d;
+    else if (strcmp(key, "ctrl_timeout_sec")   == 0) p->ctrl_timeout_sec   = d;
+    else if (strcmp(key, "mpc_samples")        == 0) p->mpc_samples        = (int)d;
+    else if (strcmp(key, "mpc_horizon")        == 0) p->mpc_horizon        = (int)d;
+    else if (strcmp(key, "mpc_sigma")          == 0) p->mpc_sigma          = d;
+    else if (strcmp(key, "mpc_max_force")      == 0) p->mpc_max_force      = d;
+    else if (strcmp(key, "log_state")          == 0) p->log_state          = (int)d;
+    else if (strcmp(key, "log_force")          == 0) p->log_force          = (int)d;
+    else if (strcmp(key, "log_keys")           == 0) p->log_keys           = (int)d;
+    else if (strcmp(key, "log_entity")         == 0) p->log_entity         = (int)d;
+    else if (strcmp(key, "log_state_every")    == 0) p->log_state_every    = (int)d;
+    else if (strcmp(key, "log_state_on_change")== 0) p->log_state_on_change= (int)d;
+    else if (strcmp(key, "log_rate")           == 0) p->log_rate           = d;
+    else if (strcmp(key, "nbr_skin")           == 0) p->nbr_skin           = d;
+    else if (strcmp(key, "perf_counters")      == 0) p->perf_counters      = (int)d;
+    else return -1;
+    return 0;
 }
 
 // Loads parameters from a simple "key=value" file.
@@ -86,16 +180,7 @@ void load_params_from_file(const char *filename, SimParams *p) {
 
         double d = strtod(val, NULL);
 
-        if      (strcmp(key, "mass")           == 0) p->mass       = d;
-        else if (strcmp(key, "visc")           == 0) p->visc       = d;
-        else if (strcmp(key, "dt")             == 0) p->dt         = d;
-        else if (strcmp(key, "force_step")     == 0) p->force_step = d;
-        else if (strcmp(key, "world_half")     == 0) p->world_half = d;
-        else if (strcmp(key, "wall_clearance") == 0) p->wall_clearance = d;
-        else if (strcmp(key, "wall_gain")      == 0) p->wall_gain      = d;
-        else if (strcmp(key, "wd_warn_sec")    == 0) p->wd_warn_sec    = (int)d;
-        else if (strcmp(key, "wd_kill_sec")    == 0) p->wd_kill_sec    = (int)d;
-        else {
+        if (set_param_by_name(p, key, d) != 0) {
             fprintf(stderr, "[PARAMS] Unknown key '%s', ignoring.\n", key);
         }
     }
@@ -0,0 +1,202 @@
+// perfctr.c
+// Per-phase hardware counters (see perfctr.h)
+// ======================================================================
+
+#define _GNU_SOURCE
+#include "headers/perfctr.h"
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+static const struct {
+    const char *name;
+    uint32_t    type;
+    uint64_t    config;
+    int         kernel;   // counted in the kernel (context switches)
+} k_events[PC_EVENT_COUNT] = {
+    [PC_CYCLES]        = { "cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,       0 },
+    [PC_INSTRUCTIONS]  = { "instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,     0 },
+    [PC_CACHE_MISSES]  = { "cache_misses",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,     0 },
+    [PC_BRANCH_MISSES] = { "branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES,    0 },
+    [PC_CTX_SWITCHES]  = { "ctx_switches",  PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, 1 },
+};
+
+static double wall_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static int open_event(int e, int group_fd) {
+    struct perf_event_attr a;
+    memset(&a, 0, sizeof(a));
+    a.size           = sizeof(a);
+    a.type           = k_events[e].type;
+    a.config         = k_events[e].config;
+    a.disabled       = group_fd == -1;   // the leader starts the group
+    a.exclude_kernel = !k_events[e].kernel;
+    a.exclude_hv     = 1;
+    a.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // This thread, any CPU
+    return (int)syscall(SYS_perf_event_open, &a, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+// Reads the group: counters by PcEvent (0 where not counted). 0 or -1.
+static int read_group(PerfCounters *pc, uint64_t v[PC_EVENT_COUNT], uint64_t *enabled, uint64_t *running) {
+    uint64_t buf[3 + PC_EVENT_COUNT];   // nr, time_enabled, time_running, values
+    ssize_t n = read(pc->leader, buf, sizeof(buf));
+    if (n < (ssize_t)(3 * sizeof(uint64_t)) || buf[0] != (uint64_t)pc->n) return -1;
+    *enabled = buf[1];
+    *running = buf[2];
+    for (int e = 0; e < PC_EVENT_COUNT; ++e) v[e] = pc->pos[e] >= 0 ? buf[3 + pc->pos[e]] : 0;
+    return 0;
+}
+
+int pc_open(PerfCounters *pc, const char *role, const char *const *phase_names,
+            int n_phases, int enable, FILE *log) {
+    memset(pc, 0, sizeof(*pc));
+    pc->role     = role;
+    pc->names    = phase_names;
+    pc->n_phases = n_phases < PC_MAX_PHASES ? n_phases : PC_MAX_PHASES;
+    pc->leader   = -1;
+    for (int e = 0; e < PC_EVENT_COUNT; ++e) pc->fd[e] = pc->pos[e] = -1;
+    if (!enable) return 0;
+
+    // The first counter the kernel accepts leads the group
+    for (int e = 0; e < PC_EVENT_COUNT; ++e) {
+        int fd = open_event(e, pc->leader);
+        if (fd == -1) {
+            pc->err[e] = errno;
+            continue;
+        }
+        if (pc->leader == -1) pc->leader = fd;
+        pc->fd[e]  = fd;
+        pc->pos[e] = pc->n++;
+    }
+
+    if (log) {
+        fprintf(log, "[%s] PERF counters:", role);
+        for (int e = 0; e < PC_EVENT_COUNT; ++e) {
+            if (pc->fd[e] != -1) fprintf(log, " %s", k_events[e].name);
+            else                 fprintf(log, " %s (%s)", k_events[e].name, strerror(pc->err[e]));
+        }
+        if (pc->n == 0) fprintf(log, " -> disabled");
+        fprintf(log, "\n");
+        fflush(log);
+    }
+    if (pc->n == 0) return 0;
+
+    ioctl(pc->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(pc->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    if (read_group(pc, pc->last, &pc->enabled, &pc->running) == -1) {
+        if (log) fprintf(log, "[%s] PERF counters: group read failed -> disabled\n", role);
+        pc_close(pc);
+        return 0;
+    }
+    pc->enabled0  = pc->enabled;
+    pc->running0  = pc->running;
+    pc->last_wall = wall_now();
+    return pc->n;
+}
+
+void pc_lap(PerfCounters *pc, int phase) {
+    if (pc->leader == -1 || phase < 0 || phase >= pc->n_phases) return;
+
+    uint64_t v[PC_EVENT_COUNT], enabled, running;
+    if (read_group(pc, v, &enabled, &running) == -1) return;
+    double now = wall_now();
+
+    PcPhase *t = &pc->total[phase], *w = &pc->window[phase];
+    for (int e = 0; e < PC_EVENT_COUNT; ++e) {
+        uint64_t d = v[e] - pc->last[e];
+        t->v[e] += d;
+        w->v[e] += d;
+        pc->last[e] = v[e];
+    }
+    t->laps++;
+    w->laps++;
+    t->wall_sec += now - pc->last_wall;
+    w->wall_sec += now - pc->last_wall;
+    pc->last_wall = now;
+    pc->enabled   = enabled;
+    pc->running   = running;
+}
+
+// One log line for a phase (counters the group lacks are left out)
+static void log_phase(const PerfCounters *pc, const char *what, int i, const PcPhase *p, FILE *log) {
+    const uint64_t *v = p->v;
+    double instr = (double)v[PC_INSTRUCTIONS];
+    fprintf(log, "[%s] PERF %s%s: %ld lap(s), %.1f us/lap", pc->role, what, pc->names[i], p->laps,
+            1e6 * p->wall_sec / (double)p->laps);
+    if (pc->pos[PC_CYCLES] >= 0)
+        fprintf(log, ", %.1fk cyc/lap", (double)v[PC_CYCLES] / 1e3 / (double)p->laps);
+    if (pc->pos[PC_CYCLES] >= 0 && pc->pos[PC_INSTRUCTIONS] >= 0)
+        fprintf(log, ", IPC %.2f", v[PC_CYCLES] ? instr / (double)v[PC_CYCLES] : 0.0);
+    if (pc->pos[PC_INSTRUCTIONS] >= 0 && instr > 0.0) {
+        if (pc->pos[PC_CACHE_MISSES] >= 0)
+            fprintf(log, ", cache miss %.2f/kI", 1e3 * (double)v[PC_CACHE_MISSES] / instr);
+        if (pc->pos[PC_BRANCH_MISSES] >= 0)
+            fprintf(log, ", branch miss %.2f/kI", 1e3 * (double)v[PC_BRANCH_MISSES] / instr);
+    }
+    if (pc->pos[PC_CTX_SWITCHES] >= 0)
+        fprintf(log, ", %llu cs", (unsigned long long)v[PC_CTX_SWITCHES]);
+    fprintf(log, "\n");
+}
+
+static void write_tsv(const PerfCounters *pc, FILE *log) {
+    char path[64];
+    snprintf(path, sizeof(path), PC_TSV_FMT, pc->role);
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        if (log) fprintf(log, "[%s] PERF cannot write %s: %s\n", pc->role, path, strerror(errno));
+        return;
+    }
+    fprintf(f, "role\tphase\tlaps\twall_ms");
+    for (int e = 0; e < PC_EVENT_COUNT; ++e) fprintf(f, "\t%s", k_events[e].name);
+    fprintf(f, "\n");
+    for (int i = 0; i < pc->n_phases; ++i) {
+        const PcPhase *p = &pc->total[i];
+        fprintf(f, "%s\t%s\t%ld\t%.3f", pc->role, pc->names[i], p->laps, 1e3 * p->wall_sec);
+        for (int e = 0; e < PC_EVENT_COUNT; ++e) {
+            if (pc->pos[e] >= 0) fprintf(f, "\t%llu", (unsigned long long)p->v[e]);
+            else                 fprintf(f, "\t-");
+        }
+        fprintf(f, "\n");
+    }
+    fclose(f);
+    if (log) fprintf(log, "[%s] PERF per-phase totals -> %s\n", pc->role, path);
+}
+
+void pc_report(PerfCounters *pc, double now, int final, FILE *log) {
+    if (pc->leader == -1 || !log) return;
+    if (final) {
+        for (int i = 0; i < pc->n_phases; ++i)
+            if (pc->total[i].laps > 0) log_phase(pc, "total ", i, &pc->total[i], log);
+        // Below 100% the PMU was shared and the group only counted part of the time
+        uint64_t en = pc->enabled - pc->enabled0, run = pc->running - pc->running0;
+        fprintf(log, "[%s] PERF group on the PMU %.1f%% of the time\n", pc->role,
+                en > 0 ? 100.0 * (double)run / (double)en : 100.0);
+        write_tsv(pc, log);
+        return;
+    }
+    if (pc->rep_start == 0.0) pc->rep_start = now;
+    if (now - pc->rep_start < PC_REPORT_SEC) return;
+    for (int i = 0; i < pc->n_phases; ++i)
+        if (pc->window[i].laps > 0) log_phase(pc, "", i, &pc->window[i], log);
+    memset(pc->window, 0, sizeof(pc->window));
+    pc->rep_start = now;
+}
+
+void pc_close(PerfCounters *pc) {
+    for (int e = 0; e < PC_EVENT_COUNT; ++e) {
+        if (pc->fd[e] != -1) close(pc->fd[e]);
+        pc->fd[e] = pc->pos[e] = -1;
+    }
+    pc->leader = -1;
+    pc->n      = 0;
+}
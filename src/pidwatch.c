@@ -0,0 +1,136 @@
+// pidwatch.c
+// Process-exit detection with pidfds (see pidwatch.h)
+// ======================================================================
+
+#define _GNU_SOURCE
+#include "headers/pidwatch.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+void pw_init(PidWatch *w) {
+    memset(w, 0, sizeof(*w));
+    for (int i = 0; i < PW_MAX; ++i) w->fd[i] = -1;
+}
+
+static int find(const PidWatch *w, const char *name) {
+    for (int i = 0; i < w->n; ++i)
+        if (w->fd[i] != -1 && strcmp(w->name[i], name) == 0) return i;
+    return -1;
+}
+
+static void drop(PidWatch *w, int i) {
+    close(w->fd[i]);
+    w->fd[i]  = -1;
+    w->pid[i] = 0;
+}
+
+void pw_remove(PidWatch *w, const char *name) {
+    int i = find(w, name);
+    if (i >= 0) drop(w, i);
+}
+
+int pw_add(PidWatch *w, const char *name, pid_t pid) {
+    int cur = find(w, name);
+    if (cur >= 0 && w->pid[cur] == pid) return 0;   // already watched
+    pw_remove(w, name);
+    if (pid <= 0) return 0;
+
+    int fd = (int)syscall(SYS_pidfd_open, pid, 0);
+    if (fd == -1) return -1;   // ESRCH: already gone, ENOSYS: no pidfds (close-on-exec by default)
+
+    int i = 0;
+    while (i < w->n && w->fd[i] != -1) ++i;
+    if (i == PW_MAX) {
+        close(fd);
+        errno = ENOSPC;
+        return -1;
+    }
+    if (i == w->n) w->n++;
+    w->name[i] = name;
+    w->pid[i]  = pid;
+    w->fd[i]   = fd;
+    return 0;
+}
+
+void pw_watch(const PidWatch *w, fd_set *set, int *maxfd) {
+    for (int i = 0; i < w->n; ++i) {
+        if (w->fd[i] == -1) continue;
+        FD_SET(w->fd[i], set);
+        if (w->fd[i] > *maxfd) *maxfd = w->fd[i];
+    }
+}
+
+int pw_next_exit(PidWatch *w, const fd_set *set, const char **name, pid_t *pid) {
+    for (int i = 0; i < w->n; ++i) {
+        if (w->fd[i] == -1) continue;
+        if (set && !FD_ISSET(w->fd[i], set)) continue;
+        // Checked again: an entry replaced since select() may reuse a ready fd number
+        struct pollfd pfd = { w->fd[i], POLLIN, 0 };
+        if (poll(&pfd, 1, 0) != 1) continue;
+        *name = w->name[i];
+        *pid  = w->pid[i];
+        drop(w, i);
+        return 0;
+    }
+    return -1;
+}
+
+static void describe(int code, int status, char *buf, size_t len) {
+    if (code == CLD_EXITED) {
+        snprintf(buf, len, "exit status %d", status);
+    } else {
+        const char *sig = sigabbrev_np(status);
+        snprintf(buf, len, "killed by SIG%s%s", sig ? sig : "?",
+                 code == CLD_DUMPED ? " (core dumped)" : "");
+    }
+}
+
+void pw_exit_reason(pid_t pid, char *buf, size_t len) {
+    // Our child: the status stays for whoever reaps it (WNOWAIT)
+    siginfo_t si;
+    memset(&si, 0, sizeof(si));
+    if (waitid(P_PID, (id_t)pid, &si, WEXITED | WNOHANG | WNOWAIT) == 0 && si.si_pid == pid) {
+        describe(si.si_code, si.si_status, buf, len);
+        return;
+    }
+
+    // Not our child: field 52 of a zombie's stat is its wait status
+    char path[64], line[1024];
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    FILE *f = fopen(path, "r");
+    if (f) {
+        char *ok = fgets(line, sizeof(line), f);
+        fclose(f);
+        char *p = ok ? strrchr(line, ')') : NULL;   // comm may contain spaces
+        int field = 2;
+        while (p && field < 52) {
+            p = strchr(p + 1, ' ');
+            field++;
+        }
+        if (p) {
+            int st = atoi(p + 1);
+            if (WIFSIGNALED(st)) describe(WCOREDUMP(st) ? CLD_DUMPED : CLD_KILLED, WTERMSIG(st), buf, len);
+            else                 describe(CLD_EXITED, WEXITSTATUS(st), buf, len);
+            return;
+        }
+    }
+    snprintf(buf, len, "exited");
+}
+
+void pw_close(PidWatch *w) {
+    for (int i = 0; i < w->n; ++i)
+        if (w->fd[i] != -1) drop(w, i);
+    w->n = 0;
+}
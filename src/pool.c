@@ -0,0 +1,512 @@
+// pool.c
+// Warm session pool (see pool.h)
+// ======================================================================
+
+#define _GNU_SOURCE
+#include "headers/pool.h"
+#include "headers/util.h"   // die(), ensure_logs_dir(), open_process_log()
+
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#define POOL_SLOTS      64   // parked + claimed worlds the daemon tracks
+#define POOL_MAX_FAILS  3    // worlds in a row ending before they park
+
+// World -> daemon (status pipe)
+typedef enum { ST_PARKED = 1, ST_CLAIMED } PoolStatusType;
+
+typedef struct {
+    int32_t type;       // PoolStatusType
+    int32_t reserved;
+    double  us;         // ST_CLAIMED: accept to release
+} PoolStatusMsg;
+
+// ---- This process ----
+static double    g_t_start   = 0.0;   // start of time to first tick
+static int       g_pooled    = 0;     // a pooled world (B or one of its components)
+static int       g_session   = 0;
+static int       g_listen_fd = -1;    // daemon's socket, accepted on by parked worlds
+static int       g_status_fd = -1;    // world -> daemon
+static int       g_conn_fd   = -1;    // claimed session
+static int       g_gate[COMP_COUNT][2];   // [0] component end, [1] B end (pooled worlds)
+static Topology *g_topo      = NULL;
+
+static double mono_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static void close_fd(int *fd) {
+    if (*fd >= 0) close(*fd);
+    *fd = -1;
+}
+
+void pool_mark_start(void) {
+    g_t_start = mono_now();
+}
+
+// ---- fd passing (SCM_RIGHTS) ----
+// Sends buf with the 3 stdio fds. 0 or -1.
+static int send_stdio(int sock, const void *buf, size_t len, const int fds[3]) {
+    char ctl[CMSG_SPACE(3 * sizeof(int))];
+    memset(ctl, 0, sizeof(ctl));
+    struct iovec  iov = { (void *)buf, len };
+    struct msghdr m;
+    memset(&m, 0, sizeof(m));
+    m.msg_iov        = &iov;
+    m.msg_iovlen     = 1;
+    m.msg_control    = ctl;
+    m.msg_controllen = sizeof(ctl);
+    struct cmsghdr *c = CMSG_FIRSTHDR(&m);
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type  = SCM_RIGHTS;
+    c->cmsg_len   = CMSG_LEN(3 * sizeof(int));
+    memcpy(CMSG_DATA(c), fds, 3 * sizeof(int));
+    return sendmsg(sock, &m, MSG_NOSIGNAL) == (ssize_t)len ? 0 : -1;
+}
+
+// Receives exactly len bytes with 3 fds. 0 or -1 (fds received anyway are closed).
+static int recv_stdio(int sock, void *buf, size_t len, int fds[3]) {
+    char ctl[CMSG_SPACE(3 * sizeof(int))];
+    struct iovec  iov = { buf, len };
+    struct msghdr m;
+    memset(&m, 0, sizeof(m));
+    m.msg_iov        = &iov;
+    m.msg_iovlen     = 1;
+    m.msg_control    = ctl;
+    m.msg_controllen = sizeof(ctl);
+    ssize_t n;
+    do n = recvmsg(sock, &m, MSG_CMSG_CLOEXEC);
+    while (n == -1 && errno == EINTR);
+
+    int got = 0;
+    struct cmsghdr *c = n > 0 ? CMSG_FIRSTHDR(&m) : NULL;
+    if (c && c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS) {
+        got = (int)((c->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        memcpy(fds, CMSG_DATA(c), (size_t)(got < 3 ? got : 3) * sizeof(int));
+    }
+    if (n == (ssize_t)len && got == 3) return 0;
+    for (int i = 0; i < got && i < 3; ++i) close(fds[i]);
+    return -1;
+}
+
+static void reply(uint32_t type, double us, int exit_status) {
+    if (g_conn_fd < 0) return;
+    PoolReplyMsg r = { POOL_MAGIC, type, (int32_t)getpid(), g_session, us, exit_status, 0 };
+    if (send(g_conn_fd, &r, sizeof(r), MSG_NOSIGNAL) != (ssize_t)sizeof(r)) close_fd(&g_conn_fd);
+}
+
+static void status(int32_t type, double us) {
+    PoolStatusMsg s = { type, 0, us };
+    if (g_status_fd >= 0 && write(g_status_fd, &s, sizeof(s)) != (ssize_t)sizeof(s)) close_fd(&g_status_fd);
+}
+
+// ----------------------------------------------------------------------
+// Pooled world
+// ----------------------------------------------------------------------
+void pool_world_init(Topology *t) {
+    if (!g_pooled) return;
+    g_topo = t;
+
+    // Own session: the claimed terminal is used without job control, and the
+    // daemon stops a parked world with one kill() to its process group
+    setsid();
+
+    // Own directory, so concurrent sessions keep their logs and sockets apart;
+    // params.txt is linked in for the SIGHUP log-level reload
+    char params_path[PATH_MAX], dir[64];
+    int have_params = realpath("params.txt", params_path) != NULL;
+    snprintf(dir, sizeof(dir), "%s/%d", POOL_SESSION_DIR, g_session);
+    mkdir(POOL_SESSION_DIR, 0755);
+    mkdir(dir, 0755);
+    if (chdir(dir) == -1) die("[POOL] chdir session dir");
+    if (have_params) {
+        unlink("params.txt");
+        if (symlink(params_path, "params.txt") == -1) perror("[POOL] symlink params.txt");
+    }
+    ensure_logs_dir();
+
+    // One gate per component: it blocks there until B forwards the terminal
+    for (int id = 0; id < COMP_COUNT; ++id) {
+        g_gate[id][0] = g_gate[id][1] = -1;
+        if (id == COMP_B) continue;
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, g_gate[id]) == -1) die("[POOL] gate socketpair");
+    }
+}
+
+void pool_park(ComponentId id) {
+    if (!g_pooled) return;
+    int thread = g_topo->comp[id].mode == RUN_THREAD;
+    if (!thread) {
+        // Keeps only its own gate end (B's ends must close when B exits)
+        for (int c = 0; c < COMP_COUNT; ++c) {
+            if (c != (int)id) close_fd(&g_gate[c][0]);
+            close_fd(&g_gate[c][1]);
+        }
+        close_fd(&g_listen_fd);
+        close_fd(&g_status_fd);
+    }
+
+    PoolClaimMsg msg;
+    int fds[3];
+    if (recv_stdio(g_gate[id][0], &msg, sizeof(msg), fds) == -1) {
+        component_exit(EXIT_SUCCESS);   // world stopped before a session claimed it
+    }
+    close_fd(&g_gate[id][0]);
+    for (int i = 0; i < 3; ++i) {
+        if (!thread) dup2(fds[i], i);   // threads share B's fds, already in place
+        if (fds[i] > 2) close(fds[i]);
+    }
+}
+
+void pool_claim(void) {
+    if (!g_pooled) return;
+
+    // Process components own their gate ends now
+    for (int id = 0; id < COMP_COUNT; ++id) {
+        if (id != COMP_B && g_topo->comp[id].mode == RUN_PROCESS) close_fd(&g_gate[id][0]);
+    }
+    status(ST_PARKED, 0.0);
+
+    // Parked: every world waits in accept(), the kernel hands each session to one
+    PoolClaimMsg msg;
+    int fds[3];
+    double t_accept;
+    for (;;) {
+        int c = accept(g_listen_fd, NULL, NULL);
+        if (c == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            die("[POOL] accept");
+        }
+        t_accept = mono_now();
+        if (recv_stdio(c, &msg, sizeof(msg), fds) == 0) {
+            if (msg.magic == POOL_MAGIC) {
+                g_conn_fd = c;
+                break;
+            }
+            for (int i = 0; i < 3; ++i) close(fds[i]);
+        }
+        close(c);   // not a session: back to waiting
+    }
+    close_fd(&g_listen_fd);
+
+    // Session's terminal on 0-2, then the same for every component
+    for (int i = 0; i < 3; ++i) dup2(fds[i], i);
+    msg.term[sizeof(msg.term) - 1] = '\0';
+    if (msg.term[0]) setenv("TERM", msg.term, 1);
+    g_t_start = msg.t_start;
+    for (int id = 0; id < COMP_COUNT; ++id) {
+        if (g_gate[id][1] < 0) continue;
+        send_stdio(g_gate[id][1], &msg, sizeof(msg), fds);
+        close_fd(&g_gate[id][1]);
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (fds[i] > 2) close(fds[i]);
+    }
+
+    double us = (mono_now() - t_accept) * 1e6;
+    status(ST_CLAIMED, us);
+    reply(POOL_CLAIMED, us, 0);
+}
+
+void pool_finish(int exit_status) {
+    if (!g_pooled) return;
+    reply(POOL_DONE, 0.0, exit_status);
+    close_fd(&g_conn_fd);
+    close_fd(&g_status_fd);
+}
+
+void pool_first_tick(FILE *log) {
+    static int done = 0;
+    if (done) return;
+    done = 1;
+    double us = (mono_now() - g_t_start) * 1e6;
+    if (log) {
+        if (g_pooled) fprintf(log, "[B] SESSION first tick %.1f ms after start (pooled world, session %d)\n",
+                              us / 1e3, g_session);
+        else          fprintf(log, "[B] SESSION first tick %.1f ms after start (cold start)\n", us / 1e3);
+        fflush(log);
+    }
+    reply(POOL_FIRST_TICK, us, 0);
+}
+
+// ----------------------------------------------------------------------
+// Daemon
+// ----------------------------------------------------------------------
+typedef enum { WS_FREE = 0, WS_STARTING, WS_PARKED, WS_CLAIMED } WorldState;
+
+typedef struct {
+    WorldState state;
+    pid_t      pid;
+    int        fd;        // status pipe, read end
+    int        id;        // session number
+    double     t_spawn;
+    double     t_parked;
+} PoolWorld;
+
+static volatile sig_atomic_t g_pool_stop = 0;
+static void on_pool_stop(int sig) { (void)sig; g_pool_stop = 1; }
+
+static void wait_reason(int st, char *buf, size_t len) {
+    if (WIFEXITED(st)) {
+        snprintf(buf, len, "exit status %d", WEXITSTATUS(st));
+    } else if (WIFSIGNALED(st)) {
+        const char *sig = sigabbrev_np(WTERMSIG(st));
+        snprintf(buf, len, "killed by SIG%s", sig ? sig : "?");
+    } else {
+        snprintf(buf, len, "status 0x%x", st);
+    }
+}
+
+static int count_parked(const PoolWorld *w) {
+    int n = 0;
+    for (int i = 0; i < POOL_SLOTS; ++i)
+        if (w[i].state == WS_STARTING || w[i].state == WS_PARKED) n++;
+    return n;
+}
+
+// Forks world `id` into a free slot. 0 or -1.
+static int spawn_world(PoolWorld *w, int id, int listen_fd, PoolWorldMain world, FILE *log) {
+    int slot = 0;
+    while (slot < POOL_SLOTS && w[slot].state != WS_FREE) ++slot;
+    if (slot == POOL_SLOTS) return -1;
+
+    int st[2];
+    if (pipe(st) == -1) return -1;
+    fflush(NULL);   // the child must not flush the daemon's buffered output again
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(st[0]);
+        close(st[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        for (int i = 0; i < POOL_SLOTS; ++i)
+            if (w[i].state != WS_FREE) close(w[i].fd);
+        close(st[0]);
+        if (log != stderr) fclose(log);
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        g_pooled    = 1;
+        g_session   = id;
+        g_listen_fd = listen_fd;
+        g_status_fd = st[1];
+        exit(world());
+    }
+    close(st[1]);
+    w[slot] = (PoolWorld){ WS_STARTING, pid, st[0], id, mono_now(), 0.0 };
+    return 0;
+}
+
+int pool_run(int k, PoolWorldMain world) {
+    if (k < 1) k = 1;
+    if (k > POOL_MAX) k = POOL_MAX;
+
+    FILE *log = open_process_log("pool", "POOL");
+    if (!log) log = stderr;
+
+    int lfd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", POOL_SOCKET_PATH);
+    unlink(POOL_SOCKET_PATH);   // stale socket from a previous pool
+    if (lfd == -1 || bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) == -1 || listen(lfd, POOL_MAX) == -1) {
+        fprintf(stderr, "[POOL] cannot listen on %s: %s\n", POOL_SOCKET_PATH, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    // No SA_RESTART: select() returns on Ctrl-C
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_pool_stop;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    fprintf(stderr, "[POOL] %d world(s) parked on %s, sessions in %s/<n>/ (Ctrl-C stops the pool)\n",
+            k, POOL_SOCKET_PATH, POOL_SESSION_DIR);
+    fprintf(log, "[POOL] pool of %d world(s) on %s | PID = %d\n", k, POOL_SOCKET_PATH, getpid());
+    fflush(log);
+
+    PoolWorld w[POOL_SLOTS];
+    memset(w, 0, sizeof(w));
+    int next_id = 1, fails = 0, status_code = EXIT_SUCCESS;
+
+    while (!g_pool_stop) {
+        // Refill in the background: parked worlds never wait on this
+        int parked = count_parked(w);
+        while (parked < k && spawn_world(w, next_id, lfd, world, log) == 0) {
+            next_id++;
+            parked++;
+        }
+
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        int maxfd = -1;
+        for (int i = 0; i < POOL_SLOTS; ++i) {
+            if (w[i].state == WS_FREE) continue;
+            FD_SET(w[i].fd, &rfds);
+            if (w[i].fd > maxfd) maxfd = w[i].fd;
+        }
+        if (select(maxfd + 1, &rfds, NULL, NULL, NULL) == -1) continue;   // EINTR
+
+        for (int i = 0; i < POOL_SLOTS; ++i) {
+            PoolWorld *p = &w[i];
+            if (p->state == WS_FREE || !FD_ISSET(p->fd, &rfds)) continue;
+            PoolStatusMsg s;
+            ssize_t n = read(p->fd, &s, sizeof(s));
+            if (n == (ssize_t)sizeof(s) && s.type == ST_PARKED) {
+                p->state    = WS_PARKED;
+                p->t_parked = mono_now();
+                fails       = 0;
+                fprintf(log, "[POOL] world #%d (pid %d) parked after %.1f ms (%d/%d parked)\n",
+                        p->id, (int)p->pid, (p->t_parked - p->t_spawn) * 1e3,
+                        count_parked(w), k);
+            } else if (n == (ssize_t)sizeof(s) && s.type == ST_CLAIMED) {
+                p->state = WS_CLAIMED;
+                fprintf(log, "[POOL] world #%d claimed after %.1f s parked, started in %.0f us, refilling\n",
+                        p->id, mono_now() - p->t_parked, s.us);
+            } else if (n <= 0) {
+                // World ended (status pipe closed): reaped here
+                int st = 0;
+                char why[64];
+                waitpid(p->pid, &st, 0);
+                wait_reason(st, why, sizeof(why));
+                fprintf(log, "[POOL] world #%d (pid %d) ended %s: %s\n", p->id, (int)p->pid,
+                        p->state == WS_CLAIMED ? "(session over)" : "before a session", why);
+                if (p->state != WS_CLAIMED && ++fails >= POOL_MAX_FAILS) {
+                    fprintf(log, "[POOL] %d world(s) in a row ended before parking, stopping\n", fails);
+                    fprintf(stderr, "[POOL] worlds keep failing to start, see logs/pool.log\n");
+                    status_code = EXIT_FAILURE;
+                    g_pool_stop = 1;
+                }
+                close(p->fd);
+                p->state = WS_FREE;
+            }
+            fflush(log);
+        }
+    }
+
+    // Parked worlds go with the pool; claimed ones are running sessions and stay
+    for (int i = 0; i < POOL_SLOTS; ++i) {
+        PoolWorld *p = &w[i];
+        if (p->state == WS_FREE) continue;
+        if (p->state == WS_CLAIMED) {
+            fprintf(log, "[POOL] world #%d (pid %d) left running its session\n", p->id, (int)p->pid);
+        } else {
+            // A world just forked by the refill may not have called setsid()
+            // yet (no group to signal): its B gets the signal directly
+            kill(-p->pid, SIGTERM);
+            kill(p->pid, SIGTERM);
+            waitpid(p->pid, NULL, 0);
+        }
+        close(p->fd);
+    }
+    close(lfd);
+    unlink(POOL_SOCKET_PATH);
+    fprintf(log, "[POOL] Exiting.\n");
+    if (log != stderr) fclose(log);
+    return status_code;
+}
+
+// ----------------------------------------------------------------------
+// Session (arp1 --attach)
+// ----------------------------------------------------------------------
+static volatile sig_atomic_t g_attach_pid = 0;
+
+// Ctrl-C and friends stop the world (its own session: the tty does not
+// signal it); resizes are passed on to B's ncurses
+static void on_attach_signal(int sig) {
+    if (g_attach_pid <= 0) return;
+    if (sig == SIGWINCH) kill(g_attach_pid, SIGWINCH);
+    else                 kill(-g_attach_pid, SIGTERM);
+}
+
+int pool_attach(void) {
+    signal(SIGPIPE, SIG_IGN);
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", POOL_SOCKET_PATH);
+
+    double t0 = mono_now();
+    if (fd == -1 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        fprintf(stderr, "[POOL] cannot reach %s: %s (start a pool with --pool <k>)\n",
+                POOL_SOCKET_PATH, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    PoolClaimMsg msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.magic   = POOL_MAGIC;
+    msg.t_start = g_t_start;
+    const char *term = getenv("TERM");
+    if (term) snprintf(msg.term, sizeof(msg.term), "%s", term);
+    const int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    if (send_stdio(fd, &msg, sizeof(msg), fds) == -1) {
+        fprintf(stderr, "[POOL] claim failed: %s\n", strerror(errno));
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_attach_signal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGHUP, &sa, NULL);
+    sigaction(SIGWINCH, &sa, NULL);
+
+    // Replies until the world is done (or gone)
+    PoolReplyMsg r;
+    int    session  = -1, pid = -1;
+    double claim_us = -1.0, tick_us = -1.0;
+    int    done = 0, world_status = EXIT_FAILURE;
+    for (;;) {
+        ssize_t n = recv(fd, &r, sizeof(r), 0);
+        if (n == -1 && errno == EINTR) continue;
+        if (n != (ssize_t)sizeof(r) || r.magic != POOL_MAGIC) break;
+        if (r.type == POOL_CLAIMED) {
+            claim_us     = (mono_now() - t0) * 1e6;
+            session      = r.session;
+            pid          = r.pid;
+            g_attach_pid = r.pid;
+        } else if (r.type == POOL_FIRST_TICK) {
+            tick_us = r.us;
+        } else if (r.type == POOL_DONE) {
+            done         = 1;
+            world_status = r.status;
+            break;
+        }
+    }
+    g_attach_pid = 0;
+    close(fd);
+
+    if (session < 0) {
+        fprintf(stderr, "[POOL] no world claimed (pool stopped?)\n");
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "[POOL] session %d (world pid %d, logs in %s/%d/logs/): claimed in %.0f us",
+            session, pid, POOL_SESSION_DIR, session, claim_us);
+    if (tick_us >= 0.0) fprintf(stderr, ", first tick %.1f ms after start", tick_us / 1e3);
+    else                fprintf(stderr, ", no tick");
+    if (done) fprintf(stderr, ", done (exit status %d)\n", world_status);
+    else      fprintf(stderr, ", world gone without finishing\n");
+    return world_status;
+}
@@ -0,0 +1,79 @@
+// render.c
+// World view drawing and frame presentation (ncurses)
+// ======================================================================
+
+#include "headers/render.h"
+
+#include <ncurses.h>
+
+static const char *k_mode_names[] = { "incremental", "full" };
+
+const char *render_mode_name(RenderMode mode) {
+    return (mode == RENDER_FULL) ? k_mode_names[1] : k_mode_names[0];
+}
+
+void render_init_colors(void) {
+    if (!has_colors()) return;   // continue without colors
+    start_color();
+
+    // Only attempt init_color if terminal supports changing colors.
+    if (can_change_color()) {
+        init_color(COLOR_YELLOW, 1000, 500, 0); // orange-ish
+        init_color(COLOR_GREEN,  0, 1000, 0);   // green
+    }
+
+    init_pair(RENDER_PAIR_OBSTACLE, COLOR_YELLOW, COLOR_BLACK);
+    init_pair(RENDER_PAIR_TARGET,   COLOR_GREEN,  COLOR_BLACK);
+    init_pair(RENDER_PAIR_WARNING,  COLOR_RED,    COLOR_BLACK);
+}
+
+// Draws one trail cell (newer parts of the trail are denser).
+static void put_trail_cell(int row, int col, int age_bucket) {
+    static const char glyph[3] = { '*', ':', '.' };
+    mvaddch(row, col, glyph[age_bucket]);
+}
+
+void render_world(const RenderRect    *area,
+                  double               world_half,
+                  const DroneStateMsg *drone,
+                  const EcsWorld      *world,
+                  const Trail         *trail)
+{
+    double scale_x = area->width  / (2.0 * world_half);   // world -> cells
+    double scale_y = area->height / (2.0 * world_half);
+    if (scale_x <= 0) scale_x = 1.0;
+    if (scale_y <= 0) scale_y = 1.0;
+
+    // Trail first, so the drone, obstacles and targets are drawn on top of it
+    if (trail) {
+        trail_render(trail, world_half,
+                     area->top, area->left, area->height, area->width, put_trail_cell);
+    }
+
+    int r, c;
+    render_cell(area, scale_x, scale_y, drone->x, drone->y, &r, &c);
+    mvaddch(r, c, '+'); // Draws drone
+
+    // Draws obstacles as 'o' in the drone world
+    const EcsArchetype *obs = &world->arch[ECS_OBSTACLE];
+    attron(COLOR_PAIR(RENDER_PAIR_OBSTACLE));
+    for (int k = 0; k < obs->n; ++k) {
+        render_cell(area, scale_x, scale_y, obs->x[k], obs->y[k], &r, &c);
+        mvaddch(r, c, 'o');
+    }
+    attroff(COLOR_PAIR(RENDER_PAIR_OBSTACLE));
+
+    const EcsArchetype *tgt = &world->arch[ECS_TARGET];
+    attron(COLOR_PAIR(RENDER_PAIR_TARGET));
+    for (int k = 0; k < tgt->n; ++k) {
+        render_cell(area, scale_x, scale_y, tgt->x[k], tgt->y[k], &r, &c);
+        mvaddch(r, c, 'T');
+    }
+    attroff(COLOR_PAIR(RENDER_PAIR_TARGET));
+}
+
+void render_present(RenderMode mode) {
+    // Full mode: forget what the terminal shows, so every cell is sent again
+    if (mode == RENDER_FULL) clearok(curscr, TRUE);
+    refresh();
+}
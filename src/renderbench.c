@@ -0,0 +1,364 @@
+// renderbench.c
+// arp1_renderbench: UI render-path benchmark
+//   - renders synthetic worlds (drone + trail, obstacles, targets) with the
+//     game's renderer (render.c) into a pseudo-terminal of a given size
+//   - a reader thread drains the pty master and counts the bytes emitted
+//   - per case: CPU time per frame (render thread), bytes per frame, frames/s
+//   - every size x density is run in each mode, so full-redraw vs incremental
+//     is one command: ./arp1_renderbench
+//   - output: tab-separated table (+ full/incremental ratios on stderr)
+// ======================================================================
+
+#define _GNU_SOURCE
+#include "headers/render.h"
+
+#include <ncurses.h>
+#include <pty.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <termios.h>
+
+#define MAX_CASES       16   // per list (sizes, densities)
+#define PANEL_WIDTH     35   // same inspection panel width as B
+#define WAVE_FRAMES     100  // new obstacle wave every n frames (like O)
+#define TARGET_FRAMES   150  // new target wave every n frames (like T)
+
+typedef struct {
+    int cols, rows;
+} TermSize;
+
+typedef struct {
+    int    frames;
+    double cpu_us_per_frame;
+    double bytes_per_frame;
+    double fps;
+} CaseResult;
+
+// Pty drain thread
+typedef struct {
+    int       fd;            // pty master
+    long      bytes;         // read so far (atomic)
+    pthread_t tid;
+} Drain;
+
+// Synthetic world
+typedef struct {
+    double        world_half;
+    DroneStateMsg drone;
+    EcsWorld      ents;           // obstacles and targets, as in B
+    TrailSet      trails;
+    unsigned int  rng;
+} BenchWorld;
+
+static double now_sec(clockid_t clk) {
+    struct timespec ts;
+    clock_gettime(clk, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static void *drain_main(void *arg) {
+    Drain *d = (Drain *)arg;
+    char buf[65536];
+    while (1) {
+        ssize_t n = read(d->fd, buf, sizeof(buf));
+        if (n > 0) {
+            __atomic_add_fetch(&d->bytes, (long)n, __ATOMIC_RELAXED);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            break;   // EIO once every slave fd is closed
+        }
+    }
+    return NULL;
+}
+
+// Waits until the reader has seen everything written so far.
+static long drain_settle(Drain *d) {
+    long last = -1;
+    int  still = 0;
+    while (still < 3) {
+        struct timespec ts = { 0, 2 * 1000 * 1000 };
+        nanosleep(&ts, NULL);
+        long now = __atomic_load_n(&d->bytes, __ATOMIC_RELAXED);
+        still = (now == last) ? still + 1 : 0;
+        last  = now;
+    }
+    return last;
+}
+
+// World
+// ----------------------------------------------------------------------
+static double frand(BenchWorld *w, double lo, double hi) {
+    return lo + (hi - lo) * ((double)rand_r(&w->rng) / (double)RAND_MAX);
+}
+
+static void world_wave(BenchWorld *w, int obstacles, int targets) {
+    double h = w->world_half * 0.9;
+    if (obstacles) {
+        EcsArchetype *o = &w->ents.arch[ECS_OBSTACLE];
+        for (int i = 0; i < o->n; ++i) {
+            o->x[i] = frand(w, -h, h);
+            o->y[i] = frand(w, -h, h);
+        }
+    }
+    if (targets) {
+        EcsArchetype *t = &w->ents.arch[ECS_TARGET];
+        for (int i = 0; i < t->n; ++i) {
+            t->x[i] = frand(w, -h, h);
+            t->y[i] = frand(w, -h, h);
+        }
+    }
+}
+
+static int world_init(BenchWorld *w, double world_half, int density) {
+    memset(w, 0, sizeof(*w));
+    w->world_half = world_half;
+    int cap[ECS_ARCH_COUNT] = { 1, density, density };
+    if (ecs_init(&w->ents, cap) != 0) return -1;
+    for (int i = 0; i < density; ++i) {
+        ecs_spawn(&w->ents, ECS_OBSTACLE);
+        ecs_spawn(&w->ents, ECS_TARGET);
+    }
+    w->rng = 12345u;   // same world for every mode
+    trail_set_init(&w->trails, 1, world_half);
+    w->trails.visible = 1;
+    world_wave(w, 1, 1);
+    return 0;
+}
+
+static void world_free(BenchWorld *w) {
+    ecs_free(&w->ents);
+}
+
+// Drone on a Lissajous path (keeps the trail and the panel numbers changing)
+static void world_step(BenchWorld *w, int frame, double dt) {
+    double t = frame * dt;
+    double a = w->world_half * 0.7;
+    DroneStateMsg s;
+    s.x  = a * sin(0.7 * t);
+    s.y  = a * sin(1.1 * t + 0.5);
+    s.vx = (s.x - w->drone.x) / dt;
+    s.vy = (s.y - w->drone.y) / dt;
+    w->drone = s;
+    trail_push(&w->trails.drone[0], s.x, s.y);
+
+    if (frame % WAVE_FRAMES   == 0) world_wave(w, 1, 0);
+    if (frame % TARGET_FRAMES == 0) world_wave(w, 0, 1);
+}
+
+// One frame with B's layout: border, top lines, world, inspection panel
+static void bench_frame(const BenchWorld *w, int frame, RenderMode mode) {
+    int max_y, max_x;
+    getmaxyx(stdscr, max_y, max_x);
+
+    erase();
+    box(stdscr, 0, 0);
+    mvprintw(1, 2, "Controls: w e r / s d f / x c v | d=brake, p=pause, O=reset, t=trail, q=quit");
+    mvprintw(2, 2, "Paused: NO   frame %d", frame);
+    for (int x = 1; x < max_x - 1; ++x) mvaddch(3, x, '-');
+
+    int insp_x  = max_x - PANEL_WIDTH;
+    int world_h = max_y - 2 - 4 + 1;
+    for (int y = 4; y <= max_y - 2; ++y) mvaddch(y, insp_x - 1, '|');
+
+    RenderRect area = { 4, 1, world_h, insp_x - 2 };
+    render_world(&area, w->world_half, &w->drone, &w->ents, &w->trails.drone[0]);
+
+    int ix = insp_x + 1;
+    mvprintw(4,  ix, "INSPECTION");
+    mvprintw(11, ix, "x  = %.2f", w->drone.x);
+    mvprintw(12, ix, "y  = %.2f", w->drone.y);
+    mvprintw(13, ix, "vx = %.2f", w->drone.vx);
+    mvprintw(14, ix, "vy = %.2f", w->drone.vy);
+    mvprintw(20, ix, "Trail: on %d/%d pts", trail_points(&w->trails.drone[0]),
+             w->trails.drone[0].capacity);
+
+    render_present(mode);
+}
+
+// One benchmark case
+// ----------------------------------------------------------------------
+static int run_case(const char *term, TermSize size, int density, RenderMode mode,
+                    int frames, const SimParams *p, CaseResult *res) {
+    int master, slave;
+    struct winsize ws = { (unsigned short)size.rows, (unsigned short)size.cols, 0, 0 };
+    if (openpty(&master, &slave, NULL, NULL, &ws) == -1) {
+        perror("[RBENCH] openpty");
+        return -1;
+    }
+    // Raw slave: bytes reach the master exactly as ncurses wrote them
+    struct termios tio;
+    if (tcgetattr(slave, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(slave, TCSANOW, &tio);
+    }
+
+    Drain drain = { .fd = master, .bytes = 0 };
+    if (pthread_create(&drain.tid, NULL, drain_main, &drain) != 0) {
+        perror("[RBENCH] pthread_create");
+        close(master);
+        close(slave);
+        return -1;
+    }
+
+    FILE *out = fdopen(slave, "w");
+    FILE *in  = fdopen(dup(slave), "r");
+    SCREEN *scr = (out && in) ? newterm(term, out, in) : NULL;
+    if (!scr) {
+        fprintf(stderr, "[RBENCH] newterm(%s) failed\n", term);
+        if (out) fclose(out); else close(slave);
+        if (in)  fclose(in);
+        pthread_join(drain.tid, NULL);
+        close(master);
+        return -1;
+    }
+    set_term(scr);
+    noecho();
+    curs_set(0);
+    render_init_colors();
+
+    BenchWorld w;
+    if (world_init(&w, p->world_half, density) != 0) {
+        perror("[RBENCH] calloc");
+        exit(EXIT_FAILURE);
+    }
+
+    // Warm-up frame (initial clear screen) is not counted
+    world_step(&w, 0, p->dt);
+    bench_frame(&w, 0, mode);
+    long b0 = drain_settle(&drain);
+
+    double cpu0  = now_sec(CLOCK_THREAD_CPUTIME_ID);
+    double wall0 = now_sec(CLOCK_MONOTONIC);
+    for (int f = 1; f <= frames; ++f) {
+        world_step(&w, f, p->dt);
+        bench_frame(&w, f, mode);
+    }
+    double cpu  = now_sec(CLOCK_THREAD_CPUTIME_ID) - cpu0;
+    double wall = now_sec(CLOCK_MONOTONIC) - wall0;
+    long   bytes = drain_settle(&drain) - b0;
+
+    endwin();
+    delscreen(scr);
+    fclose(out);
+    fclose(in);
+    pthread_join(drain.tid, NULL);
+    close(master);
+    world_free(&w);
+
+    res->frames           = frames;
+    res->cpu_us_per_frame = 1e6 * cpu / frames;
+    res->bytes_per_frame  = (double)bytes / frames;
+    res->fps              = (wall > 0.0) ? frames / wall : 0.0;
+    return 0;
+}
+
+// Options
+// ----------------------------------------------------------------------
+static int parse_sizes(const char *arg, TermSize *sizes) {
+    int n = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    for (char *tok = strtok(buf, ","); tok && n < MAX_CASES; tok = strtok(NULL, ",")) {
+        TermSize s;
+        if (sscanf(tok, "%dx%d", &s.cols, &s.rows) == 2 && s.cols >= 60 && s.rows >= 24) {
+            sizes[n++] = s;
+        } else {
+            fprintf(stderr, "[RBENCH] size '%s' ignored (COLSxROWS, at least 60x24)\n", tok);
+        }
+    }
+    return n;
+}
+
+static int parse_ints(const char *arg, int *vals) {
+    int n = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    for (char *tok = strtok(buf, ","); tok && n < MAX_CASES; tok = strtok(NULL, ",")) {
+        vals[n++] = atoi(tok);
+    }
+    return n;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-f frames] [-s COLSxROWS,...] [-d density,...] [-m full|incremental|both]\n"
+            "          [-t term] [-o results.tsv]\n"
+            "  density = obstacles and targets each (defaults: 80x24,120x40,200x60; 12,100,1000)\n"
+            "  Rows are tab-separated; full/incremental ratios go to stderr.\n",
+            prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv) {
+    int         frames   = 300;
+    const char *mode_arg = "both";
+    const char *term     = "xterm-256color";
+    const char *out_path = NULL;
+    TermSize    sizes[MAX_CASES];
+    int         densities[MAX_CASES];
+    int         n_sizes     = parse_sizes("80x24,120x40,200x60", sizes);
+    int         n_densities = parse_ints("12,100,1000", densities);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:s:d:m:t:o:h")) != -1) {
+        switch (opt) {
+            case 'f': frames = atoi(optarg); break;
+            case 's': n_sizes = parse_sizes(optarg, sizes); break;
+            case 'd': n_densities = parse_ints(optarg, densities); break;
+            case 'm': mode_arg = optarg; break;
+            case 't': term = optarg; break;
+            case 'o': out_path = optarg; break;
+            default:  usage(argv[0]);
+        }
+    }
+    if (frames < 1 || n_sizes == 0 || n_densities == 0) usage(argv[0]);
+
+    RenderMode modes[2];
+    int n_modes = 0;
+    if (strcmp(mode_arg, "incremental") == 0 || strcmp(mode_arg, "both") == 0) modes[n_modes++] = RENDER_INCREMENTAL;
+    if (strcmp(mode_arg, "full")        == 0 || strcmp(mode_arg, "both") == 0) modes[n_modes++] = RENDER_FULL;
+    if (n_modes == 0) usage(argv[0]);
+
+    // Same world scale as the game
+    SimParams params;
+    init_default_params(&params);
+    load_params_from_file("params.txt", &params);
+
+    FILE *out = stdout;
+    if (out_path && !(out = fopen(out_path, "w"))) {
+        perror("[RBENCH] open output");
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "mode\tcols\trows\tdensity\tframes\tcpu_us_per_frame\tbytes_per_frame\tfps\n");
+    for (int si = 0; si < n_sizes; ++si) {
+        for (int di = 0; di < n_densities; ++di) {
+            CaseResult r[2];
+            for (int mi = 0; mi < n_modes; ++mi) {
+                if (run_case(term, sizes[si], densities[di], modes[mi], frames, &params, &r[mi]) != 0) {
+                    return EXIT_FAILURE;
+                }
+                fprintf(out, "%s\t%d\t%d\t%d\t%d\t%.1f\t%.0f\t%.0f\n",
+                        render_mode_name(modes[mi]), sizes[si].cols, sizes[si].rows,
+                        densities[di], r[mi].frames, r[mi].cpu_us_per_frame,
+                        r[mi].bytes_per_frame, r[mi].fps);
+                fflush(out);
+            }
+            if (n_modes == 2 && r[0].bytes_per_frame > 0.0 && r[0].cpu_us_per_frame > 0.0) {
+                fprintf(stderr, "[RBENCH] %dx%d density %d: full/incremental bytes x%.1f, cpu x%.1f\n",
+                        sizes[si].cols, sizes[si].rows, densities[di],
+                        r[1].bytes_per_frame / r[0].bytes_per_frame,
+                        r[1].cpu_us_per_frame / r[0].cpu_us_per_frame);
+            }
+        }
+    }
+    if (out != stdout) fclose(out);
+    return EXIT_SUCCESS;
+}
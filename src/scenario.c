@@ -0,0 +1,293 @@
+// scenario.c
+// Loads and validates scenario files (mmap'ed, parsed once at startup)
+//
+// Format: one directive per line, '#' starts a comment. Times are D ticks.
+//   name     <word>
+//   seed     <n>                          (seeds O and T if they still generate)
+//   drone    <x> <y> <vx> <vy>            (initial drone state)
+//   param    <key> <value>                (same keys as params.txt)
+//   obstacle <tick> <x> <y> <life_steps>  (same tick = same wave)
+//   target   <tick> <x> <y> <life_steps>
+//   key      <tick> <char>                (scripted key press)
+//   fault    <tick> <name> <value>        (fault injection, see faults.h)
+//   end      <tick>                       (B stops and checks expectations)
+//   expect   <score|collected> <>=|<=|==> <value>
+// ======================================================================
+
+#include "headers/scenario.h"
+#include "headers/util.h"
+#include "headers/faults.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static Scenario g_scenario;
+
+// Reports a scenario error with its location and stops the program.
+static void scn_fail(const char *path, int line, const char *msg) {
+    if (line > 0) fprintf(stderr, "[SCENARIO] %s:%d: %s\n", path, line, msg);
+    else          fprintf(stderr, "[SCENARIO] %s: %s\n", path, msg);
+    exit(EXIT_FAILURE);
+}
+
+// Appends one spawn to the wave list of its kind (new wave when the tick changes).
+// ----------------------------------------------------------------------
+static void add_obstacle(Scenario *s, int tick, double x, double y, int life,
+                         const char *path, int line) {
+    ScnObstacleWave *w = NULL;
+    if (s->n_obstacle_waves > 0) {
+        w = &s->obstacle_waves[s->n_obstacle_waves - 1];
+        if (tick < w->tick) scn_fail(path, line, "obstacle ticks must be non-decreasing");
+        if (tick != w->tick) w = NULL;
+    }
+    if (!w) {
+        if (s->n_obstacle_waves >= SCN_MAX_WAVES) scn_fail(path, line, "too many obstacle waves");
+        w = &s->obstacle_waves[s->n_obstacle_waves++];
+        memset(w, 0, sizeof(*w));
+        w->tick = tick;
+    }
+    if (w->set.count >= MAX_OBSTACLES) scn_fail(path, line, "too many obstacles in one wave");
+
+    ObstacleSpec *o = &w->set.obs[w->set.count++];
+    o->x = x;
+    o->y = y;
+    o->life_steps = life;
+}
+
+static void add_target(Scenario *s, int tick, double x, double y, int life,
+                       const char *path, int line) {
+    ScnTargetWave *w = NULL;
+    if (s->n_target_waves > 0) {
+        w = &s->target_waves[s->n_target_waves - 1];
+        if (tick < w->tick) scn_fail(path, line, "target ticks must be non-decreasing");
+        if (tick != w->tick) w = NULL;
+    }
+    if (!w) {
+        if (s->n_target_waves >= SCN_MAX_WAVES) scn_fail(path, line, "too many target waves");
+        w = &s->target_waves[s->n_target_waves++];
+        memset(w, 0, sizeof(*w));
+        w->tick = tick;
+    }
+    if (w->set.count >= MAX_TARGETS) scn_fail(path, line, "too many targets in one wave");
+
+    TargetSpec *t = &w->set.tgt[w->set.count++];
+    t->x = x;
+    t->y = y;
+    t->life_steps = life;
+}
+
+// Parses one (already NUL-terminated, comment-stripped) line.
+// ----------------------------------------------------------------------
+static void parse_line(Scenario *s, SimParams *params, char *ln, const char *path, int line) {
+    char cmd[32];
+    int  used = 0;
+    if (sscanf(ln, " %31s%n", cmd, &used) != 1) return;   // blank line
+    const char *rest = ln + used;
+
+    if (strcmp(cmd, "name") == 0) {
+        if (sscanf(rest, " %63s", s->name) != 1) scn_fail(path, line, "name needs a value");
+    }
+    else if (strcmp(cmd, "seed") == 0) {
+        if (sscanf(rest, " %u", &s->seed) != 1) scn_fail(path, line, "seed needs an integer");
+        s->has_seed = 1;
+    }
+    else if (strcmp(cmd, "drone") == 0) {
+        DroneStateMsg d;
+        if (sscanf(rest, " %lf %lf %lf %lf", &d.x, &d.y, &d.vx, &d.vy) != 4)
+            scn_fail(path, line, "drone needs: x y vx vy");
+        s->drone = d;
+        s->has_drone = 1;
+    }
+    else if (strcmp(cmd, "param") == 0) {
+        char key[64];
+        double val;
+        if (sscanf(rest, " %63s %lf", key, &val) != 2) scn_fail(path, line, "param needs: key value");
+        if (set_param_by_name(params, key, val) != 0) scn_fail(path, line, "unknown param key");
+    }
+    else if (strcmp(cmd, "obstacle") == 0 || strcmp(cmd, "target") == 0) {
+        int tick, life;
+        double x, y;
+        if (sscanf(rest, " %d %lf %lf %d", &tick, &x, &y, &life) != 4)
+            scn_fail(path, line, "spawn needs: tick x y life_steps");
+        if (tick < 0)  scn_fail(path, line, "tick must be >= 0");
+        if (life <= 0) scn_fail(path, line, "life_steps must be > 0");
+        if (cmd[0] == 'o') add_obstacle(s, tick, x, y, life, path, line);
+        else               add_target(s, tick, x, y, life, path, line);
+    }
+    else if (strcmp(cmd, "key") == 0) {
+        int  tick;
+        char k;
+        if (sscanf(rest, " %d %c", &tick, &k) != 2) scn_fail(path, line, "key needs: tick char");
+        if (tick < 0) scn_fail(path, line, "tick must be >= 0");
+        if (s->n_keys > 0 && tick < s->keys[s->n_keys - 1].tick)
+            scn_fail(path, line, "key ticks must be non-decreasing");
+        if (s->n_keys >= SCN_MAX_KEYS) scn_fail(path, line, "too many scripted keys");
+        s->keys[s->n_keys].tick = tick;
+        s->keys[s->n_keys].key  = k;
+        s->n_keys++;
+    }
+    else if (strcmp(cmd, "fault") == 0) {
+        int    tick;
+        char   name[32];
+        double value;
+        if (sscanf(rest, " %d %31s %lf", &tick, name, &value) != 3)
+            scn_fail(path, line, "fault needs: tick name value");
+        if (tick < 0) scn_fail(path, line, "tick must be >= 0");
+        int id = fault_from_name(name);
+        if (id < 0) scn_fail(path, line, "unknown fault name (see faults.h)");
+        if (s->n_faults > 0 && tick < s->faults[s->n_faults - 1].tick)
+            scn_fail(path, line, "fault ticks must be non-decreasing");
+        if (s->n_faults >= SCN_MAX_FAULTS) scn_fail(path, line, "too many faults");
+        s->faults[s->n_faults++] = (ScnFault){ tick, id, value };
+    }
+    else if (strcmp(cmd, "end") == 0) {
+        if (sscanf(rest, " %d", &s->end_tick) != 1 || s->end_tick <= 0)
+            scn_fail(path, line, "end needs a positive tick");
+    }
+    else if (strcmp(cmd, "expect") == 0) {
+        char metric[32], op[4];
+        int  value;
+        if (sscanf(rest, " %31s %3s %d", metric, op, &value) != 3)
+            scn_fail(path, line, "expect needs: metric op value");
+        if (s->n_expects >= SCN_MAX_EXPECTS) scn_fail(path, line, "too many expectations");
+
+        ScnExpect *e = &s->expects[s->n_expects];
+        if      (strcmp(metric, "score")     == 0) e->metric = SCN_METRIC_SCORE;
+        else if (strcmp(metric, "collected") == 0) e->metric = SCN_METRIC_COLLECTED;
+        else scn_fail(path, line, "unknown metric (score, collected)");
+
+        if      (strcmp(op, ">=") == 0) e->op = SCN_OP_GE;
+        else if (strcmp(op, "<=") == 0) e->op = SCN_OP_LE;
+        else if (strcmp(op, "==") == 0) e->op = SCN_OP_EQ;
+        else scn_fail(path, line, "unknown operator (>=, <=, ==)");
+
+        e->value = value;
+        s->n_expects++;
+    }
+    else {
+        scn_fail(path, line, "unknown directive");
+    }
+}
+
+// Checks the whole scenario once every line (and every param override) is known.
+// ----------------------------------------------------------------------
+static void validate(const Scenario *s, const SimParams *p) {
+    const char *path = s->path;
+    double wh = p->world_half;
+
+    if (p->mass <= 0.0 || p->dt <= 0.0 || wh <= 0.0)
+        scn_fail(path, 0, "mass, dt and world_half must be > 0 after overrides");
+
+    if (s->has_drone && (s->drone.x <= -wh || s->drone.x >= wh ||
+                         s->drone.y <= -wh || s->drone.y >= wh))
+        scn_fail(path, 0, "initial drone position is outside the world");
+
+    for (int w = 0; w < s->n_obstacle_waves; ++w) {
+        const ObstacleSetMsg *set = &s->obstacle_waves[w].set;
+        for (int i = 0; i < set->count; ++i) {
+            if (set->obs[i].x <= -wh || set->obs[i].x >= wh ||
+                set->obs[i].y <= -wh || set->obs[i].y >= wh)
+                scn_fail(path, 0, "obstacle outside the world");
+        }
+    }
+    for (int w = 0; w < s->n_target_waves; ++w) {
+        const TargetSetMsg *set = &s->target_waves[w].set;
+        for (int i = 0; i < set->count; ++i) {
+            if (set->tgt[i].x <= -wh || set->tgt[i].x >= wh ||
+                set->tgt[i].y <= -wh || set->tgt[i].y >= wh)
+                scn_fail(path, 0, "target outside the world");
+        }
+    }
+
+    if (s->n_expects > 0 && s->end_tick <= 0)
+        scn_fail(path, 0, "expect requires an 'end <tick>' directive");
+}
+
+// Public API
+// ----------------------------------------------------------------------
+void scenario_load(const char *path, SimParams *params) {
+    Scenario *s = &g_scenario;
+    memset(s, 0, sizeof(*s));
+    snprintf(s->path, sizeof(s->path), "%s", path);
+    snprintf(s->name, sizeof(s->name), "unnamed");
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) die("[SCENARIO] open");
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) die("[SCENARIO] fstat");
+    if (st.st_size == 0) scn_fail(path, 0, "empty file");
+
+    const char *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) die("[SCENARIO] mmap");
+    close(fd);
+
+    // Walks the mapping line by line (the mapping itself is never modified)
+    size_t off  = 0;
+    size_t size = (size_t)st.st_size;
+    int    line = 0;
+    while (off < size) {
+        const char *start = map + off;
+        const char *nl    = memchr(start, '\n', size - off);
+        size_t len = nl ? (size_t)(nl - start) : size - off;
+        off += len + (nl ? 1 : 0);
+        line++;
+
+        char buf[256];
+        if (len >= sizeof(buf)) scn_fail(path, line, "line too long");
+        memcpy(buf, start, len);
+        buf[len] = '\0';
+
+        char *hash = strchr(buf, '#');
+        if (hash) *hash = '\0';
+
+        parse_line(s, params, buf, path, line);
+    }
+    munmap((void *)map, size);
+
+    validate(s, params);
+    s->loaded = 1;
+
+    fprintf(stderr,
+            "[SCENARIO] Loaded '%s' from %s: %d obstacle wave(s), %d target wave(s), "
+            "%d key(s), %d fault(s), end=%d, %d expectation(s)\n",
+            s->name, path, s->n_obstacle_waves, s->n_target_waves,
+            s->n_keys, s->n_faults, s->end_tick, s->n_expects);
+    if (s->n_faults > 0 && !fault_compiled_in())
+        fprintf(stderr, "[SCENARIO] fault lines are ignored: build with make FAULTS=1\n");
+}
+
+const Scenario *scenario_active(void) {
+    return g_scenario.loaded ? &g_scenario : NULL;
+}
+
+int scenario_check_expects(const Scenario *scn, int score, int collected, FILE *log) {
+    static const char *metric_names[] = { "score", "collected" };
+    static const char *op_names[]     = { ">=", "<=", "==" };
+
+    int all_ok = 1;
+    for (int i = 0; i < scn->n_expects; ++i) {
+        const ScnExpect *e = &scn->expects[i];
+        int actual = (e->metric == SCN_METRIC_SCORE) ? score : collected;
+
+        int ok;
+        switch (e->op) {
+            case SCN_OP_GE: ok = actual >= e->value; break;
+            case SCN_OP_LE: ok = actual <= e->value; break;
+            default:        ok = actual == e->value; break;
+        }
+        if (!ok) all_ok = 0;
+
+        if (log) {
+            fprintf(log, "[SCENARIO] expect %s %s %d: actual=%d -> %s\n",
+                    metric_names[e->metric], op_names[e->op], e->value,
+                    actual, ok ? "PASS" : "FAIL");
+        }
+    }
+    return all_ok;
+}
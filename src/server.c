@@ -19,7 +19,30 @@
 #include "headers/util.h"
 #include "headers/obstacles.h"
 #include "headers/targets.h"
+#include "headers/iobatch.h"
+#include "headers/scenario.h"
+#include "headers/soak.h"
+#include "headers/trail.h"
+#include "headers/telemetry.h"
+#include "headers/standby.h"
+#include "headers/channel.h"
+#include "headers/render.h"
+#include "headers/ctrl.h"
+#include "headers/worldhash.h"
+#include "headers/mpc.h"
+#include "headers/logcat.h"
+#include "headers/faults.h"
+#include "headers/vclock.h"
+#include "headers/neighbors.h"
+#include "headers/arena.h"
+#include "headers/alloccheck.h"
+#include "headers/perfctr.h"
+#include "headers/pidwatch.h"
+#include "headers/pool.h"
+#include "headers/ecs.h"
+#include <fcntl.h>
 #include <time.h>   // clock_gettime
+#include <sys/wait.h>   // waitpid
 
 
 #include <ncurses.h>
@@ -47,8 +70,92 @@ static int  wd_blink_counter = 0;   // counts simulation steps
 
 static int wd_blink_ticks = 0;
 
-// ---- Heartbeat timing ----
-static struct timespec g_last_hb_ts;
+// ---- Scenario replay cursors (only used when a scenario is loaded) ----
+static int g_scn_tick     = 0;   // D ticks received since start (paused ticks included)
+static int g_scn_obs_next = 0;   // next obstacle wave to install
+static int g_scn_tgt_next = 0;   // next target wave to install
+static int g_scn_key_next = 0;   // next scripted key to apply
+static int g_scn_flt_next = 0;   // next scripted fault to set
+static int g_scn_finished = 0;   // 1 once the 'end' tick was reached
+
+// ---- Output batching (io_uring or plain syscalls) ----
+static IoBatch g_iob;
+#define IOSTAT_WINDOW_TICKS 200   // ticks per IOSTAT log line
+
+// ---- Trajectory trails (one per drone; B owns a single drone today) ----
+static TrailSet g_trails;
+
+// ---- Telemetry recording (one row per D tick) ----
+static TlmWriter g_tlm = { .fd = -1, .pyr_fd = -1 };
+static double    g_tlm_last_state = 0.0;   // wall time of the previous D state
+static float     g_tlm_input_ms   = -1.0f; // oldest key batch age since the previous row
+static int32_t   g_tlm_tick       = 0;
+
+// ---- Hot-standby D (only used with standby_d = 1) ----
+static Standby g_sb = { .pid = -1, .fd_force = -1, .fd_state = -1 };
+
+// External controllers (ctrl.h); owner != -1 means the keyboard does not steer
+static CtrlServer g_ctrl = { .listen_fd = -1, .owner = -1 };
+
+// Sampling MPC autopilot (key 'a')
+static Mpc g_mpc;
+
+// World hash: entity slots are re-hashed where they change, the rest per tick
+static WorldHash g_wh;
+
+// Neighbor lists: obstacles near enough to repel, targets near enough to hit
+static NbrList g_nbr_obs;
+static NbrList g_nbr_tgt;
+
+// Obstacles and targets (ecs.h): one drone mirrors D's state; repulse runs at
+// force sends, hit and age every running tick
+static EcsWorld  g_world;
+static EcsId     g_drone;
+static EcsSimCtx g_sim;
+static EcsSched  g_sched;
+
+// ---- Hardware counters per loop phase (perf_counters = 1) ----
+enum { BPH_WAIT, BPH_INPUT, BPH_STATE, BPH_GEN, BPH_RENDER, BPH_FORCE, BPH_IO, BPH_COUNT };
+static const char *const k_b_phases[BPH_COUNT] = {
+    "wait", "input", "state", "generators", "render", "force", "io",
+};
+static PerfCounters g_pc;
+
+// Per-tick scratch (reset at the top of every loop iteration) and allocation check
+#define TICK_ARENA_BYTES (64 * 1024)
+static Arena     g_tick_arena;
+static AllocTick g_alloc_tick;
+static double  g_primary_last  = 0.0;   // wall time of the last primary D state
+
+// ---- Child exits (pidfds): D is replaced, W restarted, the rest logged ----
+static PidWatch g_pw;
+static int      g_w_restarts = 0;
+static long    g_primary_ticks = 0;
+
+// Force commands to D: computed at most once per tick, sent only on change,
+// reset or keepalive (D holds the last command)
+static ForceStateMsg g_force_last;               // last command sent (total force)
+static int         g_force_have_last   = 0;      // 0 = next command goes out unconditionally
+static const char *g_force_reason      = NULL;   // pending request, NULL = none
+static int         g_force_reset       = 0;      // pending FORCE_RESET
+static int         g_force_sent_tick   = 0;      // 1 once a command went out in this D tick
+static long        g_force_idle_ticks  = 0;      // D ticks since the last send
+static long        g_force_sent        = 0;      // current 1 s window
+static long        g_force_suppressed  = 0;
+static double      g_force_window_start = 0.0;
+static double      g_force_sent_rate   = 0.0;    // last window, per second
+static double      g_force_supp_rate   = 0.0;
+
+// Generator channels (O, T): open / draining / closed / restarting
+static PeerChannel g_chan_obs;
+static PeerChannel g_chan_tgt;
+#define STANDBY_MIN_DEADLINE_SEC 0.005  // floor for very high time scales (scheduler jitter)
+
+// ---- Soak mode (headless, accelerated time) ----
+static SoakMonitor g_soak;
+
+// ---- Heartbeat timing (component clock, see vclock.h) ----
+static double g_last_hb = 0.0;
 static int g_have_hb = 0; // becomes 1 after first heartbeat timestamp is recorded
 
 static double monotonic_now_sec(void) {
@@ -58,17 +165,245 @@ static double monotonic_now_sec(void) {
 }
 
 static void set_last_hb_now(void) {
-    clock_gettime(CLOCK_MONOTONIC, &g_last_hb_ts);
+    g_last_hb = clock_now();
     g_have_hb = 1;
 }
 
 static double hb_age_sec(void) {
     if (!g_have_hb) return 0.0;
-    double now = monotonic_now_sec();
-    double last = (double)g_last_hb_ts.tv_sec + 1e-9 * (double)g_last_hb_ts.tv_nsec;
-    return now - last;
+    return clock_now() - g_last_hb;
 }
 
+// Entity slots (ECS_SLOT): the world hash and scenario waves address obstacles
+// and targets by slot. A filled slot keeps its entity (and row) until it
+// empties, so rows only move when a slot hash changes (neighbor lists rely on it).
+// ----------------------------------------------------------------------
+static int slot_row(const EcsArchetype *a, int slot) {
+    for (int r = 0; r < a->n; ++r)
+        if (a->slot[r] == slot) return r;
+    return -1;
+}
+
+static void put_slot(EcsArch k, int slot, double x, double y, int life_steps) {
+    EcsArchetype *a = &g_world.arch[k];
+    int r = slot_row(a, slot);
+    if (r < 0) {
+        r = ecs_row(&g_world, ecs_spawn(&g_world, k), NULL);
+        if (r < 0) return;   // full: cannot happen with one entity per slot
+        a->slot[r] = slot;
+    }
+    a->x[r]    = x;
+    a->y[r]    = y;
+    a->life[r] = life_steps;
+}
+
+// Empties slot `first` and every slot after it.
+static void clear_slots_from(EcsArch k, int first) {
+    EcsArchetype *a = &g_world.arch[k];
+    for (int r = a->n - 1; r >= 0; --r)   // the row moved into r was already seen
+        if (a->slot[r] >= first) ecs_destroy(&g_world, a->id[r]);
+}
+
+// Re-hashes every slot of an archetype (empty slots count as inactive).
+static void rehash_slots(EcsArch k) {
+    const EcsArchetype *a = &g_world.arch[k];
+    int n_slots = (k == ECS_OBSTACLE) ? NUM_OBSTACLES : NUM_TARGETS;
+    for (int i = 0; i < n_slots; ++i) {
+        int    r = slot_row(a, i);
+        double x = (r >= 0) ? a->x[r] : 0.0;
+        double y = (r >= 0) ? a->y[r] : 0.0;
+        if (k == ECS_OBSTACLE) wh_set_obstacle(&g_wh, i, x, y, r >= 0);
+        else                   wh_set_target(&g_wh, i, x, y, r >= 0);
+    }
+}
+
+// B's drone entity mirrors the last state from D.
+static void world_set_drone(const DroneStateMsg *s) {
+    EcsArchetype *d = &g_world.arch[ECS_DRONE];
+    int r = ecs_row(&g_world, g_drone, NULL);
+    d->x[r]  = s->x;
+    d->y[r]  = s->y;
+    d->vx[r] = s->vx;
+    d->vy[r] = s->vy;
+}
+
+// Asks for a force update; the command is decided at the end of the loop
+// iteration by flush_force(). The latest reason wins; a reset is never lost.
+// ----------------------------------------------------------------------
+static void request_force(const ForceStateMsg *user_force, const char *reason)
+{
+    g_force_reason = reason;
+    if (user_force->reset == FORCE_RESET) g_force_reset = 1;
+}
+
+// Computes the total command (once) and sends it to D and the replica if it
+// changed beyond force_epsilon, carries a reset, or the keepalive is due.
+// At most one command per D tick: later requests wait for the next state.
+// ----------------------------------------------------------------------
+static void flush_force(const ForceStateMsg *user_force,
+                        const DroneStateMsg *cur_state,
+                        const SimParams     *params,
+                        int                  fd_to_d)
+{
+    if (!g_force_reason) return;
+    if (g_force_sent_tick && !g_force_reset) return;
+
+    // Only obstacles inside the repulsion radius contribute: repel from the neighbor list
+    const EcsArchetype *o = &g_world.arch[ECS_OBSTACLE];
+    g_sim.params     = params;
+    g_sim.obs_rows   = g_nbr_obs.idx;
+    g_sim.n_obs_rows = nbr_query(&g_nbr_obs, cur_state->x, cur_state->y,
+                                 params->world_half * OBS_CLEARANCE_FRAC, params->nbr_skin,
+                                 o->x, o->y, o->n, g_wh.group[WH_OBSTACLES]);
+    world_set_drone(cur_state);
+    ecs_sys_repulse(&g_world, &g_sim);   // no commanded force: f is the obstacle field
+    const EcsArchetype *d = &g_world.arch[ECS_DRONE];
+    int dr = ecs_row(&g_world, g_drone, NULL);
+
+    char detail[128];
+    ForceStateMsg out = compute_total_force(user_force, d->fx[dr], d->fy[dr], params,
+                                            detail, sizeof(detail));
+    out.reset = g_force_reset ? FORCE_RESET : FORCE_NORMAL;
+
+    const char *why = NULL;
+    if (!g_force_have_last || g_force_reset) {
+        why = g_force_reason;
+    } else if (fabs(out.Fx - g_force_last.Fx) > params->force_epsilon ||
+               fabs(out.Fy - g_force_last.Fy) > params->force_epsilon) {
+        why = g_force_reason;
+    } else if (g_force_idle_ticks * params->dt >= params->force_keepalive_sec) {
+        why = "keepalive";
+    }
+    g_force_reason = NULL;
+
+    if (!why) {
+        g_force_suppressed++;
+        LOGC(LOGC_FORCE, LOGL_TRACE, 0, "FORCE held: Fx=%.2f Fy=%.2f within %.2fN of the last send\n",
+             out.Fx, out.Fy, params->force_epsilon);
+        return;
+    }
+
+    if (FAULT_CHANCE(FLT_FORCE_DROP)) {
+        // Injected: lost on the way; B carries on as if D had it
+        LOGC(LOGC_FORCE, LOGL_DEBUG, 0, "SEND_FORCE (%s): dropped by fault injection\n", why);
+    } else if (iob_write(&g_iob, fd_to_d, &out, sizeof(out)) == -1) {
+        perror("[B] write to D failed");
+    } else {
+        LOGC(LOGC_FORCE, LOGL_DEBUG, 0, "SEND_FORCE (%s): userFx=%.2f userFy=%.2f, %s => Fx=%.2f Fy=%.2f\n",
+             why, user_force->Fx, user_force->Fy, detail, out.Fx, out.Fy);
+        if (FAULT_CHANCE(FLT_FORCE_DUP)) iob_write(&g_iob, fd_to_d, &out, sizeof(out));
+    }
+    if (g_sb.pid > 0) {
+        // Same stream for the replica (logged once, above)
+        iob_write(&g_iob, g_sb.fd_force, &out, sizeof(out));
+    }
+
+    g_force_last       = out;
+    g_force_last.reset = FORCE_NORMAL;
+    g_force_have_last  = 1;
+    g_force_reset      = 0;
+    g_force_sent_tick  = 1;
+    g_force_idle_ticks = 0;
+    g_force_sent++;
+}
+
+// Injected terminal throttle: at most term_fps frames per second are drawn.
+static int frame_due(double now) {
+    static double last_frame = 0.0;
+    double fps = FAULT_VALUE(FLT_TERM_FPS);
+    if (fps > 0.0 && now - last_frame < 1.0 / fps) {
+        FAULT_HIT(FLT_TERM_FPS);
+        return 0;
+    }
+    last_frame = now;
+    return 1;
+}
+
+// Starts a new D tick for the force gate.
+static void force_on_tick(void) {
+    g_force_sent_tick = 0;
+    g_force_idle_ticks++;
+}
+
+// Publishes sent/suppressed commands per second (log + inspection panel).
+static void force_report(double now, FILE *logfile) {
+    double elapsed = now - g_force_window_start;
+    if (elapsed < 1.0) return;
+    g_force_sent_rate = (double)g_force_sent       / elapsed;
+    g_force_supp_rate = (double)g_force_suppressed / elapsed;
+    fprintf(logfile, "[B] FORCE sent=%.1f/s suppressed=%.1f/s\n", g_force_sent_rate, g_force_supp_rate);
+    g_force_sent         = 0;
+    g_force_suppressed   = 0;
+    g_force_window_start = now;
+}
+
+// Wall seconds the primary D may stay silent before B fails over.
+static double standby_deadline_sec(const SimParams *p) {
+    double scale = (p->time_scale > 0.0) ? p->time_scale : 1.0;
+    double d = p->standby_miss_ticks * p->dt / scale;
+    return d < STANDBY_MIN_DEADLINE_SEC ? STANDBY_MIN_DEADLINE_SEC : d;
+}
+
+// Tells W the current pids after a restart or failover (W kills these on timeout).
+static void notify_watchdog(int fd_to_w, const WatchPids *peers, FILE *logfile) {
+    if (fd_to_w < 0) return;
+    if (write(fd_to_w, peers, sizeof(*peers)) != (ssize_t)sizeof(*peers)) {
+        fprintf(logfile, "[B] WatchPids update to W failed: %s\n", strerror(errno));
+    }
+}
+
+// pidfd for a child process (thread components run as B: nothing to watch)
+static void watch_child(const char *name, pid_t pid, FILE *logfile) {
+    if (pid == getpid()) pid = -1;
+    if (pw_add(&g_pw, name, pid) == -1) {
+        fprintf(logfile, "[B] pidfd for %s (pid %d): %s%s\n", name, (int)pid, strerror(errno),
+                errno == ENOSYS ? " -> EOF / heartbeat detection only" : "");
+    }
+}
+
+// SIGTERM to a child process at shutdown (-1 = gone, B's pid = thread component)
+static void stop_child(pid_t pid) {
+    if (pid > 0 && pid != getpid()) kill(pid, SIGTERM);
+}
+
+// Forks a new W on a new configuration pipe after the old one exited.
+// Returns its pid, or -1 (B then runs unsupervised).
+static pid_t respawn_watchdog(int *fd_to_w, const WatchPids *peers, const SimParams *p, FILE *logfile) {
+    int cfg[2];
+    if (pipe(cfg) == -1) return -1;
+    fflush(NULL);   // the child must not flush B's buffered output again
+
+    // Heartbeats stay blocked across the fork: the child ignores them until
+    // W installs its handler, instead of dying of the default action
+    sigset_t usr1, old;
+    sigemptyset(&usr1);
+    sigaddset(&usr1, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &usr1, &old);
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Drop B's handlers and fds (W must not hold D's or O/T's pipe ends open)
+        signal(SIGTERM, SIG_DFL);
+        signal(SIGUSR2, SIG_DFL);
+        signal(SIGUSR1, SIG_IGN);
+        sigprocmask(SIG_SETMASK, &old, NULL);
+        long max_fd = sysconf(_SC_OPEN_MAX);
+        if (max_fd < 0 || max_fd > 4096) max_fd = 4096;
+        for (int fd = 3; fd < max_fd; ++fd) {
+            if (fd != cfg[0]) close(fd);
+        }
+        run_watchdog_process(cfg[0], p->wd_warn_sec, p->wd_kill_sec);   // never returns
+    }
+    sigprocmask(SIG_SETMASK, &old, NULL);
+    close(cfg[0]);
+    if (pid == -1) {
+        close(cfg[1]);
+        return -1;
+    }
+    if (*fd_to_w != -1) close(*fd_to_w);
+    *fd_to_w = cfg[1];
+    notify_watchdog(*fd_to_w, peers, logfile);
+    return pid;
+}
 
 // ---------------- Watchdog signal flags (set by signal handlers) ----------------
 static volatile sig_atomic_t g_wd_warning_flag = 0; // set by SIGUSR2 handler
@@ -84,11 +419,389 @@ static void on_watchdog_stop(int signo) {
     g_wd_stop = 1;
 }
 
+// SIGHUP: re-read the log_* settings of params.txt at the next loop turn
+static volatile sig_atomic_t g_log_reload = 0;
+
+static void on_log_reload(int signo) {
+    (void)signo;
+    g_log_reload = 1;
+}
+
 // ---------------- Watchdog banner UI state ----------------
 // Show a warning banner for a limited amount of time after SIGUSR2
 // We store it as "how many simulation steps remaining" to show the banner.
 static char watchdog_banner_msg[] = "WATCHDOG WARNING, system may be unstable"; 
 
+// Applies one key (pressed count times) to the blackboard state.
+// Shared by the keyboard batches, scripted scenario input and soak input.
+// Directional keys and brake only update cur_force and set *force_dirty: the
+// caller requests one force update for the whole batch. Pause/reset request it here.
+// Returns 1 if the key requests quitting.
+// ----------------------------------------------------------------------
+static int apply_key(char key,
+                     int              count,
+                     bool            *force_dirty,
+                     ForceStateMsg   *cur_force,
+                     DroneStateMsg   *cur_state,
+                     bool            *paused,
+                     const SimParams *params,
+                     FILE            *logfile)
+{
+    // Handles Quit request
+    if (key == 'q') {
+        fprintf(logfile, "QUIT requested by 'q'\n");
+        fflush(logfile);
+        return 1;
+    }
+    // ------------------------------------------------------------------
+    // Handles Pause toggle
+    // ------------------------------------------------------------------
+    if (key == 'p') {
+        *paused = !*paused;
+
+        if (*paused) {
+            // Zeroes the force when entering pause.
+            cur_force->Fx = 0.0;
+            cur_force->Fy = 0.0;
+            cur_force->reset = 0;
+            request_force(cur_force, "key");
+            fprintf(logfile, "PAUSE: ON\n");
+        } else {
+            fprintf(logfile, "PAUSE: OFF\n");
+        }
+        fflush(logfile);
+    }
+    // ------------------------------------------------------------------
+    // Handles Reset (uppercase O)
+    // ------------------------------------------------------------------
+    else if (key == 'O') {
+        // Resets server-side state
+        cur_state->x  = 0.0;
+        cur_state->y  = 0.0;
+        cur_state->vx = 0.0;
+        cur_state->vy = 0.0;
+
+        // Resets forces
+        cur_force->Fx = 0.0;
+        cur_force->Fy = 0.0;
+        cur_force->reset = 1; // Signals D to reset its state
+
+        request_force(cur_force, "key");
+
+        cur_force->reset = 0; // Clears locally
+        *paused = false;     // Unpauses
+        trail_clear(&g_trails.drone[0]);
+
+        fprintf(logfile, "RESET requested (O)\n");
+        fflush(logfile);
+    }
+    // ------------------------------------------------------------------
+    // Handles Trail toggle
+    // ------------------------------------------------------------------
+    else if (key == 't') {
+        g_trails.visible = !g_trails.visible;
+        fprintf(logfile, "TRAIL: %s\n", g_trails.visible ? "ON" : "OFF");
+        fflush(logfile);
+    }
+    // ------------------------------------------------------------------
+    // Handles Autopilot toggle (refused while an external controller steers)
+    // ------------------------------------------------------------------
+    else if (key == 'a') {
+        if (ctrl_has_owner(&g_ctrl)) {
+            fprintf(logfile, "KEY: a ignored (controller has control)\n");
+        } else {
+            mpc_set_active(&g_mpc, !g_mpc.active, logfile);
+            if (!g_mpc.active) {
+                cur_force->Fx = 0.0;
+                cur_force->Fy = 0.0;
+                *force_dirty  = true;
+            }
+        }
+        fflush(logfile);
+    }
+    // ------------------------------------------------------------------
+    // Handles Directional keys and the break 'd'
+    // ------------------------------------------------------------------
+    else {
+        double dFx, dFy;
+        direction_from_key(key, &dFx, &dFy);
+
+        if (!*paused && key != 'd' && (ctrl_has_owner(&g_ctrl) || g_mpc.active)) {
+            // An external controller or the autopilot steers: only the brake overrides it
+            LOGC(LOGC_KEYS, LOGL_DEBUG, 0, "KEY: %c ignored (%s has control, 'd' takes it back)\n",
+                 key, g_mpc.active ? "autopilot" : "controller");
+        } else if (!*paused) {
+            if (key == 'd') {
+                // Brake: Zeroes forces (and takes control back from a controller / the autopilot)
+                ctrl_revoke(&g_ctrl, "keyboard brake", logfile);
+                mpc_set_active(&g_mpc, 0, logfile);
+                cur_force->Fx = 0.0;
+                cur_force->Fy = 0.0;
+            } else {
+                // Accumulates new force (coalesced presses count once each)
+                cur_force->Fx += count * dFx * params->force_step;
+                cur_force->Fy += count * dFy * params->force_step;
+            }
+
+            cur_force->reset = 0;
+            *force_dirty = true;
+
+            LOGC(LOGC_KEYS, LOGL_INFO, 0,
+                 "KEY: %c x%d  dFx=%.1f dFy=%.1f -> Fx=%.2f Fy=%.2f\n",
+                 key, count, dFx, dFy, cur_force->Fx, cur_force->Fy);
+        } else {
+            // Paused: Ignores directional changes (but still log)
+            LOGC(LOGC_KEYS, LOGL_DEBUG, 0, "KEY: %c ignored (PAUSED)\n", key);
+        }
+    }
+    return 0;
+}
+
+// Replaces the active obstacles / targets with a scenario wave (no filtering:
+// scenario worlds are authored and validated at load time).
+// ----------------------------------------------------------------------
+static void install_obstacle_wave(const ObstacleSetMsg *set) {
+    for (int i = 0; i < set->count && i < NUM_OBSTACLES; ++i)
+        put_slot(ECS_OBSTACLE, i, set->obs[i].x, set->obs[i].y, set->obs[i].life_steps);
+    clear_slots_from(ECS_OBSTACLE, set->count);
+    rehash_slots(ECS_OBSTACLE);
+}
+
+static void install_target_wave(const TargetSetMsg *set) {
+    for (int i = 0; i < set->count && i < NUM_TARGETS; ++i)
+        put_slot(ECS_TARGET, i, set->tgt[i].x, set->tgt[i].y, set->tgt[i].life_steps);
+    clear_slots_from(ECS_TARGET, set->count);
+    rehash_slots(ECS_TARGET);
+}
+
+// Replays every scenario event due at the current tick.
+// Returns 1 when the scenario is over (end tick reached or scripted 'q').
+// ----------------------------------------------------------------------
+static int scenario_tick(const Scenario  *scn,
+                         ForceStateMsg   *cur_force,
+                         DroneStateMsg   *cur_state,
+                         bool            *paused,
+                         const SimParams *params,
+                         FILE            *logfile)
+{
+    while (g_scn_obs_next < scn->n_obstacle_waves &&
+           scn->obstacle_waves[g_scn_obs_next].tick <= g_scn_tick) {
+        install_obstacle_wave(&scn->obstacle_waves[g_scn_obs_next].set);
+        fprintf(logfile, "[SCENARIO] tick %d: obstacle wave %d (%d obstacles)\n",
+                g_scn_tick, g_scn_obs_next, scn->obstacle_waves[g_scn_obs_next].set.count);
+        g_scn_obs_next++;
+    }
+
+    while (g_scn_tgt_next < scn->n_target_waves &&
+           scn->target_waves[g_scn_tgt_next].tick <= g_scn_tick) {
+        install_target_wave(&scn->target_waves[g_scn_tgt_next].set);
+        fprintf(logfile, "[SCENARIO] tick %d: target wave %d (%d targets)\n",
+                g_scn_tick, g_scn_tgt_next, scn->target_waves[g_scn_tgt_next].set.count);
+        g_scn_tgt_next++;
+    }
+
+    while (g_scn_flt_next < scn->n_faults && scn->faults[g_scn_flt_next].tick <= g_scn_tick) {
+        const ScnFault *f = &scn->faults[g_scn_flt_next++];
+        fault_set(f->id, f->value, "scenario", logfile);
+    }
+
+    while (g_scn_key_next < scn->n_keys && scn->keys[g_scn_key_next].tick <= g_scn_tick) {
+        char key = scn->keys[g_scn_key_next].key;
+        g_scn_key_next++;
+        // Force changes go out with this tick's "state" update
+        bool dirty = false;
+        if (apply_key(key, 1, &dirty, cur_force, cur_state, paused, params, logfile)) {
+            g_scn_finished = 1;
+            return 1;
+        }
+    }
+
+    if (scn->end_tick > 0 && g_scn_tick >= scn->end_tick) {
+        g_scn_finished = 1;
+        return 1;
+    }
+    return 0;
+}
+
+// Draws one ncurses frame: drone world (left) + inspection panel (right).
+// ----------------------------------------------------------------------
+static void draw_ui(const SimParams     *p,
+                    const ForceStateMsg *cur_force,
+                    const DroneStateMsg *cur_state,
+                    bool                 paused,
+                    char                 last_key)
+{
+    int max_y, max_x;
+    double time_since_last_hit = 0; // for tracking time since last hit
+
+    // Queries current terminal size (for resizing).
+    getmaxyx(stdscr, max_y, max_x);
+
+    // Plans layout:
+    //   - 2 top lines of info
+    //   - horizontal separator
+    //   - world area below
+    //   - inspection panel on the right
+    int content_top    = 1;                 // first row inside border
+    int top_lines      = 2;                 // 2 text lines at top
+    int top_info_y1    = content_top;
+    int top_info_y2    = content_top + 1;
+    int sep_y          = content_top + top_lines; // horizontal separator row
+    int content_bottom = max_y - 2;         // last row inside bottom border
+
+    if (sep_y >= content_bottom) {
+        sep_y = content_top; // in tiny terminals
+    }
+
+    // Defines right inspection panel width
+    int insp_width = 35;               // was 35
+    if (max_x < insp_width + 10) {
+        insp_width = max_x / 4;
+        if (insp_width < 10) insp_width = 10;
+    }
+    int insp_start_x = max_x - insp_width;
+    if (insp_start_x < 1) insp_start_x = 1;
+
+    // Defines world area below separator.
+    int world_top    = sep_y + 1;
+    if (world_top > content_bottom) world_top = content_top + 1;
+    int world_bottom = content_bottom;
+    int world_height = world_bottom - world_top + 1;
+    if (world_height < 1) world_height = 1;
+
+    // Defines left world width.
+    int main_width = insp_start_x - 2;
+    if (main_width < 10) main_width = 10;
+
+    // ------------------------------------------------------------------
+    // Draws UI (drone world + inspection panel)
+    // ------------------------------------------------------------------
+    erase();
+    box(stdscr, 0, 0);
+
+    // Top info lines
+    mvprintw(top_info_y1, 2,
+             "Controls: w e r / s d f / x c v | d=brake, p=pause, O=reset, t=trail, q=quit");
+    mvprintw(top_info_y2, 2,
+             "Paused: %s", paused ? "YES" : "NO");
+    
+    // Watchdog blinking warning: visible only when active AND blink phase is ON
+    // --- Watchdog live timing info ---
+    double age = hb_age_sec();  // seconds since last valid DroneStateMsg
+    double warn_in = (double)p->wd_warn_sec - age;
+    double kill_in = (double)p->wd_kill_sec - age;
+
+    if (warn_in < 0) warn_in = 0;
+    if (kill_in < 0) kill_in = 0;
+
+    if (wd_warning_active && wd_blink_phase) {
+        // If colors exist, use a red-ish pair. Otherwise use reverse + bold.
+        if (has_colors()) {
+            attron(COLOR_PAIR(RENDER_PAIR_WARNING) | A_BOLD | A_REVERSE);
+            mvprintw(top_info_y2, 18, " %s ", watchdog_banner_msg);
+            mvprintw(top_info_y2, 60, "KILL IN: %.2fs", kill_in);
+            attroff(COLOR_PAIR(RENDER_PAIR_WARNING) | A_BOLD | A_REVERSE);
+        } else {
+            attron(A_BOLD | A_REVERSE);
+            mvprintw(top_info_y2, 18, " %s ", watchdog_banner_msg);
+            mvprintw(top_info_y2, 60, "KILL IN: %.2fs", kill_in);
+            attroff(A_BOLD | A_REVERSE);
+        }
+    }
+
+
+
+    
+
+    // Horizontal separator row (under top info)
+    if (sep_y >= 1 && sep_y <= max_y - 2) {
+        for (int x = 1; x < max_x - 1; ++x) {
+            mvaddch(sep_y, x, '-');
+        }
+    }
+
+    // Vertical separator between world and inspection
+    int sep_x = insp_start_x - 1;
+    if (sep_x > 1 && sep_x < max_x - 1) {
+        for (int y = world_top; y <= world_bottom; ++y) {
+            mvaddch(y, sep_x, '|');
+        }
+    }
+
+    // WORLD DRAWING (left)
+    RenderRect world = { world_top, 1, world_height, main_width };
+    render_world(&world, p->world_half, cur_state, &g_world,
+                 g_trails.visible ? &g_trails.drone[0] : NULL);
+
+
+    // INSPECTION panel on the right
+    int info_y = world_top;
+    int info_x = insp_start_x + 1;
+
+    
+    if (info_x < max_x - 1) {
+        mvprintw(info_y,     info_x, "INSPECTION");
+        mvprintw(info_y + 2, info_x, "Last key: %c", last_key);
+        mvprintw(info_y + 4, info_x, "Fx = %.2f", cur_force->Fx);
+        mvprintw(info_y + 5, info_x, "Fy = %.2f", cur_force->Fy);
+        mvprintw(info_y + 7, info_x, "x  = %.2f", cur_state->x);
+        mvprintw(info_y + 8, info_x, "y  = %.2f", cur_state->y);
+        mvprintw(info_y + 9, info_x, "vx = %.2f", cur_state->vx);
+        mvprintw(info_y +10, info_x, "vy = %.2f", cur_state->vy);
+        
+        mvprintw(info_y +12, info_x, "Score: %d", g_score);
+        mvprintw(info_y +13, info_x, "Targets collected: %d", g_targets_collected);
+        if (g_last_hit_step >= 0 ) {
+            time_since_last_hit = (g_step_counter - g_last_hit_step) * p->dt;
+
+            mvprintw(info_y +15, info_x, "Since last hit: %.2f sec", time_since_last_hit);
+        }
+        else {
+            mvprintw(info_y +14, info_x, "Last hit: none");
+        }
+
+        mvprintw(info_y +16, info_x, "Trail: %s %d/%d pts (%ld raw)",
+                 g_trails.visible ? "on" : "off",
+                 trail_points(&g_trails.drone[0]), g_trails.drone[0].capacity,
+                 g_trails.drone[0].raw_points);
+
+        // Generator channels: highlighted while any of them is not open
+        bool degraded = chan_degraded(&g_chan_obs) || chan_degraded(&g_chan_tgt);
+        if (degraded && has_colors()) attron(COLOR_PAIR(RENDER_PAIR_WARNING) | A_BOLD);
+        mvprintw(info_y +19, info_x, "Gen: O %s (%d)  T %s (%d)%s",
+                 chan_state_name(g_chan_obs.state), g_chan_obs.restarts,
+                 chan_state_name(g_chan_tgt.state), g_chan_tgt.restarts,
+                 degraded ? "  DEGRADED" : "");
+        if (degraded && has_colors()) attroff(COLOR_PAIR(RENDER_PAIR_WARNING) | A_BOLD);
+
+        mvprintw(info_y +21, info_x, "Force cmds: %.0f/s sent %.0f/s held",
+                 g_force_sent_rate, g_force_supp_rate);
+        if (ctrl_has_owner(&g_ctrl)) {
+            mvprintw(info_y +22, info_x, "Control: client %d (age %.2fms)",
+                     g_ctrl.owner, g_ctrl.cmd_age_ms);
+        } else if (g_mpc.active) {
+            mvprintw(info_y +22, info_x, "Control: autopilot %dx%d %.2fms %.0f/ms",
+                     g_mpc.samples, g_mpc.horizon, g_mpc.last_ms, g_mpc.rollouts_per_ms);
+        } else {
+            mvprintw(info_y +22, info_x, "Control: keyboard");
+        }
+
+        if (g_sb.enabled) {
+            mvprintw(info_y +20, info_x, "Standby: %s #%d failovers=%d",
+                     g_sb.pid > 0 ? "ready" : "none", g_sb.generation, g_sb.failovers);
+        }
+
+        if (g_iob.syscalls_per_tick > 0.0) {
+            mvprintw(info_y +17, info_x, "IO: %s", iob_backend_name(&g_iob));
+            mvprintw(info_y +18, info_x, "syscalls/tick=%.1f ctxsw=%.1f",
+                     g_iob.syscalls_per_tick, g_iob.ctxsw_per_tick);
+        }
+
+    }
+
+    render_present(p->render_full ? RENDER_FULL : RENDER_INCREMENTAL);
+}
+
 /**
  * @brief Main function for the Server (B) process.
  *
@@ -99,15 +812,17 @@ static char watchdog_banner_msg[] = "WATCHDOG WARNING, system may be unstable";
  * - **Visualization**: Draws the ncurses UI.
  * - **Synchronization**: Sends the official force commands to Dynamics to step the physics.
  * 
- * @param fd_kb      Pipe FD for reading KeyMsg from Keyboard (I).
+ * @param fd_kb      Pipe FD for reading KeyBatchMsg from Keyboard (I).
  * @param fd_to_d    Pipe FD for writing ForceStateMsg to Dynamics (D).
  * @param fd_from_d  Pipe FD for reading DroneStateMsg from Dynamics (D).
  * @param fd_obs     Pipe FD for reading obstacles from Generator (O).
  * @param fd_tgt     Pipe FD for reading targets from Generator (T).
+ * @param fd_to_w    Pipe FD for sending WatchPids updates to the Watchdog (W).
+ * @param peers      PIDs of B, I, D, O, T (B's own PID for thread components).
  * @param pid_W      PID of the Watchdog process (for sending heartbeat signals).
  * @param params     Simulation parameters.
  */
-void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int fd_tgt, pid_t pid_W, SimParams params) 
+int run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int fd_tgt, int fd_to_w, WatchPids peers, pid_t pid_W, SimParams params) 
 {
     // --- Opens logfile ---
     FILE *logfile = open_process_log("server", "B");
@@ -115,32 +830,74 @@ void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int f
         endwin();
         die("[B] cannot open logs/server.log");
     }
+    // Selects output backend; from here on logfile may be the batched (io_uring) log
+    iob_init(&g_iob, params.io_uring, logfile);
+    logfile = g_iob.log;
     // Initialize heartbeat tracking
     set_last_hb_now(); // assume "alive" at start
 
+    // One trail per drone, sharing the fixed vertex budget
+    trail_set_init(&g_trails, 1, params.world_half);
+
+    // Empty world: every entity slot inactive
+    wh_init(&g_wh);
+    nbr_init(&g_nbr_obs, "obstacles");
+    nbr_init(&g_nbr_tgt, "targets");
+
+    // Empty entity store (one drone) and the per-tick systems: conflicting,
+    // so hit runs first and its removals are applied before age
+    int ecs_cap[ECS_ARCH_COUNT] = { 1, NUM_OBSTACLES, NUM_TARGETS };
+    const EcsSystem tick_systems[] = {
+        { "hit", ECS_POS, ECS_LIFE | ECS_RES_SCORE, ecs_sys_hit, &g_sim },
+        { "age", 0,       ECS_LIFE,                 ecs_sys_age, &g_sim },
+    };
+    if (ecs_init(&g_world, ecs_cap) != 0 || ecs_sched_init(&g_sched, tick_systems, 2, 1) != 0)
+        die("[B] cannot set up the entity store");
+    g_drone      = ecs_spawn(&g_world, ECS_DRONE);
+    g_sim.params = &params;
+
+    if (arena_init(&g_tick_arena, TICK_ARENA_BYTES) != 0)
+        fprintf(logfile, "[B] tick arena: cannot allocate %d bytes, scratch falls back\n", TICK_ARENA_BYTES);
+    ALLOC_TICK_INIT(&g_alloc_tick, ALC_B);
+    pc_open(&g_pc, "B", k_b_phases, BPH_COUNT, params.perf_counters, logfile);
+    pw_init(&g_pw);
+    watch_child("I", peers.pid_I, logfile);
+    watch_child("D", peers.pid_D, logfile);
+    watch_child("O", peers.pid_O, logfile);
+    watch_child("T", peers.pid_T, logfile);
+    watch_child("W", pid_W, logfile);
+
+    // Session recording for offline analytics
+    if (params.telemetry) {
+        if (tlm_open(&g_tlm, &params) == 0) {
+            fprintf(logfile, "[B] Telemetry -> %s\n", g_tlm.path);
+        } else {
+            fprintf(logfile, "[B] Telemetry disabled: cannot create %s/ (%s)\n", TLM_DIR, strerror(errno));
+        }
+        fflush(logfile);
+    }
+    g_tlm_last_state = monotonic_now_sec();
+
+    // Soak mode runs without a terminal: no ncurses, random input instead of I
+    const bool headless = params.soak_sim_sec > 0.0;
+    if (headless) {
+        soak_init(&g_soak, &params, monotonic_now_sec());
+        fprintf(logfile, "[B] SOAK mode: %.2f simulated hours at time_scale=%.1f, sample every %.0fs\n",
+                params.soak_sim_sec / 3600.0, params.time_scale, params.soak_sample_sec);
+        fflush(logfile);
+    }
+
     // --- Initialize ncurses ---
+    if (!headless) {
     initscr();      // Assignment-1 (previously was called inside loop which caused seldom window flickering issues)
     cbreak();
     noecho();
     curs_set(0);  // hide cursor
+    }
 
     // Assignment-1 (previously was defined inside loop casing uneccessary repeated calls)
     // ---- ncurses color init (DO THIS ONCE) ----
-    if (has_colors()) {     
-        start_color();
-
-        // Only attempt init_color if terminal supports changing colors.
-        if (can_change_color()) {
-            init_color(COLOR_YELLOW, 1000, 500, 0); // orange-ish
-            init_color(COLOR_GREEN,  0, 1000, 0);   // green
-        }
-
-        init_pair(1, COLOR_YELLOW, COLOR_BLACK); // obstacles
-        init_pair(2, COLOR_GREEN,  COLOR_BLACK); // targets
-        init_pair(3, COLOR_RED,    COLOR_BLACK); // watchdog warning
-    } else {
-        // If cmd doesnot permit colors, then continue without colors.
-    }
+    if (!headless) render_init_colors();
 
     // ---------------- Install signal handlers for Watchdog ----------------
     struct sigaction sa_warn;
@@ -163,37 +920,77 @@ void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int f
         fflush(logfile);
     }
 
+    struct sigaction sa_hup;
+    memset(&sa_hup, 0, sizeof(sa_hup));
+    sa_hup.sa_handler = on_log_reload;
+    sigemptyset(&sa_hup.sa_mask);
+    sa_hup.sa_flags = SA_RESTART;
+    if (sigaction(SIGHUP, &sa_hup, NULL) == -1) {
+        fprintf(logfile, "[B] sigaction(SIGHUP) failed: %s\n", strerror(errno));
+        fflush(logfile);
+    }
+
+    // A dead peer must show up as EOF/EPIPE on its channel, not kill B
+    signal(SIGPIPE, SIG_IGN);
+
+    // Generator channels; process generators are restarted by B when they die
+    chan_init(&g_chan_obs, "O", "obstacles", fd_obs, peers.pid_O, run_obstacle_process);
+    chan_init(&g_chan_tgt, "T", "targets",   fd_tgt, peers.pid_T, run_target_process);
+
+    // External controller API (binary commands + state stream)
+    if (params.ctrl_socket) ctrl_open(&g_ctrl, CTRL_SOCKET_PATH, logfile);
+
+    // Autopilot starts disengaged
+    mpc_init(&g_mpc, &params);
+
+    // Hot-path log categories (changed at runtime by SIGHUP or CTRL_LOG)
+    logc_init(logfile, &params);
+
 
     // --- Defines Blackboard state (model of the world)
     ForceStateMsg cur_force;
+    memset(&cur_force, 0, sizeof(cur_force));
     cur_force.Fx = 0.0;
     cur_force.Fy = 0.0;
-    cur_force.reset = 0;
+    cur_force.reset = FORCE_NORMAL;
 
     DroneStateMsg cur_state = (DroneStateMsg){0.0, 0.0, 0.0, 0.0};
+
+    // Scenario-driven run: same initial state as D, waves replayed by tick
+    const Scenario *scn = scenario_active();
+    if (scn) {
+        if (scn->has_drone) cur_state = scn->drone;
+        fprintf(logfile, "[SCENARIO] Running '%s' (%s)\n", scn->name, scn->path);
+        fflush(logfile);
+    }
     char last_key = '?';
     bool paused = false;
 
-    // Sends to helper rather than directly write to D
+    // Hot-standby replica: same force stream from the first command on
+    if (params.standby_d) {
+        g_sb.enabled = 1;
+        if (standby_spawn(&g_sb, &params, logfile) == 0) {
+            standby_sync(&g_sb, &g_iob, &g_force_last, &cur_state, logfile);
+        }
+        fprintf(logfile, "[B] STANDBY: failover after %.1f ms of primary silence\n",
+                1000.0 * standby_deadline_sec(&params));
+        fflush(logfile);
+    }
+    g_primary_last = monotonic_now_sec();
+
     // Initial state is zero, so cur_state is still {0,0,0,0}.
     // Sends initial total force (which is just user=0 + obstacles repulsion).
-    send_total_force_to_d(&cur_force,
-                          &cur_state,
-                          &params,
-                          g_obstacles,
-                          NUM_OBSTACLES,
-                          fd_to_d,
-                          logfile,
-                          "init");
+    g_force_window_start = monotonic_now_sec();
+    request_force(&cur_force, "init");
+    flush_force(&cur_force, &cur_state, &params, fd_to_d);
 
 
-    int max_y, max_x;
-
-    // Needed for handling time_since_last_hit
-    double time_since_last_hit = 0; // for tracking time since last hit
-
     // --- Main event loop ---
+    int d_eof = 0;   // D's state pipe hit EOF with a replica ready: fail over next pass
     while (1) {
+        // New tick: scratch from the last one is dropped; counts its allocations (ALLOC_CHECK=1)
+        ALLOC_TICK(&g_alloc_tick, logfile);
+        arena_reset(&g_tick_arena);
 
         // ---------------- Watchdog notifications ----------------
         // Watchdog warning -> start banner
@@ -220,70 +1017,46 @@ void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int f
             break; // exit from server loop
         }
 
-        // Queries current terminal size (for resizing).
-        getmaxyx(stdscr, max_y, max_x);
-
-        // Plans layout:
-        //   - 2 top lines of info
-        //   - horizontal separator
-        //   - world area below
-        //   - inspection panel on the right
-        int content_top    = 1;                 // first row inside border
-        int top_lines      = 2;                 // 2 text lines at top
-        int top_info_y1    = content_top;
-        int top_info_y2    = content_top + 1;
-        int sep_y          = content_top + top_lines; // horizontal separator row
-        int content_bottom = max_y - 2;         // last row inside bottom border
-
-        if (sep_y >= content_bottom) {
-            sep_y = content_top; // in tiny terminals
-        }
-
-        // Defines right inspection panel width
-        int insp_width = 35;               // was 35
-        if (max_x < insp_width + 10) {
-            insp_width = max_x / 4;
-            if (insp_width < 10) insp_width = 10;
+        if (g_log_reload) {
+            g_log_reload = 0;
+            if (logc_reload("params.txt", &params) != 0)
+                fprintf(logfile, "[B] LOG reload: cannot read params.txt: %s\n", strerror(errno));
         }
-        int insp_start_x = max_x - insp_width;
-        if (insp_start_x < 1) insp_start_x = 1;
-
-        // Defines world area below separator.
-        int world_top    = sep_y + 1;
-        if (world_top > content_bottom) world_top = content_top + 1;
-        int world_bottom = content_bottom;
-        int world_height = world_bottom - world_top + 1;
-        if (world_height < 1) world_height = 1;
-
-        // Defines left world width.
-        int main_width = insp_start_x - 2;
-        if (main_width < 10) main_width = 10;
 
         // ---------------- Uses select() to wait for events ----------------        // Uses select() to wait for data from keyboard, dynamics, obstacles, and targets.
         // Also handles EINTR (signal generated on resize to permit window resize without exiting the program).
+        // fd_kb is -1 once I ended in soak mode (its input is generated here then).
+        // Closed generator channels are left out of the set (see channel.h).
         fd_set rfds;
-        int maxfd = fd_kb;
-        
-        if (fd_from_d > maxfd) maxfd = fd_from_d;
-        if (fd_obs    > maxfd) maxfd = fd_obs;
-        if (fd_tgt    > maxfd) maxfd = fd_tgt;
-        maxfd += 1;
-
         int sel;
         while (1) {
             FD_ZERO(&rfds);
-            FD_SET(fd_kb,     &rfds);
+            int maxfd = fd_from_d;
             FD_SET(fd_from_d, &rfds);
-            //
-            FD_SET(fd_obs,    &rfds);
-            FD_SET(fd_tgt,    &rfds);
+            if (fd_kb != -1) {
+                FD_SET(fd_kb, &rfds);
+                if (fd_kb > maxfd) maxfd = fd_kb;
+            }
+            chan_watch(&g_chan_obs, &rfds, &maxfd);
+            chan_watch(&g_chan_tgt, &rfds, &maxfd);
+            ctrl_watch(&g_ctrl, &rfds, &maxfd);
+            pw_watch(&g_pw, &rfds, &maxfd);
+            maxfd += 1;
 
             // sel = select(maxfd, &rfds, NULL, NULL, NULL);
             struct timeval tv;
             tv.tv_sec  = 0;
             tv.tv_usec = 100000; // 100 ms
 
+            // With a standby, wake up in time to catch a missed primary deadline
+            if (g_sb.pid > 0) {
+                double left = standby_deadline_sec(&params) - (monotonic_now_sec() - g_primary_last);
+                if (left < 0.0005) left = 0.0005;
+                if (left < 0.1) tv.tv_usec = (suseconds_t)(left * 1e6);
+            }
+
             sel = select(maxfd, &rfds, NULL, NULL, &tv);
+            iob_count_select(&g_iob);
 
             if (sel == 0) {
                 if (wd_warning_active && !paused) {
@@ -305,131 +1078,176 @@ void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int f
                     // Retries if interrupted by signal (like resize)
                     continue;
                 } else {
-                    fclose(logfile);
-                    endwin();
+                    iob_shutdown(&g_iob);
+                    fclose(g_iob.log);
+                    if (!headless) endwin();
                     die("[B] select failed");
                 }
             }
             break; // sel >= 0, we have an event
         }
+        pc_lap(&g_pc, BPH_WAIT);   // loop top + select()
 
         // ------------------------------------------------------------------
-        // Handles keyboard input from I (if available).
+        // Child exits (pidfds): logged with the reason as they happen. A dead D
+        // is replaced below (standby promoted, or a new D forked for it), a
+        // dead W restarted; O/T restarts stay with their channels (chan_poll).
         // ------------------------------------------------------------------
-        if (FD_ISSET(fd_kb, &rfds)) {
-            KeyMsg km;
-            int n = read(fd_kb, &km, sizeof(km));
-            if (n <= 0) {
-                mvprintw(0, 1, "[B] Keyboard process ended (EOF).");
-                refresh();
-                break;
-            }
-
-            last_key = km.key;
-
-            // Handles Quit request
-            if (km.key == 'q') {
-                fprintf(logfile, "QUIT requested by 'q'\n");
+        int d_exited = d_eof;   // the pipe closes before the pidfd (if any) reports it
+        {
+            const char *who;
+            pid_t       gone;
+            while (pw_next_exit(&g_pw, &rfds, &who, &gone) == 0) {
+                char why[64];
+                pw_exit_reason(gone, why, sizeof(why));
+                fprintf(logfile, "[B] EXIT %s (pid %d): %s\n", who, (int)gone, why);
+                if (strcmp(who, "D") == 0 && gone == peers.pid_D) {
+                    d_exited = 1;
+                    if (g_sb.pid <= 0) standby_spawn(&g_sb, &params, logfile);   // a D to promote
+                } else if (strcmp(who, "W") == 0 && !g_wd_stop) {
+                    waitpid(gone, NULL, 0);   // exited: reaped at once
+                    pid_t w = -1;
+                    if (g_w_restarts < params.peer_max_restarts &&
+                        (w = respawn_watchdog(&fd_to_w, &peers, &params, logfile)) > 0) {
+                        g_w_restarts++;
+                        fprintf(logfile, "[B] W restarted (pid %d, restart %d/%d)\n",
+                                (int)w, g_w_restarts, params.peer_max_restarts);
+                    } else {
+                        fprintf(logfile, "[B] W not restarted: running without watchdog\n");
+                    }
+                    pid_W = w;
+                    watch_child("W", pid_W, logfile);
+                }
                 fflush(logfile);
-                break;
             }
-            // ------------------------------------------------------------------
-            // Handles Pause toggle
-            // ------------------------------------------------------------------
-            if (km.key == 'p') {
-                paused = !paused;
+        }
 
-                if (paused) {
-                    // Zeroes the force when entering pause.
-                    cur_force.Fx = 0.0;
-                    cur_force.Fy = 0.0;
-                    cur_force.reset = 0;
-                    send_total_force_to_d(&cur_force,
-                                        &cur_state,
-                                        &params,
-                                        g_obstacles,
-                                        NUM_OBSTACLES,
-                                        fd_to_d,
-                                        logfile,
-                                        "key");
-                    fprintf(logfile, "PAUSE: ON\n");
-                } else {
-                    fprintf(logfile, "PAUSE: OFF\n");
+        // ------------------------------------------------------------------
+        // Hot standby: drain the replica, fail over if the primary missed its deadline
+        // (or exited)
+        // ------------------------------------------------------------------
+        if (g_sb.enabled || d_exited) {
+            if (standby_drain(&g_sb) == -1) {
+                fprintf(logfile, "[B] STANDBY: replica #%d lost, forking a new one\n", g_sb.generation);
+                standby_stop(&g_sb);
+                if (standby_spawn(&g_sb, &params, logfile) == 0) {
+                    standby_sync(&g_sb, &g_iob, &g_force_last, &cur_state, logfile);
                 }
                 fflush(logfile);
             }
-            // ------------------------------------------------------------------
-            // Handles Reset (uppercase O)
-            // ------------------------------------------------------------------
-            else if (km.key == 'O') {
-                // Resets server-side state
-                cur_state.x  = 0.0;
-                cur_state.y  = 0.0;
-                cur_state.vx = 0.0;
-                cur_state.vy = 0.0;
-
-                // Resets forces
-                cur_force.Fx = 0.0;
-                cur_force.Fy = 0.0;
-                cur_force.reset = 1; // Signals D to reset its state
 
-                send_total_force_to_d(&cur_force,
-                      &cur_state,
-                      &params,
-                      g_obstacles,
-                      NUM_OBSTACLES,
-                      fd_to_d,
-                      logfile,
-                      "key");
-
-                cur_force.reset = 0; // Clears locally
-                paused = false;      // Unpauses
+            double now    = monotonic_now_sec();
+            double silent = now - g_primary_last;
+            if (g_sb.pid > 0 && (d_exited || silent > standby_deadline_sec(&params))) {
+                // Promotes the replica: its channel becomes D's channel
+                standby_retire_primary(peers.pid_D);
+                close(fd_to_d);
+                close(fd_from_d);
+                fd_to_d   = g_sb.fd_force;
+                fd_from_d = g_sb.fd_state;
+                peers.pid_D = g_sb.pid;
+                int fl = fcntl(fd_from_d, F_GETFL, 0);
+                if (fl != -1) fcntl(fd_from_d, F_SETFL, fl & ~O_NONBLOCK);
+                standby_release(&g_sb);
+                d_eof = 0;
+
+                // The new primary continues exactly from B's last state
+                ForceStateMsg adopt = g_force_last;
+                adopt.reset = FORCE_PROMOTE;
+                adopt.state = cur_state;
+                if (iob_write(&g_iob, fd_to_d, &adopt, sizeof(adopt)) == -1) {
+                    fprintf(logfile, "[B] STANDBY: adopt write failed: %s\n", strerror(errno));
+                }
 
-                fprintf(logfile, "RESET requested (O)\n");
+                g_sb.failovers++;
+                g_sb.last_switch_us = (monotonic_now_sec() - now) * 1e6;
+                g_primary_last      = monotonic_now_sec();
+                char cause[48];
+                if (d_exited) snprintf(cause, sizeof(cause), "exited");
+                else          snprintf(cause, sizeof(cause), "silent %.1f ms", silent * 1000.0);
+                fprintf(logfile,
+                        "[B] FAILOVER #%d: primary %s -> replica pid %d promoted in %.0f us\n",
+                        g_sb.failovers, cause, (int)peers.pid_D, g_sb.last_switch_us);
+                notify_watchdog(fd_to_w, &peers, logfile);
+                watch_child("D", peers.pid_D, logfile);
+
+                // New standby in the background (fork + sync, no waiting on it)
+                if (g_sb.enabled && standby_spawn(&g_sb, &params, logfile) == 0) {
+                    standby_sync(&g_sb, &g_iob, &g_force_last, &cur_state, logfile);
+                }
                 fflush(logfile);
+
+                iob_end_tick(&g_iob);   // adopt + sync go out now
+                continue;               // rfds refer to the old channel
             }
-            // ------------------------------------------------------------------
-            // Handles Directional keys and the break 'd'
-            // ------------------------------------------------------------------
-            else {
-                double dFx, dFy;
-                direction_from_key(km.key, &dFx, &dFy);
-
-                if (!paused) {
-                    if (km.key == 'd') {
-                        // Brake: Zeroes forces
-                        cur_force.Fx = 0.0;
-                        cur_force.Fy = 0.0;
-                    } else {
-                        // Accumulates new force
-                        cur_force.Fx += dFx * params.force_step;
-                        cur_force.Fy += dFy * params.force_step;
-                    }
+        }
 
-                    cur_force.reset = 0;
+        // ------------------------------------------------------------------
+        // External controllers: connections, commands, arbitration
+        // ------------------------------------------------------------------
+        if (sel > 0) {
+            ForceStateMsg ctrl_force = cur_force;
+            if (ctrl_handle(&g_ctrl, &rfds, &ctrl_force, logfile) && !paused) {
+                cur_force.Fx = ctrl_force.Fx;   // pause freezes forces for controllers too
+                cur_force.Fy = ctrl_force.Fy;
+                request_force(&cur_force, "ctrl");
+            }
+        }
 
-                    send_total_force_to_d(&cur_force,
-                        &cur_state,
-                        &params,
-                        g_obstacles,
-                        NUM_OBSTACLES,
-                        fd_to_d,
-                        logfile,
-                        "key");
+        // ------------------------------------------------------------------
+        // Handles keyboard input from I (if available).
+        // ------------------------------------------------------------------
+        if (fd_kb != -1 && FD_ISSET(fd_kb, &rfds)) {
+            KeyBatchMsg kb;
+            int n = read(fd_kb, &kb, sizeof(kb));
+            if (n <= 0 && headless) {
+                // No terminal in soak mode: I sees EOF at once, B keeps running
+                fprintf(logfile, "[B] Keyboard ended (EOF) -> soak input only\n");
+                fflush(logfile);
+                close(fd_kb);
+                fd_kb = -1;
+                continue;
+            }
+            if (n <= 0) {
+                mvprintw(0, 1, "[B] Keyboard process ended (EOF).");
+                refresh();
+                break;
+            }
+            if (n != (int)sizeof(kb)) {
+                // I writes whole batches (below PIPE_BUF); anything else is not one
+                fprintf(logfile, "[B] short keyboard batch (%d of %zu bytes), ignored\n",
+                        n, sizeof(kb));
+                continue;
+            }
 
-                    fprintf(logfile,
-                            "KEY: %c  dFx=%.1f dFy=%.1f -> Fx=%.2f Fy=%.2f\n",
-                            km.key, dFx, dFy, cur_force.Fx, cur_force.Fy);
-                    fflush(logfile);
-                } else {
-                    // Paused: Ignores directional changes (but still log)
-                    fprintf(logfile,
-                            "KEY: %c ignored (PAUSED)\n", km.key);
-                    fflush(logfile);
+            // Applies the whole batch, then sends a single force update
+            bool force_dirty = false;
+            bool quit        = false;
+            int  presses     = 0;
+            for (int i = 0; i < kb.n && i < KEY_BATCH_MAX; ++i) {
+                const KeyEvent *ev = &kb.ev[i];
+                last_key = ev->key;
+                presses += ev->count;
+                if (apply_key(ev->key, ev->count, &force_dirty, &cur_force, &cur_state,
+                              &paused, &params, logfile)) {
+                    quit = true;   // 'q'
+                    break;
                 }
             }
+            if (kb.n > 0) {
+                // Input latency: oldest key in the batch, from I's read() to here
+                double age_ms = (monotonic_now_sec() - 1e-9 * (double)kb.ev[0].t_ns) * 1000.0;
+                LOGC(LOGC_KEYS, LOGL_DEBUG, 0, "[B] KEYS batch: %d event(s), %d press(es), age=%.3fms\n",
+                     kb.n, presses, age_ms);
+                if ((float)age_ms > g_tlm_input_ms) g_tlm_input_ms = (float)age_ms;
+            }
+            if (quit) break;
+
+            if (force_dirty) request_force(&cur_force, "key");
         }
 
+        pc_lap(&g_pc, BPH_INPUT);   // standby, controllers, keyboard
+
         // ------------------------------------------------------------------
         // 4) Handles state updates from D (if available).
         // ------------------------------------------------------------------
@@ -453,9 +1271,19 @@ void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int f
                     fflush(logfile);
                 }
             }
+            else if (n <= 0 && g_sb.pid > 0) {
+                // Crashed primary: its pipe closes first (and without pidfds
+                // nothing else reports it), so promote the replica
+                fprintf(logfile, "[B] EOF from D (pid %d) -> failing over\n", (int)peers.pid_D);
+                fflush(logfile);
+                d_eof = 1;
+                continue;
+            }
             else if (n <= 0) {
-                mvprintw(1, 1, "[B] Dynamics process ended (EOF).");
-                refresh();
+                if (!headless) {
+                    mvprintw(1, 1, "[B] Dynamics process ended (EOF).");
+                    refresh();
+                }
                 break;
             } else {
                 // partial read (should not happen with pipes + small struct, but handle anyway)
@@ -468,54 +1296,95 @@ void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int f
 
             // Updates current state
             cur_state = s;
+            trail_push(&g_trails.drone[0], s.x, s.y);
+
+            // Primary met its deadline; periodically re-syncs the standby to it
+            g_primary_last = monotonic_now_sec();
+            g_primary_ticks++;
+            if (g_primary_ticks == 1) pool_first_tick(logfile);   // time to first tick
+            force_on_tick();
+
+            // State stream to controllers; a silent owner loses control (and its force)
+            ctrl_publish_state(&g_ctrl, &s, (int)g_primary_ticks, &cur_force);
+            if (ctrl_check_timeout(&g_ctrl, g_primary_last, params.ctrl_timeout_sec, logfile)) {
+                cur_force.Fx = 0.0;
+                cur_force.Fy = 0.0;
+                request_force(&cur_force, "ctrl");
+            }
+            if (g_sb.pid > 0 && g_primary_ticks % STANDBY_SYNC_TICKS == 0) {
+                standby_sync(&g_sb, &g_iob, &g_force_last, &cur_state, logfile);
+            }
 
             // Increments global step counter (one more state update)
             if (!paused) {
                 g_step_counter++;
             }   
 
-            // Logs state
-            fprintf(logfile,
-                    "STATE: x=%.2f y=%.2f vx=%.2f vy=%.2f\n",
-                    s.x, s.y, s.vx, s.vy);
-            fflush(logfile);
-            // Checks for target hits (only when not paused)
+            // Logs state (sampled / on change per log_state_every, log_state_on_change)
+            LOGC(LOGC_STATE, LOGL_DEBUG, logc_key4(s.x, s.y, s.vx, s.vy, 100.0),
+                 "STATE: x=%.2f y=%.2f vx=%.2f vy=%.2f\n", s.x, s.y, s.vx, s.vy);
+            // Checks for target hits, then ages obstacles and targets by one
+            // step (only when not paused); each state from D is one sim step
+            // (only targets from the neighbor list can be within the hit radius)
             if (!paused) {
-                int hits = check_target_hits(&cur_state,
-                                            g_targets,
-                                            NUM_TARGETS,
-                                            &params,
-                                            &g_score,
-                                            &g_targets_collected,
-                                            &g_last_hit_step,
-                                            g_step_counter);
+                const EcsArchetype *o = &g_world.arch[ECS_OBSTACLE];
+                const EcsArchetype *t = &g_world.arch[ECS_TARGET];
+                int n_obs = o->n, n_tgt = t->n;
+                g_sim.params     = &params;
+                g_sim.tgt_rows   = g_nbr_tgt.idx;
+                g_sim.n_tgt_rows = nbr_query(&g_nbr_tgt, cur_state.x, cur_state.y,
+                                             params.world_half * TARGET_HIT_FRAC, params.nbr_skin,
+                                             t->x, t->y, t->n, g_wh.group[WH_TARGETS]);
+                g_sim.hits = 0;
+                world_set_drone(&cur_state);
+                ecs_sched_run(&g_sched, &g_world);
+                if (o->n != n_obs) rehash_slots(ECS_OBSTACLE);
+                if (t->n != n_tgt) rehash_slots(ECS_TARGET);
+
+                int hits = (int)g_sim.hits;
                 if (hits > 0) {
+                    g_score             += hits;
+                    g_targets_collected += hits;
+                    g_last_hit_step      = g_step_counter;
                     fprintf(logfile,
                             "[B] Collected %d target(s). SCORE=%d\n",
                             hits, g_score);
                     fflush(logfile);
                 }
             }
-            // Decrements obstacles and targets lifetimes 
-            // Considers each time input is received from D, 1 sim time had elapsed
-            // Only age obstacles & targets when simulation is running
-            if (!paused){    
-                for (int i = 0; i < NUM_OBSTACLES; ++i) {
-                    if (g_obstacles[i].active && g_obstacles[i].life_steps > 0) {
-                        g_obstacles[i].life_steps--;   // Decreases 1 step from its lifetime
-                        if (g_obstacles[i].life_steps == 0) {
-                            g_obstacles[i].active = 0;
-                        }
-                    }
-                }
-                for (int i = 0; i < NUM_TARGETS; ++i) {
-                    if (g_targets[i].active && g_targets[i].life_steps > 0) {
-                        g_targets[i].life_steps--;
-                        if (g_targets[i].life_steps == 0) {
-                            g_targets[i].active = 0;
-                        }
-                    }
-                }
+
+            // World hash after this tick (entity slots were re-hashed where they changed)
+            wh_set_drone(&g_wh, &s);
+            wh_set_force(&g_wh, &cur_force);
+            wh_set_score(&g_wh, g_score, g_targets_collected);
+            WhStreams streams = {
+                .obs_batches = (uint64_t)g_chan_obs.msgs,
+                .tgt_batches = (uint64_t)g_chan_tgt.msgs,
+                .soak_rng    = headless ? g_soak.rng : 0,
+                .scn_cursor  = (uint64_t)(g_scn_obs_next + g_scn_tgt_next + g_scn_key_next),
+            };
+            wh_set_streams(&g_wh, &streams);
+
+            // Records this tick (state after hits, user force that produced it)
+            if (g_tlm.fd != -1) {
+                double now = monotonic_now_sec();
+                TlmRow row = {
+                    .tick      = g_tlm_tick++,
+                    .x = s.x, .y = s.y, .vx = s.vx, .vy = s.vy,
+                    .fx        = (float)cur_force.Fx,
+                    .fy        = (float)cur_force.Fy,
+                    .score     = g_score,
+                    .collected = g_targets_collected,
+                    .tick_ms   = (float)((now - g_tlm_last_state) * 1000.0),
+                    .input_ms  = g_tlm_input_ms,
+                    .flags     = (uint8_t)((paused ? TLM_FLAG_PAUSED : 0) |
+                                           (ctrl_has_owner(&g_ctrl) ? TLM_FLAG_CTRL : 0)),
+                    .hash      = wh_world(&g_wh),
+                };
+                memcpy(row.group_hash, g_wh.group, sizeof(row.group_hash));
+                tlm_append(&g_tlm, &row);
+                g_tlm_last_state = now;
+                g_tlm_input_ms   = -1.0f;
             }
             // Update blinking phase only while running (not paused)
             if (wd_warning_active && !paused) {
@@ -533,35 +1402,55 @@ void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int f
                 }
             }
 
+            // Soak mode: tick latency bookkeeping and the random input track
+            if (headless) {
+                soak_on_tick(&g_soak, monotonic_now_sec());
+                char k = soak_random_key(&g_soak);
+                if (k && !scn) {
+                    last_key = k;
+                    bool dirty = false;   // covered by this tick's "state" request below
+                    apply_key(k, 1, &dirty, &cur_force, &cur_state, &paused, &params, logfile);
+                }
+                if (soak_done(&g_soak, &params)) break;
+            }
+
+            // Replays scenario events due at this tick (waves, scripted keys, end)
+            if (scn) {
+                g_scn_tick++;
+                if (scenario_tick(scn, &cur_force, &cur_state, &paused,
+                                  &params, logfile)) {
+                    break;
+                }
+            }
 
-            // Then, sends updated total force (evenif user doesn't send cmd) (user + obstacles)
-            send_total_force_to_d(&cur_force,
-                                  &cur_state,
-                                  &params,
-                                  g_obstacles,
-                                  NUM_OBSTACLES,
-                                  fd_to_d,
-                                  logfile,
-                                  "state");
-                                  
+            // Autopilot: plans the user force for the next tick (a controller taking over disengages it)
+            if (g_mpc.active && ctrl_has_owner(&g_ctrl)) {
+                mpc_set_active(&g_mpc, 0, logfile);
+            } else if (g_mpc.active && !paused) {
+                mpc_plan(&g_mpc, &cur_state, &params, &g_world.arch[ECS_OBSTACLE],
+                         &g_world.arch[ECS_TARGET], &cur_force);
+            }
+
+            // Then, requests the updated total force (evenif user doesn't send cmd) (user + obstacles);
+            // repulsion changes with position, flush_force() decides whether D needs it
+            request_force(&cur_force, "state");
         }
 
+        pc_lap(&g_pc, BPH_STATE);
+
         // ------------------------------------------------------------------
         // Handles obstacle set messages from O
         // ------------------------------------------------------------------
-        if (FD_ISSET(fd_obs, &rfds)) {
+        fd_obs = chan_fd(&g_chan_obs);
+        if (fd_obs != -1 && FD_ISSET(fd_obs, &rfds)) {
             ObstacleSetMsg msg;
             int n = read(fd_obs, &msg, sizeof(msg));
-            if (n <= 0) {
-                // if nth read, O process ended; may log and continue
-                mvprintw(0, 1, "[B] Obstacle generator ended.");
-                // Optionally: fd_obs = -1 and stop using it
+            if (!chan_on_read(&g_chan_obs, n, &params, monotonic_now_sec(), logfile)) {
+                // O ended (channel closed, maybe restarted later) or interrupted read
             } else {
                 if (paused){
                     // Reads but ignores new obstacles while paused
-                    fprintf(logfile,
-                            "[B] Received obstacle set but PAUSED -> ignored.\n");
-                    fflush(logfile);
+                    LOGC(LOGC_ENTITY, LOGL_DEBUG, 0, "[B] Received obstacle set but PAUSED -> ignored.\n");
                 } else {
                     int requested = msg.count;
                     if (requested > NUM_OBSTACLES) requested = NUM_OBSTACLES;
@@ -576,36 +1465,26 @@ void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int f
                         double y = msg.obs[i].y;
 
                         // Rejects if too close to any active target
-                        if (too_close_to_any_pointlike(x, y,
-                               (PointLike*)g_obstacles,
-                               NUM_OBSTACLES,
-                               tgt_clearance)){
-                            fprintf(logfile,
-                                    "[B] Obstacle (%.2f, %.2f) rejected: too close to target.\n",
-                                    x, y);
+                        const EcsArchetype *o = &g_world.arch[ECS_OBSTACLE];
+                        if (too_close_to_any_point(x, y, o->x, o->y, o->n, tgt_clearance)){
+                            LOGC(LOGC_ENTITY, LOGL_DEBUG, 0,
+                                 "[B] Obstacle (%.2f, %.2f) rejected: too close to target.\n", x, y);
                             continue;
                         }
 
                         // Stores it if accepted index is within capacity
                         if (accepted < NUM_OBSTACLES) {
-                            g_obstacles[accepted].x          = x;
-                            g_obstacles[accepted].y          = y;
-                            g_obstacles[accepted].life_steps = msg.obs[i].life_steps;
-                            g_obstacles[accepted].active     = 1;
+                            put_slot(ECS_OBSTACLE, accepted, x, y, msg.obs[i].life_steps);
                             accepted++;
                         }
                     }
 
-                    // Deactivates remaining slots
-                    for (int i = accepted; i < NUM_OBSTACLES; ++i) {
-                        g_obstacles[i].active     = 0;
-                        g_obstacles[i].life_steps = 0;
-                    }
+                    // Empties remaining slots
+                    clear_slots_from(ECS_OBSTACLE, accepted);
+                    rehash_slots(ECS_OBSTACLE);
 
-                    fprintf(logfile,
-                            "[B] Accepted %d obstacles (requested %d).\n",
-                            accepted, requested);
-                    fflush(logfile);
+                    LOGC(LOGC_ENTITY, LOGL_INFO, 0,
+                         "[B] Accepted %d obstacles (requested %d).\n", accepted, requested);
                 }
 
             }
@@ -615,16 +1494,15 @@ void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int f
         // Handles target-set messages from T
         // ------------------------------------------------------------------
 
-        if (FD_ISSET(fd_tgt, &rfds)) {
+        fd_tgt = chan_fd(&g_chan_tgt);
+        if (fd_tgt != -1 && FD_ISSET(fd_tgt, &rfds)) {
             TargetSetMsg msg;
             int n = read(fd_tgt, &msg, sizeof(msg));
-            if (n <= 0) {
-                mvprintw(1, 1, "[B] Target generator ended.");
+            if (!chan_on_read(&g_chan_tgt, n, &params, monotonic_now_sec(), logfile)) {
+                // T ended (channel closed, maybe restarted later) or interrupted read
             } else {
                 if (paused) {
-                    fprintf(logfile,
-                            "[B] Received target set but PAUSED -> ignored.\n");
-            fflush(logfile);
+                    LOGC(LOGC_ENTITY, LOGL_DEBUG, 0, "[B] Received target set but PAUSED -> ignored.\n");
         } else {
             int requested = msg.count;
             if (requested > NUM_TARGETS) requested = NUM_TARGETS;
@@ -641,198 +1519,158 @@ void run_server_process(int fd_kb, int fd_to_d, int fd_from_d, int fd_obs, int f
 
                 // Rejects if too close to walls
                 if (target_too_close_to_wall(x, y, &params, wall_margin)) {
-                    fprintf(logfile,
-                            "[B] Target (%.2f,%.2f) rejected: too close to walls.\n",
-                            x, y);
+                    LOGC(LOGC_ENTITY, LOGL_DEBUG, 0,
+                         "[B] Target (%.2f,%.2f) rejected: too close to walls.\n", x, y);
                     continue;
                 }
 
                 // Rejects if too close to obstacles
-                if (too_close_to_any_pointlike(x, y,
-                               (PointLike*)g_targets,
-                               NUM_TARGETS,
-                               obs_clearance)){
-                    fprintf(logfile,
-                            "[B] Target (%.2f,%.2f) rejected: too close to obstacles.\n",
-                            x, y);
+                const EcsArchetype *t = &g_world.arch[ECS_TARGET];
+                if (too_close_to_any_point(x, y, t->x, t->y, t->n, obs_clearance)){
+                    LOGC(LOGC_ENTITY, LOGL_DEBUG, 0,
+                         "[B] Target (%.2f,%.2f) rejected: too close to obstacles.\n", x, y);
                     continue;
                 }
 
                 // Accepts target if it passed the above checks
                 if (accepted < NUM_TARGETS) {
-                    g_targets[accepted].x          = x;
-                    g_targets[accepted].y          = y;
-                    g_targets[accepted].life_steps = msg.tgt[i].life_steps;
-                    g_targets[accepted].active     = 1;
+                    put_slot(ECS_TARGET, accepted, x, y, msg.tgt[i].life_steps);
                     accepted++;
                 }
             }
 
-            // Deactivates remaining slots
-            for (int i = accepted; i < NUM_TARGETS; ++i) {
-                g_targets[i].active     = 0;
-                g_targets[i].life_steps = 0;
-            }
+            // Empties remaining slots
+            clear_slots_from(ECS_TARGET, accepted);
+            rehash_slots(ECS_TARGET);
 
-            fprintf(logfile,
-                    "[B] Accepted %d targets (requested %d).\n",
-                    accepted, requested);
-            fflush(logfile);
+            LOGC(LOGC_ENTITY, LOGL_INFO, 0,
+                 "[B] Accepted %d targets (requested %d).\n", accepted, requested);
         }
     }
 
 }
         // ------------------------------------------------------------------
-        // Draws UI (drone world + inspection panel)
+        // Generator channel lifecycle: reap, drain, restart (W learns new pids)
         // ------------------------------------------------------------------
-        erase();
-        box(stdscr, 0, 0);
-
-        // Top info lines
-        mvprintw(top_info_y1, 2,
-                 "Controls: w e r / s d f / x c v | d=brake, p=pause, O=reset, q=quit");
-        mvprintw(top_info_y2, 2,
-                 "Paused: %s", paused ? "YES" : "NO");
-        
-        // Watchdog blinking warning: visible only when active AND blink phase is ON
-        // --- Watchdog live timing info ---
-        double age = hb_age_sec();  // seconds since last valid DroneStateMsg
-        double warn_in = (double)params.wd_warn_sec - age;
-        double kill_in = (double)params.wd_kill_sec - age;
-
-        if (warn_in < 0) warn_in = 0;
-        if (kill_in < 0) kill_in = 0;
-
-        if (wd_warning_active && wd_blink_phase) {
-            // If colors exist, use a red-ish pair. Otherwise use reverse + bold.
-            if (has_colors()) {
-                // Create once somewhere during init if you want:
-                // init_pair(3, COLOR_RED, COLOR_BLACK);
-                attron(COLOR_PAIR(3) | A_BOLD | A_REVERSE);
-                mvprintw(top_info_y2, 18, " %s ", watchdog_banner_msg);
-                mvprintw(top_info_y2, 60, "KILL IN: %.2fs", kill_in);
-                attroff(COLOR_PAIR(3) | A_BOLD | A_REVERSE);
-            } else {
-                attron(A_BOLD | A_REVERSE);
-                mvprintw(top_info_y2, 18, " %s ", watchdog_banner_msg);
-                mvprintw(top_info_y2, 60, "KILL IN: %.2fs", kill_in);
-                attroff(A_BOLD | A_REVERSE);
-            }
-        }
-
-
-
-        
-
-        // Horizontal separator row (under top info)
-        if (sep_y >= 1 && sep_y <= max_y - 2) {
-            for (int x = 1; x < max_x - 1; ++x) {
-                mvaddch(sep_y, x, '-');
+        {
+            double now   = monotonic_now_sec();
+            int changed  = chan_poll(&g_chan_obs, &params, now, logfile);
+            changed     |= chan_poll(&g_chan_tgt, &params, now, logfile);
+            if (changed) {
+                if (g_chan_obs.entry) peers.pid_O = g_chan_obs.pid;   // -1 while down
+                if (g_chan_tgt.entry) peers.pid_T = g_chan_tgt.pid;
+                notify_watchdog(fd_to_w, &peers, logfile);
+                watch_child("O", peers.pid_O, logfile);
+                watch_child("T", peers.pid_T, logfile);
             }
         }
 
-        // Vertical separator between world and inspection
-        int sep_x = insp_start_x - 1;
-        if (sep_x > 1 && sep_x < max_x - 1) {
-            for (int y = world_top; y <= world_bottom; ++y) {
-                mvaddch(y, sep_x, '|');
-            }
-        }
+        pc_lap(&g_pc, BPH_GEN);   // O/T messages + channel lifecycle
 
-        // WORLD DRAWING (left)
-        double world_half = params.world_half;
-        double scale_x = main_width  / (2.0 * world_half);        // Maps world coordinates to the drone world on the display scree
-        double scale_y = world_height / (2.0 * world_half);
-        if (scale_x <= 0) scale_x = 1.0;
-        if (scale_y <= 0) scale_y = 1.0;
-
-        int sx = (int)(cur_state.x * scale_x) + main_width / 2 + 1;
-        int sy = (int)(-cur_state.y * scale_y) + world_top + world_height / 2;
-
-        if (sx < 1) sx = 1;
-        if (sx > main_width) sx = main_width;
-        if (sy < world_top) sy = world_top;
-        if (sy > world_bottom) sy = world_bottom;
-
-        mvaddch(sy, sx, '+'); // Draws drone
-
-        // Draws active obstacles as 'o' in the drone world
-        for (int k = 0; k < NUM_OBSTACLES; ++k) {
-            if (!g_obstacles[k].active) continue;  // Skips inactive 
-
-            int ox = (int)(g_obstacles[k].x * scale_x) + main_width / 2 + 1;
-            int oy = (int)(-g_obstacles[k].y * scale_y) + world_top + world_height / 2;
-
-            if (ox < 1) ox = 1;
-            if (ox > main_width) ox = main_width;
-            if (oy < world_top) oy = world_top;
-            if (oy > world_bottom) oy = world_bottom;
-            
-            attron(COLOR_PAIR(1));
-            mvaddch(oy, ox, 'o');  // TODO: Adds color to make them orange
-            
-            attroff(COLOR_PAIR(1));
+        // ------------------------------------------------------------------
+        // Draws UI (drone world + inspection panel)
+        // ------------------------------------------------------------------
+        if (headless) soak_maybe_sample(&g_soak, monotonic_now_sec(), logfile);
+        else if (frame_due(monotonic_now_sec())) {
+            FAULT_SLEEP_MS(FLT_B_RENDER_MS);   // injected: slow render
+            draw_ui(&params, &cur_force, &cur_state, paused, last_key);
         }
 
-        for (int k = 0; k < NUM_TARGETS; ++k) {
-            if (!g_targets[k].active) continue;
-
-            int tx = (int)(g_targets[k].x * scale_x) + main_width / 2 + 1;
-            int ty = (int)(-g_targets[k].y * scale_y) + world_top + world_height / 2;
+        pc_lap(&g_pc, BPH_RENDER);
+
+        // At most one force command per D tick, only if it changed (or keepalive)
+        flush_force(&cur_force, &cur_state, &params, fd_to_d);
+        pc_lap(&g_pc, BPH_FORCE);
+        force_report(monotonic_now_sec(), logfile);
+        if (g_mpc.active) mpc_report(&g_mpc, monotonic_now_sec(), logfile);
+        logc_report(monotonic_now_sec());
+        fault_report(monotonic_now_sec(), logfile);
+        nbr_report(&g_nbr_obs, monotonic_now_sec(), 0, logfile);
+        nbr_report(&g_nbr_tgt, monotonic_now_sec(), 0, logfile);
+        pc_report(&g_pc, monotonic_now_sec(), 0, logfile);
+
+        // Submits this tick's force writes + log appends (one syscall with io_uring)
+        iob_end_tick(&g_iob);
+        iob_report(&g_iob, IOSTAT_WINDOW_TICKS);
+        pc_lap(&g_pc, BPH_IO);   // reports + batched writes
+    }
 
-            if (tx < 1) tx = 1;
-            if (tx > main_width) tx = main_width;
-            if (ty < world_top) ty = world_top;
-            if (ty > world_bottom) ty = world_bottom;
-            
-            attron(COLOR_PAIR(2));
-            mvaddch(ty, tx, 'T');  // Placeholder, later make them numbered
-            attroff(COLOR_PAIR(2));
-        }
+    // Scenario outcome (exit status tells benchmark scripts whether it passed)
+    int exit_status = EXIT_SUCCESS;
+    int scn_ok      = 1;
+    if (scn && g_scn_finished) {
+        scn_ok = scenario_check_expects(scn, g_score, g_targets_collected, logfile);
+        fprintf(logfile, "[SCENARIO] '%s' finished at tick %d: score=%d collected=%d -> %s\n",
+                scn->name, g_scn_tick, g_score, g_targets_collected, scn_ok ? "PASS" : "FAIL");
+        if (!scn_ok) exit_status = EXIT_FAILURE;
+    }
 
+    // Soak outcome: trend report with pass/fail thresholds
+    if (headless) {
+        int soak_ok = soak_finish(&g_soak, &params, monotonic_now_sec(), logfile);
+        fprintf(stderr, "[B] SOAK %s (see %s)\n", soak_ok ? "PASS" : "FAIL", SOAK_REPORT_PATH);
+        if (!soak_ok) exit_status = EXIT_FAILURE;
+    }
 
-        // INSPECTION panel on the right
-        int info_y = world_top;
-        int info_x = insp_start_x + 1;
+    // Two runs that should match (replays, lockstep, replicas) compare this line;
+    // arp1_analyze -d locates the first differing tick from their recordings
+    fprintf(logfile, "[B] WORLD HASH at tick %ld: %016llx (%ld slot update(s))\n",
+            g_primary_ticks, (unsigned long long)wh_world(&g_wh), g_wh.slot_updates);
+    nbr_report(&g_nbr_obs, 0.0, 1, logfile);
+    nbr_report(&g_nbr_tgt, 0.0, 1, logfile);
+    arena_report(&g_tick_arena, "tick", logfile);
+    pc_report(&g_pc, 0.0, 1, logfile);
+    pc_close(&g_pc);
+    pw_close(&g_pw);
+    ecs_sched_free(&g_sched);
+    ecs_free(&g_world);
+
+    // Steady-state ticks of B and D must not allocate (test builds only)
+    if (!ALLOC_CHECK_FINISH(logfile)) {
+        fprintf(stderr, "[B] ALLOC FAIL: a steady-state tick allocated (see logs/server.log)\n");
+        exit_status = EXIT_FAILURE;
+    }
 
-        
-        if (info_x < max_x - 1) {
-            mvprintw(info_y,     info_x, "INSPECTION");
-            mvprintw(info_y + 2, info_x, "Last key: %c", last_key);
-            mvprintw(info_y + 4, info_x, "Fx = %.2f", cur_force.Fx);
-            mvprintw(info_y + 5, info_x, "Fy = %.2f", cur_force.Fy);
-            mvprintw(info_y + 7, info_x, "x  = %.2f", cur_state.x);
-            mvprintw(info_y + 8, info_x, "y  = %.2f", cur_state.y);
-            mvprintw(info_y + 9, info_x, "vx = %.2f", cur_state.vx);
-            mvprintw(info_y +10, info_x, "vy = %.2f", cur_state.vy);
-            
-            mvprintw(info_y +12, info_x, "Score: %d", g_score);
-            mvprintw(info_y +13, info_x, "Targets collected: %d", g_targets_collected);
-            if (g_last_hit_step >= 0 ) {
-                time_since_last_hit = (g_step_counter - g_last_hit_step) * params .dt;
-
-                mvprintw(info_y +15, info_x, "Since last hit: %.2f sec", time_since_last_hit);
-            }
-            else {
-                mvprintw(info_y +14, info_x, "Last hit: none");
-            }
+    ctrl_close(&g_ctrl, CTRL_SOCKET_PATH);
 
-        }
+    // Writes the last (partial) telemetry block
+    tlm_close(&g_tlm);
 
-        refresh();
+    // Stops the replica (the primary exits on EOF like before)
+    if (g_sb.enabled) {
+        fprintf(logfile, "[B] STANDBY: %d failover(s), %d replica(s) forked, max sync drift %.4f\n",
+                g_sb.failovers, g_sb.generation, g_sb.max_drift);
+        standby_stop(&g_sb);
     }
 
+    // Stops the components: B returns and its caller reaps them, so W no
+    // longer sees B exit and would only notice the missing heartbeat
+    stop_child(peers.pid_I);
+    stop_child(peers.pid_D);
+    stop_child(peers.pid_O);
+    stop_child(peers.pid_T);
+    stop_child(pid_W);
+
     // Final cleanup
     if (logfile) {
         fprintf(logfile, "[B] Exiting.\n");
-        fclose(logfile);
+        iob_shutdown(&g_iob);
+        fclose(g_iob.log);
     }
     // Ends ncurses
-    endwin();
+    if (!headless) endwin();
     // Closes pipes
     close(fd_kb);
     close(fd_to_d);
     close(fd_from_d);
-    exit(EXIT_SUCCESS); 
+    if (chan_fd(&g_chan_obs) != -1) close(g_chan_obs.fd);
+    if (chan_fd(&g_chan_tgt) != -1) close(g_chan_tgt.fd);
+    if (fd_to_w != -1) close(fd_to_w);
+    if (scn && g_scn_finished) {
+        fprintf(stderr, "[SCENARIO] '%s': score=%d collected=%d world hash %016llx -> %s\n",
+                scn->name, g_score, g_targets_collected, (unsigned long long)wh_world(&g_wh),
+                scn_ok ? "PASS" : "FAIL");
+    }
+    return exit_status;
 }
 
@@ -0,0 +1,82 @@
+// sketch.c
+// DDSketch-style quantile sketch: value v goes to bucket ceil(log_gamma(v)),
+// gamma = (1 + alpha) / (1 - alpha), so each bucket spans a fixed ratio and
+// its midpoint estimate is within alpha of every value it holds.
+// ======================================================================
+
+#include "headers/sketch.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
+
+static double g_gamma     = 0.0;
+static double g_log_gamma = 0.0;
+static int    g_offset    = 0;    // bucket index of SKETCH_MIN_VAL
+
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+
+static void sketch_setup(void) {
+    g_gamma     = (1.0 + SKETCH_ALPHA) / (1.0 - SKETCH_ALPHA);
+    g_log_gamma = log(g_gamma);
+    g_offset    = (int)ceil(log(SKETCH_MIN_VAL) / g_log_gamma);
+}
+
+void sketch_init(QuantileSketch *s) {
+    pthread_once(&g_once, sketch_setup);   // analytics threads init sketches concurrently
+    memset(s, 0, sizeof(*s));
+}
+
+void sketch_add(QuantileSketch *s, double v) {
+    if (!(v >= 0.0)) return;    // also rejects NaN
+
+    if (s->n == 0 || v < s->min) s->min = v;
+    if (s->n == 0 || v > s->max) s->max = v;
+    s->sum += v;
+    s->n++;
+
+    if (v < SKETCH_MIN_VAL) {
+        s->zero_count++;
+        return;
+    }
+    int idx = (int)ceil(log(v) / g_log_gamma) - g_offset;
+    if (idx < 0) idx = 0;
+    if (idx >= SKETCH_BUCKETS) idx = SKETCH_BUCKETS - 1;
+    s->counts[idx]++;
+}
+
+void sketch_merge(QuantileSketch *dst, const QuantileSketch *src) {
+    if (src->n == 0) return;
+    if (dst->n == 0 || src->min < dst->min) dst->min = src->min;
+    if (dst->n == 0 || src->max > dst->max) dst->max = src->max;
+    dst->sum        += src->sum;
+    dst->n          += src->n;
+    dst->zero_count += src->zero_count;
+    for (int i = 0; i < SKETCH_BUCKETS; ++i) dst->counts[i] += src->counts[i];
+}
+
+double sketch_quantile(const QuantileSketch *s, double q) {
+    if (s->n == 0) return 0.0;
+    if (q <= 0.0) return s->min;
+    if (q >= 1.0) return s->max;
+
+    long rank = (long)(q * (double)(s->n - 1));
+    if (rank < s->zero_count) return s->min < SKETCH_MIN_VAL ? s->min : 0.0;
+
+    long seen = s->zero_count;
+    for (int i = 0; i < SKETCH_BUCKETS; ++i) {
+        seen += s->counts[i];
+        if (seen > rank) {
+            // Bucket i holds (gamma^(k-1), gamma^k]; 2*gamma^k/(gamma+1) is within alpha of both ends
+            double v = 2.0 * pow(g_gamma, i + g_offset) / (g_gamma + 1.0);
+            if (v < s->min) v = s->min;
+            if (v > s->max) v = s->max;
+            return v;
+        }
+    }
+    return s->max;
+}
+
+double sketch_mean(const QuantileSketch *s) {
+    return s->n > 0 ? s->sum / (double)s->n : 0.0;
+}
@@ -0,0 +1,355 @@
+// soak.c
+// Soak test monitor: periodic samples of the whole process tree and a
+// trend report with pass/fail verdicts.
+// ======================================================================
+
+#include "headers/soak.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+// /proc helpers
+// ----------------------------------------------------------------------
+// Samples run on B's tick, which must not allocate (alloccheck.h): files are
+// read with open()/read() into stack buffers and directories are listed with
+// getdents64() into a static buffer (opendir() and fopen() both malloc).
+// /proc and logs/ stay open from soak_init() to soak_finish().
+
+struct dirent64_raw {
+    unsigned long long d_ino;
+    long long          d_off;
+    unsigned short     d_reclen;
+    unsigned char      d_type;
+    char               d_name[];
+};
+
+typedef struct {
+    int  fd;
+    long pos, len;
+} DirScan;
+
+static char g_dents[32768];   // one directory at a time
+
+// Restarts a listing of an open directory fd.
+static void dir_rewind(DirScan *ds, int fd) {
+    ds->fd  = fd;
+    ds->pos = ds->len = 0;
+    lseek(fd, 0, SEEK_SET);
+}
+
+// Next entry name (".", ".." skipped), NULL at the end.
+static const char *dir_next(DirScan *ds) {
+    for (;;) {
+        if (ds->pos >= ds->len) {
+            ds->len = syscall(SYS_getdents64, ds->fd, g_dents, sizeof(g_dents));
+            ds->pos = 0;
+            if (ds->len <= 0) return NULL;
+        }
+        struct dirent64_raw *e = (struct dirent64_raw *)(g_dents + ds->pos);
+        ds->pos += e->d_reclen;
+        if (strcmp(e->d_name, ".") != 0 && strcmp(e->d_name, "..") != 0) return e->d_name;
+    }
+}
+
+// Reads a small file into buf (NUL-terminated). Returns the length, -1 if unreadable.
+static int read_small(const char *path, char *buf, size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return -1;
+    ssize_t n = read(fd, buf, size - 1);
+    close(fd);
+    if (n < 0) return -1;
+    buf[n] = '\0';
+    return (int)n;
+}
+
+// Resident set size of one process in kB (0 if unreadable).
+static long proc_rss_kb(pid_t pid) {
+    char path[64], buf[128];
+    snprintf(path, sizeof(path), "/proc/%d/statm", (int)pid);
+    if (read_small(path, buf, sizeof(buf)) < 0) return 0;
+
+    long size = 0, resident = 0;
+    if (sscanf(buf, "%ld %ld", &size, &resident) != 2) resident = 0;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// Number of open fds of one process (0 if unreadable).
+static int proc_fd_count(pid_t pid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/fd", (int)pid);
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) return 0;
+
+    DirScan ds;
+    int n = 0;
+    dir_rewind(&ds, fd);
+    while (dir_next(&ds)) n++;
+    close(fd);
+    return n - 1;   // the directory itself holds one fd while counting our own process
+}
+
+// Parent pid from /proc/<pid>/stat (-1 if unreadable).
+static pid_t proc_ppid(pid_t pid) {
+    char path[64], buf[512];
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    if (read_small(path, buf, sizeof(buf)) < 0) return -1;
+
+    // Format: pid (comm) state ppid ...  (comm may contain spaces)
+    char *rp = strrchr(buf, ')');
+    if (!rp) return -1;
+    char state;
+    int ppid;
+    if (sscanf(rp + 1, " %c %d", &state, &ppid) != 2) return -1;
+    return (pid_t)ppid;
+}
+
+// Sums RSS and fd counts over B and its direct children (I, D, O, T, W).
+static void tree_usage(int proc_fd, long *rss_kb, int *fds) {
+    pid_t self = getpid();
+    *rss_kb = proc_rss_kb(self);
+    *fds    = proc_fd_count(self);
+    if (proc_fd == -1) return;
+
+    // Pids are collected first: proc_fd_count() reuses the listing buffer
+    pid_t pids[256];
+    int   n = 0;
+    DirScan ds;
+    const char *name;
+    dir_rewind(&ds, proc_fd);
+    while ((name = dir_next(&ds)) != NULL && n < (int)(sizeof(pids) / sizeof(pids[0]))) {
+        char *end;
+        long pid = strtol(name, &end, 10);
+        if (*end != '\0' || pid <= 0 || pid == self) continue;
+        if (proc_ppid((pid_t)pid) == self) pids[n++] = (pid_t)pid;
+    }
+    for (int i = 0; i < n; ++i) {
+        *rss_kb += proc_rss_kb(pids[i]);
+        *fds    += proc_fd_count(pids[i]) + 1;   // +1: no directory fd inside the child
+    }
+}
+
+// Total size of logs/*.log.
+static long logs_total_bytes(int logs_fd) {
+    if (logs_fd == -1) return 0;
+
+    long total = 0;
+    DirScan ds;
+    const char *name;
+    dir_rewind(&ds, logs_fd);
+    while ((name = dir_next(&ds)) != NULL) {
+        size_t len = strlen(name);
+        if (len < 5 || strcmp(name + len - 4, ".log") != 0) continue;
+        struct stat st;
+        if (fstatat(logs_fd, name, &st, 0) == 0) total += (long)st.st_size;
+    }
+    return total;
+}
+
+// Statistics helpers
+// ----------------------------------------------------------------------
+// k-th smallest of v[0..n) (quickselect, in place: qsort() may malloc a
+// merge buffer for large arrays). v is reordered.
+static double select_kth(double *v, int n, int k) {
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        double pivot = v[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (v[i] < pivot) i++;
+            while (v[j] > pivot) j--;
+            if (i <= j) {
+                double t = v[i]; v[i] = v[j]; v[j] = t;
+                i++; j--;
+            }
+        }
+        if      (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else             break;
+    }
+    return v[k];
+}
+
+static double percentile(double *v, int n, double q) {
+    if (n <= 0) return 0.0;
+    int idx = (int)(q * (n - 1) + 0.5);
+    return select_kth(v, n, idx);
+}
+
+// Least-squares slope of y over x.
+static double slope(const double *x, const double *y, int n) {
+    if (n < 2) return 0.0;
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (int i = 0; i < n; ++i) {
+        sx += x[i]; sy += y[i];
+        sxx += x[i] * x[i]; sxy += x[i] * y[i];
+    }
+    double den = n * sxx - sx * sx;
+    return (fabs(den) < 1e-12) ? 0.0 : (n * sxy - sx * sy) / den;
+}
+
+// Public API
+// ----------------------------------------------------------------------
+void soak_init(SoakMonitor *m, const SimParams *p, double now_wall) {
+    memset(m, 0, sizeof(*m));
+    double scale = (p->time_scale > 0.0) ? p->time_scale : 1.0;
+
+    m->dt               = p->dt;
+    m->sim_sec_target   = p->soak_sim_sec;
+    m->sample_sec       = (p->soak_sample_sec > 0.0) ? p->soak_sample_sec : 10.0;
+    m->nominal_ms       = 1000.0 * p->dt / scale;
+    m->expected_rate    = scale / p->dt;
+    m->near_miss_ms     = 1000.0 * SOAK_NEAR_MISS_FRACTION * p->wd_warn_sec;
+    m->start_wall       = now_wall;
+    m->last_sample_wall = now_wall;
+    m->last_tick_wall   = now_wall;
+    m->proc_fd          = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    m->logs_fd          = open("logs", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    m->window_start_log_bytes = logs_total_bytes(m->logs_fd);
+    m->rng              = (unsigned)getpid() ^ (unsigned)(now_wall * 1000.0);
+}
+
+void soak_on_tick(SoakMonitor *m, double now_wall) {
+    double gap_ms = 1000.0 * (now_wall - m->last_tick_wall);
+    m->last_tick_wall = now_wall;
+    m->ticks++;
+    m->window_ticks++;
+
+    if (m->n_lat < SOAK_LAT_WINDOW) m->lat_ms[m->n_lat++] = gap_ms;
+    if (gap_ms >= m->near_miss_ms) m->window_near_misses++;
+}
+
+static void take_sample(SoakMonitor *m, double now_wall, FILE *log) {
+    double window = now_wall - m->last_sample_wall;
+    if (window <= 0.0) return;
+
+    SoakSample s;
+    memset(&s, 0, sizeof(s));
+    s.wall_sec  = now_wall - m->start_wall;
+    s.sim_hours = (double)m->ticks * m->dt / 3600.0;
+    tree_usage(m->proc_fd, &s.rss_kb, &s.fds);
+    s.log_bytes = logs_total_bytes(m->logs_fd);
+    s.log_bytes_per_tick = m->window_ticks > 0
+        ? (double)(s.log_bytes - m->window_start_log_bytes) / (double)m->window_ticks : 0.0;
+
+    s.max_ms = 0.0;
+    for (int i = 0; i < m->n_lat; ++i)
+        if (m->lat_ms[i] > s.max_ms) s.max_ms = m->lat_ms[i];
+    s.p50_ms = percentile(m->lat_ms, m->n_lat, 0.50);
+    s.p99_ms = percentile(m->lat_ms, m->n_lat, 0.99);
+
+    s.tick_rate   = (double)m->window_ticks / window;
+    s.drift_pct   = 100.0 * (s.tick_rate - m->expected_rate) / m->expected_rate;
+    s.near_misses = m->window_near_misses;
+
+    if (m->n_samples < SOAK_MAX_SAMPLES) m->samples[m->n_samples++] = s;
+
+    if (log) {
+        fprintf(log,
+                "[B] SOAK sim=%.2fh wall=%.0fs rss=%ldkB fds=%d log=%ldB (%.1fB/tick) "
+                "p50=%.2fms p99=%.2fms max=%.2fms rate=%.1f/s drift=%+.1f%% near_miss=%d\n",
+                s.sim_hours, s.wall_sec, s.rss_kb, s.fds, s.log_bytes, s.log_bytes_per_tick,
+                s.p50_ms, s.p99_ms, s.max_ms, s.tick_rate, s.drift_pct, s.near_misses);
+        fflush(log);
+    }
+
+    m->last_sample_wall       = now_wall;
+    m->window_ticks           = 0;
+    m->window_near_misses     = 0;
+    m->window_start_log_bytes = s.log_bytes;
+    m->n_lat                  = 0;
+}
+
+int soak_maybe_sample(SoakMonitor *m, double now_wall, FILE *log) {
+    if (now_wall - m->last_sample_wall < m->sample_sec) return 0;
+    take_sample(m, now_wall, log);
+    return 1;
+}
+
+int soak_done(const SoakMonitor *m, const SimParams *p) {
+    return (double)m->ticks * p->dt >= m->sim_sec_target;
+}
+
+char soak_random_key(SoakMonitor *m) {
+    static const char keys[] = "wersdfxcv";
+    if (m->ticks % SOAK_INPUT_PERIOD != 0) return 0;
+    return keys[rand_r(&m->rng) % (sizeof(keys) - 1)];
+}
+
+int soak_finish(SoakMonitor *m, const SimParams *p, double now_wall, FILE *log) {
+    take_sample(m, now_wall, log);
+    if (m->proc_fd != -1) close(m->proc_fd);
+    if (m->logs_fd != -1) close(m->logs_fd);
+    m->proc_fd = m->logs_fd = -1;
+
+    int n = m->n_samples;
+    FILE *fp = fopen(SOAK_REPORT_PATH, "w");
+    if (!fp) {
+        if (log) fprintf(log, "[B] SOAK cannot write %s\n", SOAK_REPORT_PATH);
+        return 0;
+    }
+
+    fprintf(fp, "# Soak report: %.2f simulated hours in %.0f wall seconds (time_scale=%.1f, dt=%.3f)\n",
+            (double)m->ticks * p->dt / 3600.0, now_wall - m->start_wall, p->time_scale, p->dt);
+    fprintf(fp, "# sim_h   wall_s   rss_kB   fds   log_B       B/tick   p50_ms  p99_ms  max_ms  rate/s   drift%%  near_miss\n");
+
+    static double xs[SOAK_MAX_SAMPLES], rss[SOAK_MAX_SAMPLES], p99[SOAK_MAX_SAMPLES], drift[SOAK_MAX_SAMPLES];
+    int total_near = 0;
+    double worst_p99 = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const SoakSample *s = &m->samples[i];
+        fprintf(fp, "%7.3f %8.0f %8ld %5d %10ld %8.1f %7.2f %7.2f %7.2f %8.1f %+7.1f %5d\n",
+                s->sim_hours, s->wall_sec, s->rss_kb, s->fds, s->log_bytes, s->log_bytes_per_tick,
+                s->p50_ms, s->p99_ms, s->max_ms, s->tick_rate, s->drift_pct, s->near_misses);
+        xs[i]    = s->sim_hours;
+        rss[i]   = (double)s->rss_kb;
+        p99[i]   = s->p99_ms;
+        drift[i] = s->drift_pct;
+        total_near += s->near_misses;
+        if (s->p99_ms > worst_p99) worst_p99 = s->p99_ms;
+    }
+
+    // Trends (per simulated hour) and verdicts.
+    // The first sample is warm-up (ncurses-free startup, log headers), so trends start at sample 1.
+    int    k          = n > 2 ? 1 : 0;
+    double rss_slope  = slope(xs + k, rss + k, n - k);
+    double p99_slope  = slope(xs + k, p99 + k, n - k);
+    double drift_avg  = 0.0;
+    for (int i = k; i < n; ++i) drift_avg += drift[i];
+    drift_avg = (n - k > 0) ? drift_avg / (n - k) : 0.0;
+
+    int    fd_growth  = n > 1 ? m->samples[n - 1].fds - m->samples[k].fds : 0;
+    double log_first  = n > 1 ? m->samples[k].log_bytes_per_tick : 0.0;
+    double log_last   = n > 1 ? m->samples[n - 1].log_bytes_per_tick : 0.0;
+    double log_growth = log_first > 0.0 ? log_last / log_first : 1.0;
+
+    int ok_rss   = rss_slope <= SOAK_MAX_RSS_SLOPE_KB;
+    int ok_fd    = fd_growth <= SOAK_MAX_FD_GROWTH;
+    int ok_drift = fabs(drift_avg) <= SOAK_MAX_DRIFT_PCT;
+    int ok_p99   = worst_p99 <= SOAK_MAX_P99_FACTOR * m->nominal_ms;
+    int ok_log   = log_growth <= SOAK_MAX_LOG_RATE_GROWTH;
+    int ok_near  = total_near == 0;
+    int ok_all   = ok_rss && ok_fd && ok_drift && ok_p99 && ok_log && ok_near;
+
+    fprintf(fp, "\n# Trends\n");
+    fprintf(fp, "rss_slope_kB_per_sim_hour   %10.1f  (max %.1f)  %s\n", rss_slope, SOAK_MAX_RSS_SLOPE_KB, ok_rss ? "PASS" : "FAIL");
+    fprintf(fp, "fd_growth                   %10d  (max %d)    %s\n", fd_growth, SOAK_MAX_FD_GROWTH, ok_fd ? "PASS" : "FAIL");
+    fprintf(fp, "tick_rate_drift_avg_pct     %+10.2f  (max %.1f)  %s\n", drift_avg, SOAK_MAX_DRIFT_PCT, ok_drift ? "PASS" : "FAIL");
+    fprintf(fp, "p99_interval_worst_ms       %10.2f  (max %.2f)  %s\n", worst_p99, SOAK_MAX_P99_FACTOR * m->nominal_ms, ok_p99 ? "PASS" : "FAIL");
+    fprintf(fp, "p99_slope_ms_per_sim_hour   %10.3f  (info)\n", p99_slope);
+    fprintf(fp, "log_bytes_per_tick_growth   %10.2f  (max %.2f)  %s\n", log_growth, SOAK_MAX_LOG_RATE_GROWTH, ok_log ? "PASS" : "FAIL");
+    fprintf(fp, "watchdog_near_misses        %10d  (max 0)     %s\n", total_near, ok_near ? "PASS" : "FAIL");
+    fprintf(fp, "\nRESULT %s\n", ok_all ? "PASS" : "FAIL");
+    fclose(fp);
+
+    if (log) {
+        fprintf(log, "[B] SOAK finished: %s (report: %s)\n", ok_all ? "PASS" : "FAIL", SOAK_REPORT_PATH);
+        fflush(log);
+    }
+    return ok_all;
+}
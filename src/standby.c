@@ -0,0 +1,114 @@
+// standby.c
+// Hot-standby D replica: fork, shadow, sync, promotion bookkeeping
+// ======================================================================
+
+#include "headers/standby.h"
+#include "headers/dynamics.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+int standby_spawn(Standby *sb, const SimParams *p, FILE *log) {
+    if (sb->generation >= STANDBY_MAX_SPAWNS) {
+        if (log) fprintf(log, "[B] STANDBY: spawn limit (%d) reached, running without replica\n",
+                         STANDBY_MAX_SPAWNS);
+        return -1;
+    }
+
+    int to_r[2], from_r[2];
+    if (pipe(to_r) == -1) return -1;
+    if (pipe(from_r) == -1) {
+        close(to_r[0]);
+        close(to_r[1]);
+        return -1;
+    }
+
+    int gen = ++sb->generation;
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(to_r[0]); close(to_r[1]);
+        close(from_r[0]); close(from_r[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        run_dynamics_replica(to_r[0], from_r[1], *p, gen);   // never returns
+    }
+
+    close(to_r[0]);
+    close(from_r[1]);
+    int fl = fcntl(from_r[0], F_GETFL, 0);
+    fcntl(from_r[0], F_SETFL, (fl == -1 ? 0 : fl) | O_NONBLOCK);
+
+    sb->pid          = pid;
+    sb->fd_force     = to_r[1];
+    sb->fd_state     = from_r[0];
+    sb->shadow_ticks = 0;
+
+    if (log) fprintf(log, "[B] STANDBY: replica #%d forked (pid %d)\n", gen, (int)pid);
+    return 0;
+}
+
+int standby_drain(Standby *sb) {
+    if (sb->pid <= 0) return 0;
+
+    DroneStateMsg s;
+    while (1) {
+        ssize_t n = read(sb->fd_state, &s, sizeof(s));
+        if (n == (ssize_t)sizeof(s)) {
+            sb->shadow = s;
+            sb->shadow_ticks++;
+            continue;
+        }
+        if (n == 0) return -1;                                   // replica exited
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        if (n < 0 && errno == EINTR) continue;
+        return -1;
+    }
+}
+
+void standby_sync(Standby *sb, IoBatch *iob, const ForceStateMsg *f,
+                  const DroneStateMsg *state, FILE *log) {
+    if (sb->pid <= 0) return;
+
+    // Drift since the last sync (only meaningful once the replica has produced states)
+    if (sb->shadow_ticks > 0) {
+        double drift = hypot(sb->shadow.x - state->x, sb->shadow.y - state->y);
+        if (drift > sb->max_drift) sb->max_drift = drift;
+    }
+
+    ForceStateMsg msg = *f;
+    msg.reset = FORCE_ADOPT_STATE;
+    msg.state = *state;
+    if (iob_write(iob, sb->fd_force, &msg, sizeof(msg)) == -1 && log) {
+        fprintf(log, "[B] STANDBY: sync write failed: %s\n", strerror(errno));
+    }
+    sb->shadow_ticks = 0;
+}
+
+void standby_release(Standby *sb) {
+    sb->pid      = -1;
+    sb->fd_force = -1;
+    sb->fd_state = -1;
+}
+
+void standby_stop(Standby *sb) {
+    if (sb->pid <= 0) return;
+    close(sb->fd_force);
+    close(sb->fd_state);
+    kill(sb->pid, SIGKILL);
+    waitpid(sb->pid, NULL, 0);
+    standby_release(sb);
+}
+
+void standby_retire_primary(pid_t pid) {
+    if (pid <= 0 || pid == getpid()) return;   // thread-mode D lives inside B
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, WNOHANG);               // reaped later if not dead yet
+}
@@ -2,6 +2,10 @@
 #include "headers/params.h"
 #include "headers/targets.h"
 #include "headers/util.h"
+#include "headers/topology.h"  // component_exit()
+#include "headers/scenario.h"
+#include "headers/faults.h"
+#include "headers/vclock.h"
 
 #include <unistd.h>
 #include <stdlib.h>
@@ -12,7 +16,6 @@
 
 #include <math.h>
 
-Target g_targets[NUM_TARGETS];
 
 /**
  * @brief Run the Target Generator (T) process.
@@ -35,6 +38,15 @@ void run_target_process(int write_fd, SimParams params) {
     fprintf(log, "[T] Targets started | PID = %d\n", getpid());
     srand((unsigned)time(NULL) ^ (getpid() << 1));
 
+    // Scenario runs: fixed seed, and no random batches when the scenario scripts the waves
+    const Scenario *scn = scenario_active();
+    if (scn && scn->has_seed) srand(scn->seed * 2u + 2u);
+    if (scn && scn->n_target_waves > 0) {
+        fprintf(log, "[T] Scenario '%s' drives targets; generator idle.\n", scn->name);
+        fflush(log);
+        while (1) clock_sleep(60.0);   // keeps the channel open so B never sees EOF
+    }
+
     double world_half = params.world_half;
 
     // Parameters:
@@ -54,7 +66,7 @@ void run_target_process(int write_fd, SimParams params) {
     const int max_attempts       = 50;  // 50 attempts
 
     // Determines how often to *try* to spawn a new batch of targets (in seconds)
-    const unsigned spawn_interval_sec = 50;   // 50 seconds
+    const unsigned spawn_interval_sec = TGT_SPAWN_INTERVAL_SEC;
 
     while (1) {
         TargetSetMsg msg;
@@ -119,6 +131,8 @@ void run_target_process(int write_fd, SimParams params) {
             }
         }
 
+        FAULT_SLEEP_MS(FLT_T_DELAY_MS);   // injected: late batch
+
         // Sends batch to B.
         if (write(write_fd, &msg, sizeof(msg)) == -1) {
             perror("[T] write to B failed");
@@ -131,7 +145,7 @@ void run_target_process(int write_fd, SimParams params) {
 
 
         // Waits before generating the next batch.
-        sleep(spawn_interval_sec);
+        sleep_sim_sec(spawn_interval_sec, &params);
     }
     // Final cleanup
     if (log) {
@@ -139,5 +153,5 @@ void run_target_process(int write_fd, SimParams params) {
         fclose(log);
     }
     close(write_fd);
-    exit(EXIT_SUCCESS);
+    component_exit(EXIT_SUCCESS);   // pthread_exit() when running as a thread in B
 }
@@ -0,0 +1,514 @@
+// telemetry.c
+// Column-blocked telemetry files: writer used by B, mmap reader used by
+// the analytics tool, and the summary pyramid built next to each recording.
+// ======================================================================
+
+#include "headers/telemetry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const size_t TLM_COL_SIZE[TLM_COL_COUNT] = {
+    [TLM_COL_TICK]         = sizeof(int32_t),
+    [TLM_COL_X]            = sizeof(double),
+    [TLM_COL_Y]            = sizeof(double),
+    [TLM_COL_VX]           = sizeof(double),
+    [TLM_COL_VY]           = sizeof(double),
+    [TLM_COL_FX]           = sizeof(float),
+    [TLM_COL_FY]           = sizeof(float),
+    [TLM_COL_SCORE]        = sizeof(int32_t),
+    [TLM_COL_COLLECTED]    = sizeof(int32_t),
+    [TLM_COL_TICK_MS]      = sizeof(float),
+    [TLM_COL_INPUT_MS]     = sizeof(float),
+    [TLM_COL_FLAGS]        = sizeof(uint8_t),
+    [TLM_COL_HASH]         = sizeof(uint64_t),
+    [TLM_COL_HASH_DRONE]   = sizeof(uint64_t),
+    [TLM_COL_HASH_FORCE]   = sizeof(uint64_t),
+    [TLM_COL_HASH_OBS]     = sizeof(uint64_t),
+    [TLM_COL_HASH_TGT]     = sizeof(uint64_t),
+    [TLM_COL_HASH_SCORE]   = sizeof(uint64_t),
+    [TLM_COL_HASH_STREAMS] = sizeof(uint64_t),
+};
+
+const TlmColumn TLP_SERIES_COLS[TLP_SERIES_COUNT] = {
+    TLM_COL_X, TLM_COL_Y, TLM_COL_VX, TLM_COL_VY, TLM_COL_FX, TLM_COL_FY,
+    TLM_COL_SCORE, TLM_COL_COLLECTED, TLM_COL_TICK_MS, TLM_COL_INPUT_MS,
+};
+
+const char *TLP_SERIES_NAMES[TLP_SERIES_COUNT] = {
+    "x", "y", "vx", "vy", "fx", "fy", "score", "collected", "tick_ms", "input_ms",
+};
+
+size_t tlm_block_bytes(void) {
+    size_t n = sizeof(TlmBlockHeader);
+    for (int c = 0; c < TLM_COL_COUNT; ++c) n += TLM_COL_SIZE[c] * TLM_BLOCK_ROWS;
+    return n;
+}
+
+// Writes the whole buffer (retries short writes).
+static int write_all(int fd, const void *buf, size_t len) {
+    const unsigned char *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p   += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Summaries (shared by the writer and tlm_summarize)
+// ----------------------------------------------------------------------
+// While a summary is open its `mean` fields hold sums.
+static void bucket_reset(TlpBucket *b, int64_t first_row) {
+    memset(b, 0, sizeof(*b));
+    b->first_row = first_row;
+    for (int i = 0; i < TLP_SERIES_COUNT; ++i) {
+        b->s[i].min = INFINITY;
+        b->s[i].max = -INFINITY;
+    }
+}
+
+static void bucket_add_row(TlpBucket *b, const double v[TLP_SERIES_COUNT], int paused) {
+    b->rows++;
+    b->paused += paused;
+    for (int i = 0; i < TLP_SERIES_COUNT; ++i) {
+        if (i == TLP_S_INPUT_MS && v[i] < 0.0) continue;   // no key batch this tick
+        TlpStat *st = &b->s[i];
+        if (v[i] < st->min) st->min = v[i];
+        if (v[i] > st->max) st->max = v[i];
+        st->mean += v[i];
+        st->n++;
+    }
+}
+
+// Adds src into the open summary dst; src holds sums (open) or means (closed).
+static void bucket_merge(TlpBucket *dst, const TlpBucket *src, int src_closed) {
+    dst->rows   += src->rows;
+    dst->paused += src->paused;
+    for (int i = 0; i < TLP_SERIES_COUNT; ++i) {
+        const TlpStat *s = &src->s[i];
+        TlpStat       *d = &dst->s[i];
+        if (s->n == 0) continue;
+        if (s->min < d->min) d->min = s->min;
+        if (s->max > d->max) d->max = s->max;
+        d->mean += src_closed ? s->mean * s->n : s->mean;
+        d->n    += s->n;
+    }
+}
+
+static void bucket_close(TlpBucket *b) {
+    for (int i = 0; i < TLP_SERIES_COUNT; ++i) {
+        TlpStat *st = &b->s[i];
+        if (st->n > 0) st->mean /= st->n;
+        else           st->min = st->max = st->mean = 0.0;
+    }
+}
+
+static long level_rows(int level) {
+    long f = TLP_FANOUT;
+    for (int l = 0; l < level; ++l) f *= TLP_FANOUT;
+    return f;
+}
+
+static size_t tlp_block_bytes(void) {
+    return sizeof(TlpBlockHeader) + TLP_BLOCK_BUCKETS * sizeof(TlpBucket);
+}
+
+// Writer
+// ----------------------------------------------------------------------
+static void pyr_open(TlmWriter *w) {
+    char path[sizeof(w->path) + sizeof(TLP_SUFFIX)];
+    snprintf(path, sizeof(path), "%s%s", w->path, TLP_SUFFIX);
+
+    for (int l = 0; l < TLP_LEVELS; ++l) {
+        w->pyr_block[l] = calloc(TLP_BLOCK_BUCKETS, sizeof(TlpBucket));
+        if (!w->pyr_block[l]) return;
+        bucket_reset(&w->pyr_acc[l], 0);
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        perror("[TLM] open pyramid");
+        return;
+    }
+    TlpFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TLP_MAGIC, sizeof(TLP_MAGIC));
+    h.version       = TLP_VERSION;
+    h.fanout        = TLP_FANOUT;
+    h.levels        = TLP_LEVELS;
+    h.n_series      = TLP_SERIES_COUNT;
+    h.block_buckets = TLP_BLOCK_BUCKETS;
+    if (write_all(fd, &h, sizeof(h)) == -1) {
+        perror("[TLM] write pyramid header");
+        close(fd);
+        return;
+    }
+    w->pyr_fd = fd;
+}
+
+static void pyr_flush_block(TlmWriter *w, int level) {
+    if (w->pyr_fd == -1 || w->pyr_n[level] == 0) return;
+
+    TlpBlockHeader bh = { TLP_BLOCK_MAGIC, (uint32_t)level, (uint32_t)w->pyr_n[level], 0 };
+    if (write_all(w->pyr_fd, &bh, sizeof(bh)) == -1 ||
+        write_all(w->pyr_fd, w->pyr_block[level], TLP_BLOCK_BUCKETS * sizeof(TlpBucket)) == -1) {
+        perror("[TLM] write pyramid block");
+        close(w->pyr_fd);
+        w->pyr_fd = -1;   // rows keep being recorded
+        return;
+    }
+    w->pyr_n[level] = 0;
+    memset(w->pyr_block[level], 0, TLP_BLOCK_BUCKETS * sizeof(TlpBucket));
+}
+
+// Closes the open summary of a level: stores it, adds it to the next level
+// and closes that one too once it has TLP_FANOUT summaries.
+static void pyr_emit(TlmWriter *w, int level) {
+    TlpBucket *acc = &w->pyr_acc[level];
+    if (acc->rows == 0) return;
+
+    int up = level + 1 < TLP_LEVELS;
+    if (up) {
+        bucket_merge(&w->pyr_acc[level + 1], acc, 0);
+        w->pyr_children[level + 1]++;
+    }
+    TlpBucket *out = &w->pyr_block[level][w->pyr_n[level]++];
+    *out = *acc;
+    bucket_close(out);
+    if (w->pyr_n[level] == TLP_BLOCK_BUCKETS) pyr_flush_block(w, level);
+
+    bucket_reset(acc, w->pyr_rows);
+    w->pyr_children[level] = 0;
+    if (up && w->pyr_children[level + 1] == TLP_FANOUT) pyr_emit(w, level + 1);
+}
+
+int tlm_open(TlmWriter *w, const SimParams *p) {
+    memset(w, 0, sizeof(*w));
+    w->fd     = -1;
+    w->pyr_fd = -1;
+
+    if (mkdir(TLM_DIR, 0755) == -1 && errno != EEXIST) return -1;
+
+    time_t now = time(NULL);
+    struct tm tm;
+    localtime_r(&now, &tm);
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &tm);
+    snprintf(w->path, sizeof(w->path), "%s/session_%s_%d.tlm", TLM_DIR, stamp, (int)getpid());
+
+    for (int c = 0; c < TLM_COL_COUNT; ++c) {
+        w->cols[c] = calloc(TLM_BLOCK_ROWS, TLM_COL_SIZE[c]);
+        if (!w->cols[c]) { tlm_close(w); return -1; }
+    }
+
+    w->fd = open(w->path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (w->fd == -1) { tlm_close(w); return -1; }
+
+    TlmFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TLM_MAGIC, sizeof(TLM_MAGIC));
+    h.version        = TLM_VERSION;
+    h.block_rows     = TLM_BLOCK_ROWS;
+    h.n_columns      = TLM_COL_COUNT;
+    h.dt             = p->dt;
+    h.world_half     = p->world_half;
+    h.wall_clearance = p->wall_clearance;
+    h.start_unix     = (int64_t)now;
+    if (write_all(w->fd, &h, sizeof(h)) == -1) {
+        close(w->fd);
+        w->fd = -1;
+        tlm_close(w);
+        return -1;
+    }
+    pyr_open(w);   // optional: readers fall back to the rows
+    return 0;
+}
+
+static void flush_block(TlmWriter *w) {
+    if (w->fd == -1 || w->n_rows == 0) return;
+
+    TlmBlockHeader bh = { TLM_BLOCK_MAGIC, (uint32_t)w->n_rows };
+    int rc = write_all(w->fd, &bh, sizeof(bh));
+    for (int c = 0; c < TLM_COL_COUNT && rc == 0; ++c) {
+        // Unused rows of a partial block stay zero (blocks keep a fixed size)
+        rc = write_all(w->fd, w->cols[c], TLM_COL_SIZE[c] * TLM_BLOCK_ROWS);
+    }
+    if (rc == -1) {
+        perror("[TLM] write block");
+        close(w->fd);
+        w->fd = -1;   // stop recording, keep the simulation running
+        return;
+    }
+    w->blocks_written++;
+    w->n_rows = 0;
+    for (int c = 0; c < TLM_COL_COUNT; ++c) memset(w->cols[c], 0, TLM_COL_SIZE[c] * TLM_BLOCK_ROWS);
+}
+
+#define TLM_PUT(w, col, type, val) (((type *)(w)->cols[col])[(w)->n_rows] = (val))
+
+void tlm_append(TlmWriter *w, const TlmRow *r) {
+    if (w->fd == -1) return;
+
+    TLM_PUT(w, TLM_COL_TICK,      int32_t,  r->tick);
+    TLM_PUT(w, TLM_COL_X,         double,   r->x);
+    TLM_PUT(w, TLM_COL_Y,         double,   r->y);
+    TLM_PUT(w, TLM_COL_VX,        double,   r->vx);
+    TLM_PUT(w, TLM_COL_VY,        double,   r->vy);
+    TLM_PUT(w, TLM_COL_FX,        float,    r->fx);
+    TLM_PUT(w, TLM_COL_FY,        float,    r->fy);
+    TLM_PUT(w, TLM_COL_SCORE,     int32_t,  r->score);
+    TLM_PUT(w, TLM_COL_COLLECTED, int32_t,  r->collected);
+    TLM_PUT(w, TLM_COL_TICK_MS,   float,    r->tick_ms);
+    TLM_PUT(w, TLM_COL_INPUT_MS,  float,    r->input_ms);
+    TLM_PUT(w, TLM_COL_FLAGS,     uint8_t,  r->flags);
+    TLM_PUT(w, TLM_COL_HASH,      uint64_t, r->hash);
+    for (int g = 0; g < WH_COUNT; ++g)
+        TLM_PUT(w, TLM_COL_HASH_DRONE + g, uint64_t, r->group_hash[g]);
+
+    if (++w->n_rows == TLM_BLOCK_ROWS) flush_block(w);
+
+    if (w->pyr_fd != -1) {
+        const double v[TLP_SERIES_COUNT] = {
+            r->x, r->y, r->vx, r->vy, r->fx, r->fy,
+            r->score, r->collected, r->tick_ms, r->input_ms,
+        };
+        bucket_add_row(&w->pyr_acc[0], v, (r->flags & TLM_FLAG_PAUSED) != 0);
+        w->pyr_rows++;
+        if (++w->pyr_children[0] == TLP_FANOUT) pyr_emit(w, 0);
+    }
+}
+
+void tlm_close(TlmWriter *w) {
+    flush_block(w);
+    if (w->fd != -1) close(w->fd);
+    w->fd = -1;
+    for (int c = 0; c < TLM_COL_COUNT; ++c) {
+        free(w->cols[c]);
+        w->cols[c] = NULL;
+    }
+
+    // Partial summaries of the tail, then every level's last block
+    if (w->pyr_fd != -1) {
+        for (int l = 0; l < TLP_LEVELS; ++l) pyr_emit(w, l);
+        for (int l = 0; l < TLP_LEVELS; ++l) pyr_flush_block(w, l);
+        close(w->pyr_fd);
+        w->pyr_fd = -1;
+    }
+    for (int l = 0; l < TLP_LEVELS; ++l) {
+        free(w->pyr_block[l]);
+        w->pyr_block[l] = NULL;
+    }
+}
+
+// Reader
+// ----------------------------------------------------------------------
+int tlm_map(TlmFile *f, const char *path) {
+    memset(f, 0, sizeof(*f));
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(TlmFileHeader)) {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    f->base = map;
+    f->size = (size_t)st.st_size;
+    f->hdr  = map;
+
+    if (memcmp(f->hdr->magic, TLM_MAGIC, sizeof(TLM_MAGIC)) != 0 ||
+        f->hdr->version != TLM_VERSION ||
+        f->hdr->block_rows != TLM_BLOCK_ROWS ||
+        f->hdr->n_columns != TLM_COL_COUNT) {
+        tlm_unmap(f);
+        return -1;
+    }
+
+    // A session killed mid-write may end in a truncated block: ignore it
+    f->n_blocks = (long)((f->size - sizeof(TlmFileHeader)) / tlm_block_bytes());
+    return 0;
+}
+
+const void *tlm_column(const TlmFile *f, long b, TlmColumn col, int *n_rows) {
+    const unsigned char *blk = f->base + sizeof(TlmFileHeader) + (size_t)b * tlm_block_bytes();
+    const TlmBlockHeader *bh = (const TlmBlockHeader *)blk;
+
+    *n_rows = (bh->magic == TLM_BLOCK_MAGIC && bh->n_rows <= TLM_BLOCK_ROWS) ? (int)bh->n_rows : 0;
+
+    size_t off = sizeof(TlmBlockHeader);
+    for (int c = 0; c < (int)col; ++c) off += TLM_COL_SIZE[c] * TLM_BLOCK_ROWS;
+    return blk + off;
+}
+
+void tlm_unmap(TlmFile *f) {
+    if (f->base) munmap((void *)f->base, f->size);
+    memset(f, 0, sizeof(*f));
+}
+
+long tlm_rows(const TlmFile *f) {
+    if (f->n_blocks == 0) return 0;
+    int n;
+    tlm_column(f, f->n_blocks - 1, TLM_COL_TICK, &n);
+    return (f->n_blocks - 1) * TLM_BLOCK_ROWS + n;
+}
+
+// Pyramid reader
+// ----------------------------------------------------------------------
+int tlp_map(TlpFile *p, const char *tlm_path) {
+    memset(p, 0, sizeof(*p));
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s%s", tlm_path, TLP_SUFFIX);
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(TlpFileHeader)) {
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    p->base = map;
+    p->size = (size_t)st.st_size;
+
+    const TlpFileHeader *h = map;
+    if (memcmp(h->magic, TLP_MAGIC, sizeof(TLP_MAGIC)) != 0 || h->version != TLP_VERSION ||
+        h->fanout != TLP_FANOUT || h->levels != TLP_LEVELS ||
+        h->n_series != TLP_SERIES_COUNT || h->block_buckets != TLP_BLOCK_BUCKETS) {
+        tlp_unmap(p);
+        return -1;
+    }
+
+    // Blocks of all levels are interleaved: index them per level (two passes,
+    // the first counts). A truncated or unknown block ends the file.
+    long n_blocks = (long)((p->size - sizeof(TlpFileHeader)) / tlp_block_bytes());
+    for (int pass = 0; pass < 2; ++pass) {
+        long seen[TLP_LEVELS] = { 0 };
+        for (long b = 0; b < n_blocks; ++b) {
+            const unsigned char  *blk = p->base + sizeof(TlpFileHeader) + (size_t)b * tlp_block_bytes();
+            const TlpBlockHeader *bh  = (const TlpBlockHeader *)blk;
+            if (bh->magic != TLP_BLOCK_MAGIC || bh->level >= TLP_LEVELS ||
+                bh->n_buckets > TLP_BLOCK_BUCKETS) break;
+            if (pass == 1) {
+                p->block[bh->level][seen[bh->level]] = (const TlpBucket *)(blk + sizeof(TlpBlockHeader));
+                p->n_buckets[bh->level] += bh->n_buckets;
+            }
+            seen[bh->level]++;
+        }
+        if (pass == 1) break;
+        for (int l = 0; l < TLP_LEVELS; ++l) {
+            p->n_blocks[l] = seen[l];
+            p->block[l]    = calloc((size_t)(seen[l] > 0 ? seen[l] : 1), sizeof(*p->block[l]));
+            if (!p->block[l]) {
+                tlp_unmap(p);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+void tlp_unmap(TlpFile *p) {
+    for (int l = 0; l < TLP_LEVELS; ++l) free(p->block[l]);
+    if (p->base) munmap((void *)p->base, p->size);
+    memset(p, 0, sizeof(*p));
+}
+
+// Stored summary i of a level if it covers exactly its TLP_FANOUT^(level+1)
+// rows (the tail summaries of a session are partial), else NULL.
+static const TlpBucket *tlp_bucket(const TlpFile *p, int level, long i) {
+    if (!p || i >= p->n_buckets[level]) return NULL;
+    const TlpBucket *b = &p->block[level][i / TLP_BLOCK_BUCKETS][i % TLP_BLOCK_BUCKETS];
+    long f = level_rows(level);
+    return (b->rows == f && b->first_row == i * f) ? b : NULL;
+}
+
+static void summarize_rows(const TlmFile *f, long row0, long row1, TlpBucket *acc) {
+    for (long row = row0; row < row1; ) {
+        long b = row / TLM_BLOCK_ROWS;
+        int  n;
+        const void    *col[TLP_SERIES_COUNT];
+        const uint8_t *flags = tlm_column(f, b, TLM_COL_FLAGS, &n);
+        for (int i = 0; i < TLP_SERIES_COUNT; ++i) col[i] = tlm_column(f, b, TLP_SERIES_COLS[i], &n);
+
+        int end = (int)(row1 - b * TLM_BLOCK_ROWS < n ? row1 - b * TLM_BLOCK_ROWS : n);
+        for (int r = (int)(row - b * TLM_BLOCK_ROWS); r < end; ++r) {
+            double v[TLP_SERIES_COUNT];
+            for (int i = 0; i < TLP_SERIES_COUNT; ++i) {
+                switch (TLP_SERIES_COLS[i]) {
+                    case TLM_COL_X: case TLM_COL_Y: case TLM_COL_VX: case TLM_COL_VY:
+                        v[i] = ((const double *)col[i])[r];  break;
+                    case TLM_COL_SCORE: case TLM_COL_COLLECTED:
+                        v[i] = ((const int32_t *)col[i])[r]; break;
+                    default:
+                        v[i] = ((const float *)col[i])[r];   break;
+                }
+            }
+            bucket_add_row(acc, v, (flags[r] & TLM_FLAG_PAUSED) != 0);
+        }
+        if (end <= (int)(row - b * TLM_BLOCK_ROWS)) break;   // short block: no more rows
+        row = b * TLM_BLOCK_ROWS + end;
+    }
+}
+
+// Whole summaries of `level` inside [row0, row1), the rest from finer levels.
+static void summarize_level(const TlmFile *f, const TlpFile *p, int level,
+                            long row0, long row1, TlpBucket *acc, TlpReadStats *st) {
+    if (row0 >= row1) return;
+    if (level < 0) {
+        summarize_rows(f, row0, row1, acc);
+        st->rows += row1 - row0;
+        return;
+    }
+    long fr = level_rows(level);
+    long i0 = (row0 + fr - 1) / fr;
+    long i1 = row1 / fr;
+    if (i0 >= i1) {
+        summarize_level(f, p, level - 1, row0, row1, acc, st);
+        return;
+    }
+    summarize_level(f, p, level - 1, row0, i0 * fr, acc, st);
+    for (long i = i0; i < i1; ++i) {
+        const TlpBucket *b = tlp_bucket(p, level, i);
+        if (b) {
+            bucket_merge(acc, b, 1);
+            st->buckets[level]++;
+        } else {
+            summarize_level(f, p, level - 1, i * fr, (i + 1) * fr, acc, st);
+        }
+    }
+    summarize_level(f, p, level - 1, i1 * fr, row1, acc, st);
+}
+
+void tlm_summarize(const TlmFile *f, const TlpFile *p, long row0, long row1,
+                   TlpBucket *out, TlpReadStats *st) {
+    TlpReadStats unused;
+    if (!st) st = &unused;
+    long rows = tlm_rows(f);
+    if (row0 < 0) row0 = 0;
+    if (row1 > rows) row1 = rows;
+    bucket_reset(out, row0);
+    summarize_level(f, p, TLP_LEVELS - 1, row0, row1, out, st);
+    bucket_close(out);
+}
@@ -0,0 +1,291 @@
+// topology.c
+// Generic launcher for the process/thread graph
+//  - Defaults reproduce the hand-written layout (5 child processes, 6 pipes)
+//  - topology.txt can move I/D/O/T into threads, pin CPUs, and change
+//    channel transports and kernel buffer sizes without recompiling
+// ======================================================================
+
+#define _GNU_SOURCE
+#include "headers/topology.h"
+#include "headers/util.h"   // die()
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+// Set in thread components so component_exit() does not take B down.
+static __thread int tl_is_thread = 0;
+
+static const char *k_transport_names[] = { "pipe", "stream", "seqpacket" };
+
+// Thread start arguments (one per component, lives as long as the process)
+typedef struct {
+    Topology     *topo;
+    ComponentId   id;
+    ComponentMain entry;
+} ThreadStart;
+
+static ThreadStart g_thread_start[COMP_COUNT];
+
+// Defaults
+// ----------------------------------------------------------------------
+void topo_init_default(Topology *t) {
+    static const char *comp_names[COMP_COUNT] = { "B", "I", "D", "O", "T", "W" };
+
+    memset(t, 0, sizeof(*t));
+    for (int i = 0; i < COMP_COUNT; ++i) {
+        t->comp[i].name = comp_names[i];
+        t->comp[i].mode = RUN_PROCESS;
+        t->comp[i].cpu  = -1;
+        t->comp[i].pid  = -1;
+    }
+
+    // name, writer -> reader
+    static const struct { const char *name; ComponentId w, r; } chans[CH_COUNT] = {
+        { "I_to_B",   COMP_I, COMP_B },
+        { "B_to_D",   COMP_B, COMP_D },
+        { "D_to_B",   COMP_D, COMP_B },
+        { "O_to_B",   COMP_O, COMP_B },
+        { "T_to_B",   COMP_T, COMP_B },
+        { "CFG_to_W", COMP_B, COMP_W },   // one-time WatchPids configuration
+    };
+    for (int c = 0; c < CH_COUNT; ++c) {
+        t->ch[c].name      = chans[c].name;
+        t->ch[c].writer    = chans[c].w;
+        t->ch[c].reader    = chans[c].r;
+        t->ch[c].transport = TRANSPORT_PIPE;
+        t->ch[c].capacity  = 0;
+        t->ch[c].fds[0]    = -1;
+        t->ch[c].fds[1]    = -1;
+    }
+}
+
+// Loading
+// ----------------------------------------------------------------------
+static int find_comp(const Topology *t, const char *name) {
+    for (int i = 0; i < COMP_COUNT; ++i)
+        if (strcmp(t->comp[i].name, name) == 0) return i;
+    return -1;
+}
+
+static int find_chan(const Topology *t, const char *name) {
+    for (int c = 0; c < CH_COUNT; ++c)
+        if (strcmp(t->ch[c].name, name) == 0) return c;
+    return -1;
+}
+
+void topo_load_from_file(const char *filename, Topology *t) {
+    FILE *fp = fopen(filename, "r");
+    if (!fp) {
+        // Optional file: the default layout is the classic one
+        return;
+    }
+
+    fprintf(stderr, "[TOPO] Loading topology from '%s'...\n", filename);
+
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char key[64], val[64];
+        if (sscanf(line, " %63[^= \t] = %63s", key, val) != 2) continue;
+
+        char *dot = strchr(key, '.');
+        if (!dot) {
+            fprintf(stderr, "[TOPO] Malformed key '%s', ignoring.\n", key);
+            continue;
+        }
+        *dot = '\0';
+        const char *obj  = key;
+        const char *attr = dot + 1;
+
+        int ci = find_comp(t, obj);
+        int ch = find_chan(t, obj);
+
+        if (ci >= 0 && strcmp(attr, "mode") == 0) {
+            if (strcmp(val, "thread") == 0) {
+                if (ci == COMP_B || ci == COMP_W) {
+                    // B is the master; W must survive a hung B, so it stays a process
+                    fprintf(stderr, "[TOPO] %s must run as a process, ignoring.\n", obj);
+                } else {
+                    t->comp[ci].mode = RUN_THREAD;
+                }
+            } else if (strcmp(val, "process") == 0) {
+                t->comp[ci].mode = RUN_PROCESS;
+            } else {
+                fprintf(stderr, "[TOPO] Unknown mode '%s' for %s, ignoring.\n", val, obj);
+            }
+        }
+        else if (ci >= 0 && strcmp(attr, "cpu") == 0) {
+            t->comp[ci].cpu = atoi(val);
+        }
+        else if (ch >= 0 && strcmp(attr, "transport") == 0) {
+            int found = 0;
+            for (int k = 0; k < 3; ++k) {
+                if (strcmp(val, k_transport_names[k]) == 0) {
+                    t->ch[ch].transport = (Transport)k;
+                    found = 1;
+                }
+            }
+            if (!found)
+                fprintf(stderr, "[TOPO] Unknown transport '%s' for %s, ignoring.\n", val, obj);
+        }
+        else if (ch >= 0 && strcmp(attr, "capacity") == 0) {
+            t->ch[ch].capacity = atoi(val);
+        }
+        else {
+            fprintf(stderr, "[TOPO] Unknown key '%s.%s', ignoring.\n", obj, attr);
+        }
+    }
+    fclose(fp);
+
+    for (int i = 0; i < COMP_COUNT; ++i) {
+        fprintf(stderr, "[TOPO] %s: %s cpu=%d\n", t->comp[i].name,
+                t->comp[i].mode == RUN_THREAD ? "thread" : "process", t->comp[i].cpu);
+    }
+    for (int c = 0; c < CH_COUNT; ++c) {
+        fprintf(stderr, "[TOPO] %s: %s capacity=%d\n", t->ch[c].name,
+                k_transport_names[t->ch[c].transport], t->ch[c].capacity);
+    }
+}
+
+// Channels
+// ----------------------------------------------------------------------
+void topo_create_channels(Topology *t) {
+    for (int c = 0; c < CH_COUNT; ++c) {
+        Channel *ch = &t->ch[c];
+        char what[64];
+        snprintf(what, sizeof(what), "channel %s", ch->name);
+
+        if (ch->transport == TRANSPORT_PIPE) {
+            if (pipe(ch->fds) == -1) die(what);
+            if (ch->capacity > 0 && fcntl(ch->fds[1], F_SETPIPE_SZ, ch->capacity) == -1) {
+                perror("[TOPO] F_SETPIPE_SZ");
+            }
+        } else {
+            int type = (ch->transport == TRANSPORT_SEQPACKET) ? SOCK_SEQPACKET : SOCK_STREAM;
+            int sv[2];
+            if (socketpair(AF_UNIX, type, 0, sv) == -1) die(what);
+            // Use the pair one-way, same orientation as pipe(): [0] read, [1] write
+            shutdown(sv[0], SHUT_WR);
+            shutdown(sv[1], SHUT_RD);
+            ch->fds[0] = sv[0];
+            ch->fds[1] = sv[1];
+            if (ch->capacity > 0) {
+                setsockopt(ch->fds[1], SOL_SOCKET, SO_SNDBUF, &ch->capacity, sizeof(int));
+                setsockopt(ch->fds[0], SOL_SOCKET, SO_RCVBUF, &ch->capacity, sizeof(int));
+            }
+        }
+    }
+}
+
+int topo_rfd(const Topology *t, ChannelId ch) { return t->ch[ch].fds[0]; }
+int topo_wfd(const Topology *t, ChannelId ch) { return t->ch[ch].fds[1]; }
+
+// Returns 1 if the end (0 = read, 1 = write) of channel c belongs to component id.
+static int owns_end(const Topology *t, int c, int end, ComponentId id) {
+    return (end == 0) ? (t->ch[c].reader == id) : (t->ch[c].writer == id);
+}
+
+static void close_end(Topology *t, int c, int end) {
+    if (t->ch[c].fds[end] >= 0) {
+        close(t->ch[c].fds[end]);
+        t->ch[c].fds[end] = -1;
+    }
+}
+
+// Affinity
+// ----------------------------------------------------------------------
+void topo_apply_affinity(const Topology *t, ComponentId id) {
+    int cpu = t->comp[id].cpu;
+    if (cpu < 0) return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    int rc;
+    if (tl_is_thread) rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    else              rc = sched_setaffinity(0, sizeof(set), &set);
+    if (rc != 0) {
+        fprintf(stderr, "[TOPO] cannot pin %s to CPU %d\n", t->comp[id].name, cpu);
+    }
+}
+
+// Launching
+// ----------------------------------------------------------------------
+static void *thread_main(void *arg) {
+    ThreadStart *ts = (ThreadStart *)arg;
+    tl_is_thread = 1;
+    topo_apply_affinity(ts->topo, ts->id);
+    ts->entry(ts->topo);
+    return NULL;
+}
+
+void topo_launch(Topology *t, const ComponentMain entries[COMP_COUNT]) {
+    pid_t self = getpid();
+    t->comp[COMP_B].pid = self;
+
+    // 1) Forks every process component first (no threads exist yet, so fork is safe)
+    for (int id = 0; id < COMP_COUNT; ++id) {
+        if (id == COMP_B || t->comp[id].mode != RUN_PROCESS) continue;
+
+        pid_t pid = fork();
+        if (pid == -1) {
+            char what[32];
+            snprintf(what, sizeof(what), "fork %s", t->comp[id].name);
+            die(what);
+        }
+        if (pid == 0) {
+            // CHILD: keeps only its own channel ends (critical for EOF detection)
+            for (int c = 0; c < CH_COUNT; ++c) {
+                for (int end = 0; end < 2; ++end) {
+                    if (!owns_end(t, c, end, (ComponentId)id)) close_end(t, c, end);
+                }
+            }
+            topo_apply_affinity(t, (ComponentId)id);
+            entries[id](t);
+            component_exit(EXIT_SUCCESS);
+        }
+        t->comp[id].pid = pid;
+    }
+
+    // 2) PARENT: closes ends owned neither by B nor by a thread component
+    for (int c = 0; c < CH_COUNT; ++c) {
+        for (int end = 0; end < 2; ++end) {
+            ComponentId owner = (end == 0) ? t->ch[c].reader : t->ch[c].writer;
+            if (owner == COMP_B) continue;
+            if (t->comp[owner].mode == RUN_THREAD) continue;
+            close_end(t, c, end);
+        }
+    }
+    topo_apply_affinity(t, COMP_B);
+
+    // 3) Starts thread components inside B
+    for (int id = 0; id < COMP_COUNT; ++id) {
+        if (id == COMP_B || t->comp[id].mode != RUN_THREAD) continue;
+
+        g_thread_start[id].topo  = t;
+        g_thread_start[id].id    = (ComponentId)id;
+        g_thread_start[id].entry = entries[id];
+        t->comp[id].pid = self;
+
+        if (pthread_create(&t->comp[id].tid, NULL, thread_main, &g_thread_start[id]) != 0) {
+            fprintf(stderr, "[TOPO] pthread_create %s failed\n", t->comp[id].name);
+            exit(EXIT_FAILURE);
+        }
+        pthread_detach(t->comp[id].tid);
+    }
+}
+
+void component_exit(int status) {
+    if (tl_is_thread) {
+        pthread_exit(NULL);
+    }
+    exit(status);
+}
@@ -0,0 +1,196 @@
+// trail.c
+// Trajectory trails: fixed rings of simplified drone positions
+//
+// Simplification is streaming and bounded:
+//   - moves shorter than min_dist from the open tip are dropped (decimation)
+//   - otherwise the open segment (last vertex -> new point) is extended as long
+//     as every skipped raw point in the window stays within `tolerance` of it
+//     (the Douglas-Peucker split test, applied to a bounded window)
+//   - when the test fails, or the window is full, the tip becomes a vertex
+// ======================================================================
+
+#include "headers/trail.h"
+
+#include <math.h>
+#include <stdlib.h>     // abs
+#include <string.h>
+
+// Largest screen area the renderer de-duplicates (bigger terminals are clipped)
+#define TRAIL_MAX_ROWS 256
+#define TRAIL_MAX_COLS 512
+
+// Distance from p to the segment a-b.
+static double dist_to_segment(TrailPoint p, TrailPoint a, TrailPoint b) {
+    double vx = b.x - a.x, vy = b.y - a.y;
+    double wx = p.x - a.x, wy = p.y - a.y;
+    double len2 = vx * vx + vy * vy;
+    double u = (len2 > 0.0) ? (wx * vx + wy * vy) / len2 : 0.0;
+    if (u < 0.0) u = 0.0;
+    if (u > 1.0) u = 1.0;
+    double dx = wx - u * vx, dy = wy - u * vy;
+    return sqrt(dx * dx + dy * dy);
+}
+
+static void commit(Trail *t, TrailPoint p) {
+    t->pts[t->head] = p;
+    t->head = (t->head + 1) % t->capacity;
+    if (t->count < t->capacity) t->count++;
+    t->committed++;
+}
+
+static TrailPoint last_vertex(const Trail *t) {
+    return t->pts[(t->head - 1 + t->capacity) % t->capacity];
+}
+
+// Public API
+// ----------------------------------------------------------------------
+void trail_set_init(TrailSet *set, int n_drones, double world_half) {
+    memset(set, 0, sizeof(*set));
+    if (n_drones < 1) n_drones = 1;
+    if (n_drones > TRAIL_MAX_DRONES) n_drones = TRAIL_MAX_DRONES;
+    set->n_drones = n_drones;
+    set->visible  = 1;
+
+    int cap = TRAIL_TOTAL_BUDGET / n_drones;
+    if (cap > TRAIL_CAPACITY) cap = TRAIL_CAPACITY;
+    if (cap < 8) cap = 8;
+
+    for (int i = 0; i < n_drones; ++i) {
+        Trail *t = &set->drone[i];
+        t->capacity  = cap;
+        // ~1/400 of the world: well below one terminal cell
+        t->min_dist  = world_half / 200.0;
+        // ~half a cell for a full budget; coarser when the budget is split
+        t->tolerance = (world_half / 100.0) * ((double)TRAIL_CAPACITY / cap);
+    }
+}
+
+void trail_clear(Trail *t) {
+    t->head     = 0;
+    t->count    = 0;
+    t->has_tip  = 0;
+    t->n_window = 0;
+}
+
+void trail_push(Trail *t, double x, double y) {
+    TrailPoint p = { x, y };
+    t->raw_points++;
+
+    if (t->count == 0) {           // first point anchors the trail
+        commit(t, p);
+        return;
+    }
+    if (!t->has_tip) {
+        t->tip      = p;
+        t->has_tip  = 1;
+        t->n_window = 0;
+        return;
+    }
+
+    // Decimation
+    double dx = p.x - t->tip.x, dy = p.y - t->tip.y;
+    if (dx * dx + dy * dy < t->min_dist * t->min_dist) return;
+
+    // Window full: close the segment at the tip
+    if (t->n_window == TRAIL_WINDOW) {
+        commit(t, t->tip);
+        t->n_window = 0;
+        t->tip = p;
+        return;
+    }
+
+    // Can the segment extend to p while every skipped point stays close to it?
+    t->window[t->n_window++] = t->tip;
+    TrailPoint a = last_vertex(t);
+    int ok = 1;
+    for (int i = 0; i < t->n_window; ++i) {
+        if (dist_to_segment(t->window[i], a, p) > t->tolerance) { ok = 0; break; }
+    }
+
+    if (!ok) {
+        commit(t, t->tip);         // the tip was a real corner
+        t->n_window = 0;
+    }
+    t->tip = p;
+}
+
+int trail_points(const Trail *t) {
+    return t->count + (t->has_tip ? 1 : 0);
+}
+
+// Rendering
+// ----------------------------------------------------------------------
+static unsigned char g_seen[TRAIL_MAX_ROWS][TRAIL_MAX_COLS];
+
+typedef struct {
+    int top, left, height, width;
+    double sx, sy;
+} TrailView;
+
+static void to_cell(const TrailView *v, TrailPoint p, int *row, int *col) {
+    int c = (int)(p.x * v->sx) + v->width / 2 + v->left;
+    int r = (int)(-p.y * v->sy) + v->top + v->height / 2;
+    if (c < v->left) c = v->left;
+    if (c > v->left + v->width - 1) c = v->left + v->width - 1;
+    if (r < v->top) r = v->top;
+    if (r > v->top + v->height - 1) r = v->top + v->height - 1;
+    *row = r;
+    *col = c;
+}
+
+// Bresenham from (r0,c0) to (r1,c1); emits unseen cells only.
+static int raster_line(const TrailView *v, int r0, int c0, int r1, int c1,
+                       int bucket, TrailPutCell put) {
+    int emitted = 0;
+    int dc = abs(c1 - c0), sc = c0 < c1 ? 1 : -1;
+    int dr = -abs(r1 - r0), sr = r0 < r1 ? 1 : -1;
+    int err = dc + dr;
+
+    while (1) {
+        unsigned char *cell = &g_seen[r0 - v->top][c0 - v->left];
+        if (!*cell) {
+            *cell = 1;
+            put(r0, c0, bucket);
+            emitted++;
+        }
+        if (r0 == r1 && c0 == c1) break;
+        int e2 = 2 * err;
+        if (e2 >= dr) { err += dr; c0 += sc; }
+        if (e2 <= dc) { err += dc; r0 += sr; }
+    }
+    return emitted;
+}
+
+int trail_render(const Trail *t, double world_half,
+                 int top, int left, int height, int width,
+                 TrailPutCell put) {
+    int n = trail_points(t);
+    if (n < 2 || height < 1 || width < 1 || world_half <= 0.0) return 0;
+    if (height > TRAIL_MAX_ROWS) height = TRAIL_MAX_ROWS;
+    if (width  > TRAIL_MAX_COLS) width  = TRAIL_MAX_COLS;
+
+    TrailView v = { top, left, height, width,
+                    width / (2.0 * world_half), height / (2.0 * world_half) };
+    for (int r = 0; r < height; ++r) memset(g_seen[r], 0, (size_t)width);
+
+    // Walks newest -> oldest: tip, then committed vertices backwards
+    TrailPoint prev = t->has_tip ? t->tip : last_vertex(t);
+    int k_start     = t->has_tip ? 0 : 1;
+    int pr, pc;
+    to_cell(&v, prev, &pr, &pc);
+
+    int emitted = 0;
+    for (int k = k_start; k < t->count; ++k) {
+        TrailPoint p = t->pts[(t->head - 1 - k + 2 * t->capacity) % t->capacity];
+        int r, c;
+        to_cell(&v, p, &r, &c);
+
+        int bucket = (3 * (k + 1 - k_start)) / n;
+        if (bucket > 2) bucket = 2;
+        emitted += raster_line(&v, pr, pc, r, c, bucket, put);
+
+        pr = r;
+        pc = c;
+    }
+    return emitted;
+}
@@ -7,6 +7,7 @@
 #include "headers/params.h"   // for SimParams
 #include "headers/obstacles.h"
 #include "headers/targets.h"
+#include "headers/vclock.h"  // clock_sleep()
 
 #include <math.h>
 #include <stdbool.h>
@@ -100,84 +101,38 @@ int best_dir8_for_vector(double Px, double Py) {
     return best_idx;
 }
 
-// Sends total force to D using a "virtual key" computed from obstacles and walls
+// Computes the total force command using a "virtual key" computed from obstacles
 // ----------------------------------------------------------------------
-void send_total_force_to_d(const ForceStateMsg *user_force,
-                                  const DroneStateMsg *cur_state,
+ForceStateMsg compute_total_force(const ForceStateMsg *user_force,
+                                  double               Px,
+                                  double               Py,
                                   const SimParams     *params,
-                                  const Obstacle      *obs,
-                                  int                  num_obs,
-                                  int                  fd_to_d,
-                                  FILE                *logfile,
-                                  const char          *reason)
+                                  char                *detail,
+                                  size_t               detail_len)
 {
-    // Computes repulsive force vector 
-    double Px = 0.0, Py = 0.0;
-    compute_repulsive_P(cur_state,
-                        params,
-                        obs,
-                        num_obs,
-                        false,   // calculate repulsive force for obstacles here
-                        true,   // include_obstacles
-                        &Px, &Py);
+    ForceStateMsg out = *user_force;
 
     // Sends user_force alone if very small.
     double Pnorm2 = Px*Px + Py*Py;
     if (Pnorm2 < 1e-6) {
-        ForceStateMsg out = *user_force;
-        if (write(fd_to_d, &out, sizeof(out)) == -1) {
-            perror("[B] write to D failed (no rep)");
-        } else if (logfile) {
-            fprintf(logfile,
-                    "SEND_FORCE (%s): userFx=%.2f userFy=%.2f, "
-                    "P ~ 0 -> Fx=%.2f Fy=%.2f\n",
-                    reason ? reason : "?",
-                    user_force->Fx, user_force->Fy,
-                    out.Fx, out.Fy);
-            fflush(logfile);
-        }
-        return;
+        if (detail) snprintf(detail, detail_len, "P ~ 0");
+        return out;
     }
 
     // Finds discrete direction that best matches the repulsion P
     int idx = best_dir8_for_vector(Px, Py);  // util.c
     if (idx < 0) {
         // Falls back to user-only command if no good direction
-        ForceStateMsg out = *user_force;
-        if (write(fd_to_d, &out, sizeof(out)) == -1) {
-            perror("[B] write to D failed (no good dir)");
-        } else if (logfile) {
-            fprintf(logfile,
-                    "SEND_FORCE (%s): userFx=%.2f userFy=%.2f, "
-                    "P=(%.2f,%.2f), no good dir -> Fx=%.2f Fy=%.2f\n",
-                    reason ? reason : "?",
-                    user_force->Fx, user_force->Fy,
-                    Px, Py,
-                    out.Fx, out.Fy);
-            fflush(logfile);
-        }
-        return;
+        if (detail) snprintf(detail, detail_len, "P=(%.2f,%.2f), no good dir", Px, Py);
+        return out;
     }
 
     char   best_key = g_dir8[idx].key;
     double best_dot = dot2(Px, Py, g_dir8[idx].ux, g_dir8[idx].uy);   // the maximum projection of P on the direction vector
-
     if (best_dot <= 0.0) {
         // Same: Falls back to user-only command if projection is not positive
-        ForceStateMsg out = *user_force;
-        if (write(fd_to_d, &out, sizeof(out)) == -1) {
-            perror("[B] write to D failed (best_dot<=0)");
-        } else if (logfile) {
-            fprintf(logfile,
-                    "SEND_FORCE (%s): userFx=%.2f userFy=%.2f, "
-                    "P=(%.2f,%.2f), best_dot<=0 -> Fx=%.2f Fy=%.2f\n",
-                    reason ? reason : "?",
-                    user_force->Fx, user_force->Fy,
-                    Px, Py,
-                    out.Fx, out.Fy);
-            fflush(logfile);
-        }
-        return;
+        if (detail) snprintf(detail, detail_len, "P=(%.2f,%.2f), best_dot<=0", Px, Py);
+        return out;
     }
 
     // Converts best_dot (intensity of P) into 8 key steps
@@ -196,179 +151,96 @@ void send_total_force_to_d(const ForceStateMsg *user_force,
     double Fvk_y = n_steps * dFy * step_force;
 
     // Combines user + virtual-key repulsion
-    ForceStateMsg out = *user_force;
     out.Fx += Fvk_x;
     out.Fy += Fvk_y;
 
-    // Sends to D
-    if (write(fd_to_d, &out, sizeof(out)) == -1) {
-        perror("[B] write to D failed (virtual key rep)");
-    } else if (logfile) {
-        fprintf(logfile,
-                "SEND_FORCE (%s): userFx=%.2f userFy=%.2f, "
-                "P=(%.2f,%.2f), best_key=%c, n_steps=%d "
-                "Fvk=(%.2f,%.2f) => Fx=%.2f Fy=%.2f\n",
-                reason ? reason : "?",
-                user_force->Fx, user_force->Fy,
-                Px, Py,
-                best_key, n_steps,
-                Fvk_x, Fvk_y,
-                out.Fx, out.Fy);
-        fflush(logfile);
+    if (detail) {
+        snprintf(detail, detail_len,
+                 "P=(%.2f,%.2f), best_key=%c, n_steps=%d Fvk=(%.2f,%.2f)",
+                 Px, Py, best_key, n_steps, Fvk_x, Fvk_y);
     }
+    return out;
 }
 
-// Computes ontinuous repulsive force vector
+// Computes continuous wall repulsive force vector
 // ------------------ --------------------------------------------------------------
-void compute_repulsive_P(const DroneStateMsg *s,
-                         const SimParams     *params,
-                         const Obstacle      *obs,
-                         int                  num_obs,
-                         bool                 include_walls,
-                         bool                 include_obstacles,
-                         double              *Px,
-                         double              *Py)
+void compute_wall_P(const DroneStateMsg *s,
+                    const SimParams     *params,
+                    double              *Px,
+                    double              *Py)
 {
     const double eps = 1e-3;
     *Px = 0.0;
     *Py = 0.0;
 
-    
     // Computes wall repulsion force
     // Returns vector (Px,Py) as the sum of contributions for the 4 borders
     // ------------------ --------------------------------------------------------------
-    if (include_walls) {
-        double world_half     = params->world_half;
-        double wall_clearance = params->wall_clearance;
-        double wall_gain      = params->wall_gain;
-
-        if (wall_clearance > 0.0 && wall_gain > 0.0) {
-            // Right wall at x = +world_half
-            double d_right = world_half - s->x;
-            if (d_right < wall_clearance) {
-                if (d_right < eps) d_right = eps;
-                double mag = wall_gain * (1.0/d_right - 1.0/wall_clearance);
-                if (mag < 0.0) mag = 0.0;
-                // Pushes left
-                *Px -= mag; // py=0 here 
-            }
-
-            // Left wall at x = -world_half
-            double d_left = world_half + s->x;
-            if (d_left < wall_clearance) {
-                if (d_left < eps) d_left = eps;
-                double mag = wall_gain * (1.0/d_left - 1.0/wall_clearance);
-                if (mag < 0.0) mag = 0.0;
-                // Pushes right
-                *Px += mag;
-            }
-
-            // Top wall at y = +world_half
-            double d_top = world_half - s->y;
-            if (d_top < wall_clearance) {
-                if (d_top < eps) d_top = eps;
-                double mag = wall_gain * (1.0/d_top - 1.0/wall_clearance);
-                if (mag < 0.0) mag = 0.0;
-                // Pushes down
-                *Py -= mag;
-            }
-
-            // Bottom wall at y = -world_half
-            double d_bottom = world_half + s->y;
-            if (d_bottom < wall_clearance) {
-                if (d_bottom < eps) d_bottom = eps;
-                double mag = wall_gain * (1.0/d_bottom - 1.0/wall_clearance);
-                if (mag < 0.0) mag = 0.0;
-                // Pushes up
-                *Py += mag;
-            }
+    double world_half     = params->world_half;
+    double wall_clearance = params->wall_clearance;
+    double wall_gain      = params->wall_gain;
+
+    if (wall_clearance > 0.0 && wall_gain > 0.0) {
+        // Right wall at x = +world_half
+        double d_right = world_half - s->x;
+        if (d_right < wall_clearance) {
+            if (d_right < eps) d_right = eps;
+            double mag = wall_gain * (1.0/d_right - 1.0/wall_clearance);
+            if (mag < 0.0) mag = 0.0;
+            // Pushes left
+            *Px -= mag; // py=0 here 
         }
-    }
 
-    // Computes wall repulsion force continuous force(later mapped to the directions of the key cluster)
-    // Uses fixed obstacle params derived from world size
-    // ------------------ --------------------------------------------------------------
-    if (include_obstacles && obs && num_obs > 0) {
-         const double obs_clearance = params->world_half * 0.30;
-        const double obs_gain      = 120.0;   // 120 behaved well
-        if (obs_clearance <= 0.0 || obs_gain <= 0.0) {
-            return;
+        // Left wall at x = -world_half
+        double d_left = world_half + s->x;
+        if (d_left < wall_clearance) {
+            if (d_left < eps) d_left = eps;
+            double mag = wall_gain * (1.0/d_left - 1.0/wall_clearance);
+            if (mag < 0.0) mag = 0.0;
+            // Pushes right
+            *Px += mag;
         }
 
-        for (int k = 0; k < num_obs; ++k) {
-            if (!obs[k].active) continue;  // Skips inactive obstacles
-
-            double ox = obs[k].x;
-            double oy = obs[k].y;
-
-            double dx  = s->x - ox;
-            double dy  = s->y - oy;
-            double rho = sqrt(dx*dx + dy*dy);
-
-            if (rho < eps) {
-                rho = eps;
-            }
-
-            if (rho < obs_clearance) {
-                double mag = obs_gain * (1.0/rho - 1.0/obs_clearance);
-                if (mag < 0.0) mag = 0.0;
-
-                double ux = dx / rho;
-                double uy = dy / rho;
+        // Top wall at y = +world_half
+        double d_top = world_half - s->y;
+        if (d_top < wall_clearance) {
+            if (d_top < eps) d_top = eps;
+            double mag = wall_gain * (1.0/d_top - 1.0/wall_clearance);
+            if (mag < 0.0) mag = 0.0;
+            // Pushes down
+            *Py -= mag;
+        }
 
-                *Px += mag * ux;
-                *Py += mag * uy;
-            }
+        // Bottom wall at y = -world_half
+        double d_bottom = world_half + s->y;
+        if (d_bottom < wall_clearance) {
+            if (d_bottom < eps) d_bottom = eps;
+            double mag = wall_gain * (1.0/d_bottom - 1.0/wall_clearance);
+            if (mag < 0.0) mag = 0.0;
+            // Pushes up
+            *Py += mag;
         }
     }
 }
 
-// Checks if the drone has "hit" any active target.
-// Returns: number of targets collected in this call (0 or more).
-// ------------------------------------------------------------------
-int check_target_hits(const DroneStateMsg *cur_state,
-                      Target              *targets,
-                      int                  num_targets,
-                      const SimParams     *params,
-                      int                 *score,
-                      int                 *targets_collected,
-                      int                 *last_hit_step,
-                      int                  current_step)
-{
-    // Hitting radius in world units
-    double R_hit  = params->world_half * 0.08;           // 8% of world half-range.
-    double R_hit2 = R_hit * R_hit;
-
-    double px = cur_state->x;
-    double py = cur_state->y;
-
-    int hits = 0;
-
-    for (int i = 0; i < num_targets; ++i) {
-        if (!targets[i].active)
-            continue;
-
-        double dx = px - targets[i].x;
-        double dy = py - targets[i].y;
-        double d2 = dx*dx + dy*dy;
-
-        if (d2 <= R_hit2) {
-            // once target is hit, deactivate it
-            targets[i].active     = 0;
-            targets[i].life_steps = 0;
-
-            // Updates counters if pointers provided
-            if (score)             (*score)++;
-            if (targets_collected) (*targets_collected)++;
-            if (last_hit_step)     (*last_hit_step) = current_step;
 
-            hits++;
-        }
-    }
-
-    return hits;
+// Sleeps sim_sec simulated seconds (time_scale > 1 runs the world faster than real time).
+// ----------------------------------------------
+void sleep_sim_sec(double sim_sec, const SimParams *params) {
+    double scale = (params->time_scale > 0.0) ? params->time_scale : 1.0;
+    clock_sleep(sim_sec / scale);   // component clock: real, or virtual under arp1_vclock
 }
 
+void pace_sim_sec(double *next, double sim_sec, const SimParams *params) {
+    double scale = (params->time_scale > 0.0) ? params->time_scale : 1.0;
+    double step  = sim_sec / scale;
+    double now   = clock_now();
+    // First step, or more than a step behind (stall, suspend): restarts the
+    // schedule from now instead of bursting to catch up
+    if (*next < 0.0 || now > *next + step) *next = now;
+    *next += step;
+    clock_sleep_until(*next);
+}
 
 // Helper to perform uniform random double : used in obs and target generation
 double rand_in_range(double min, double max) {
@@ -406,20 +278,18 @@ int target_too_close_to_wall(double x,
 // Checks if position of target/obstacle is too close to any active obstacle/ target, respectively
 // (targets with too close obstacles are unattainable )
 // ------------------ --------------------------------------------------------------------------
-int too_close_to_any_pointlike(double px,
-                               double py,
-                               const PointLike *arr,
-                               int count,
-                               double min_dist)
+int too_close_to_any_point(double px,
+                           double py,
+                           const double *xs,
+                           const double *ys,
+                           int count,
+                           double min_dist)
 {
     double min_d2 = min_dist * min_dist;
 
     for (int i = 0; i < count; ++i) {
-        if (!arr[i].active)
-            continue;
-
-        double dx = px - arr[i].x;
-        double dy = py - arr[i].y;
+        double dx = px - xs[i];
+        double dy = py - ys[i];
 
         if (dx*dx + dy*dy <= min_d2)
             return 1;
@@ -0,0 +1,165 @@
+// vclock.c
+// Real / virtual component clock (see vclock.h)
+// ======================================================================
+
+#define _GNU_SOURCE
+#include "headers/vclock.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#define VCLOCK_QUIESCE_TIMEOUT_SEC 5.0   // real seconds a component may run between sleeps
+
+static VClockShared *g_vc      = NULL;   // NULL = real clock
+static int           g_vc_slot = -1;     // this process's slot (virtual mode)
+
+static double real_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static void real_sleep(double sec) {
+    struct timespec ts;
+    ts.tv_sec  = (time_t)sec;
+    ts.tv_nsec = (long)((sec - (double)ts.tv_sec) * 1e9);
+    nanosleep(&ts, NULL);
+}
+
+// Absolute CLOCK_MONOTONIC deadline (real_now() seconds); signals just wait again.
+static void real_sleep_until(double t) {
+    struct timespec ts;
+    ts.tv_sec  = (time_t)t;
+    ts.tv_nsec = (long)((t - (double)ts.tv_sec) * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+}
+
+double clock_now(void) {
+    if (!g_vc) return real_now();
+    return 1e-9 * (double)__atomic_load_n(&g_vc->now_ns, __ATOMIC_ACQUIRE);
+}
+
+// Virtual mode: marks the slot sleeping until deadline (ns) and waits for it.
+static void virtual_sleep_until(int64_t deadline) {
+    if (g_vc_slot >= 0) {
+        g_vc->slot[g_vc_slot].deadline_ns = deadline;
+        __atomic_store_n(&g_vc->slot[g_vc_slot].state, VC_SLOT_SLEEPING, __ATOMIC_RELEASE);
+    }
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&g_vc->seq, __ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&g_vc->now_ns, __ATOMIC_ACQUIRE) >= deadline) break;
+        // Shared mapping: no FUTEX_PRIVATE_FLAG. EINTR (signals) just waits again.
+        syscall(SYS_futex, &g_vc->seq, FUTEX_WAIT, seq, NULL, NULL, 0);
+    }
+    if (g_vc_slot >= 0) __atomic_store_n(&g_vc->slot[g_vc_slot].state, VC_SLOT_RUNNING, __ATOMIC_RELEASE);
+}
+
+void clock_sleep(double sec) {
+    if (!g_vc) {
+        real_sleep(sec);
+        return;
+    }
+    virtual_sleep_until(__atomic_load_n(&g_vc->now_ns, __ATOMIC_ACQUIRE) + (int64_t)(sec * 1e9));
+}
+
+void clock_sleep_until(double t) {
+    if (!g_vc) {
+        real_sleep_until(t);
+        return;
+    }
+    virtual_sleep_until((int64_t)(t * 1e9));
+}
+
+int vclock_use_virtual(void) {
+    if (g_vc) return 0;
+    VClockShared *vc = mmap(NULL, sizeof(VClockShared), PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (vc == MAP_FAILED) {
+        perror("[VCLOCK] mmap");
+        return -1;
+    }
+    memset(vc, 0, sizeof(*vc));
+    g_vc = vc;
+    return 0;
+}
+
+int vclock_is_virtual(void) {
+    return g_vc != NULL;
+}
+
+static void release_slot(void) {
+    if (g_vc && g_vc_slot >= 0)
+        __atomic_store_n(&g_vc->slot[g_vc_slot].state, VC_SLOT_EXITED, __ATOMIC_RELEASE);
+}
+
+pid_t vclock_fork(int slot) {
+    if (g_vc && slot >= 0 && slot < VCLOCK_MAX_SLOTS)
+        __atomic_store_n(&g_vc->slot[slot].state, VC_SLOT_RUNNING, __ATOMIC_RELEASE);
+    pid_t pid = fork();
+    if (pid == 0 && g_vc && slot >= 0 && slot < VCLOCK_MAX_SLOTS) {
+        g_vc_slot = slot;
+        atexit(release_slot);
+    } else if (pid == -1 && g_vc && slot >= 0 && slot < VCLOCK_MAX_SLOTS) {
+        g_vc->slot[slot].state = VC_SLOT_FREE;
+    }
+    return pid;
+}
+
+void vclock_mark_exited(int slot) {
+    if (g_vc && slot >= 0 && slot < VCLOCK_MAX_SLOTS)
+        __atomic_store_n(&g_vc->slot[slot].state, VC_SLOT_EXITED, __ATOMIC_RELEASE);
+}
+
+// Driver: quiescence, then a jump to the earliest deadline
+// ----------------------------------------------------------------------
+// Returns the earliest future deadline once no attached component runs.
+static int64_t settle(void) {
+    int64_t now = g_vc->now_ns;
+    double  t0  = real_now();
+    for (;;) {
+        int     busy = 0;
+        int64_t next = INT64_MAX;
+        for (int i = 0; i < VCLOCK_MAX_SLOTS; ++i) {
+            int32_t st = __atomic_load_n(&g_vc->slot[i].state, __ATOMIC_ACQUIRE);
+            if (st == VC_SLOT_RUNNING) { busy = 1; break; }
+            if (st != VC_SLOT_SLEEPING) continue;
+            int64_t d = g_vc->slot[i].deadline_ns;
+            if (d <= now) { busy = 1; break; }   // woken, not yet running
+            if (d < next) next = d;
+        }
+        if (!busy) return next;
+        if (real_now() - t0 > VCLOCK_QUIESCE_TIMEOUT_SEC) {
+            fprintf(stderr, "[VCLOCK] a component has not slept for %.0fs; advancing anyway\n",
+                    VCLOCK_QUIESCE_TIMEOUT_SEC);
+            return next;
+        }
+        struct timespec ts = { 0, 20 * 1000 };   // 20 us
+        nanosleep(&ts, NULL);
+    }
+}
+
+void vclock_settle(void) {
+    if (g_vc) settle();
+}
+
+double vclock_advance(double limit_sec) {
+    if (!g_vc) return real_now();
+
+    int64_t next  = settle();
+    int64_t limit = (int64_t)(limit_sec * 1e9);
+    if (next > limit) next = limit;
+    if (next > g_vc->now_ns) {
+        __atomic_store_n(&g_vc->now_ns, next, __ATOMIC_RELEASE);
+        __atomic_add_fetch(&g_vc->seq, 1, __ATOMIC_ACQ_REL);
+        syscall(SYS_futex, &g_vc->seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+    return 1e-9 * (double)g_vc->now_ns;
+}
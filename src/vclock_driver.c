@@ -0,0 +1,264 @@
+// vclock_driver.c
+// arp1_vclock: runs real components on the virtual clock (vclock.h)
+//   - watchdog:   forks W, heartbeats it like B until -s, then checks the
+//                 warning (SIGUSR2) and the stop (SIGTERM) land warn_sec /
+//                 kill_sec of virtual time later
+//   - generators: forks O and T, drains their pipes for -s virtual seconds
+//                 and checks every batch arrives exactly one spawn interval
+//                 after the previous one
+//   - the driver is the only thing that moves time, so minutes of timing run
+//     in milliseconds and every run gives the same event times
+//   - component logs go to logs/ as usual (watchdog/obstacles/targets.log)
+// ======================================================================
+
+#define _GNU_SOURCE
+#include "headers/vclock.h"
+#include "headers/watchdog.h"
+#include "headers/messages.h"
+#include "headers/params.h"
+#include "headers/obstacles.h"
+#include "headers/targets.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define MAX_BATCHES 4096
+
+static double real_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + 1e-6 * (double)ts.tv_nsec;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s watchdog   [-w warn_sec] [-k kill_sec] [-s stop_sec]\n"
+            "       %s generators [-s sim_sec]\n"
+            "  watchdog:   heartbeats stop at stop_sec (default 30); W must warn and\n"
+            "              stop the system warn_sec / kill_sec later (defaults: params.txt)\n"
+            "  generators: O and T batches over sim_sec virtual seconds (default 900)\n",
+            prog, prog);
+    exit(EXIT_FAILURE);
+}
+
+// Watchdog: the driver plays B
+// ----------------------------------------------------------------------
+static volatile double g_warn_at = -1.0;   // virtual time of W's SIGUSR2
+static volatile double g_term_at = -1.0;   // virtual time of W's SIGTERM
+
+static void on_warn(int signo) { (void)signo; g_warn_at = clock_now(); }
+static void on_term(int signo) { (void)signo; g_term_at = clock_now(); }
+
+static int check(const char *what, double at, double expect, double lo, double hi) {
+    int ok = at >= 0.0 && at - expect >= lo && at - expect <= hi;
+    if (at < 0.0) printf("  %-8s never   (expected %.2f)  FAIL\n", what, expect);
+    else          printf("  %-8s t=%.2f (expected %.2f)  %s\n", what, at, expect, ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+static int run_watchdog_case(const SimParams *p, int warn_sec, int kill_sec, double stop_sec) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sa.sa_handler = on_warn;
+    sigaction(SIGUSR2, &sa, NULL);
+    sa.sa_handler = on_term;
+    sigaction(SIGTERM, &sa, NULL);
+
+    int cfg[2];
+    if (pipe(cfg) == -1) {
+        perror("[VCLOCK] pipe");
+        return 0;
+    }
+    pid_t w = vclock_fork(0);
+    if (w == -1) {
+        perror("[VCLOCK] fork");
+        return 0;
+    }
+    if (w == 0) {
+        close(cfg[1]);
+        run_watchdog_process(cfg[0], warn_sec, kill_sec);   // never returns
+    }
+    close(cfg[0]);
+    WatchPids pids = { getpid(), 0, 0, 0, 0 };
+    if (write(cfg[1], &pids, sizeof(pids)) != (ssize_t)sizeof(pids)) perror("[VCLOCK] write WatchPids");
+
+    double beat_dt = p->dt > 0.0 ? p->dt : 0.05;   // B beats once per state
+    double end     = stop_sec + kill_sec + 5.0;
+    long   beats   = 0;
+    double t0      = real_ms();
+    int    reaped  = 0;
+
+    while (g_term_at < 0.0) {
+        vclock_settle();
+        double t = clock_now();
+        if (t >= end) break;
+        if (t < stop_sec && t >= (double)beats * beat_dt) {
+            kill(w, SIGUSR1);
+            beats++;
+        }
+        double limit = (double)beats * beat_dt;
+        if (limit >= stop_sec) limit = end;
+        vclock_advance(limit);
+
+        if (waitpid(w, NULL, WNOHANG) == w) {
+            vclock_mark_exited(0);
+            reaped = 1;
+            break;
+        }
+    }
+    double wall = real_ms() - t0;
+    close(cfg[1]);
+    if (!reaped) {
+        kill(w, SIGKILL);
+        waitpid(w, NULL, 0);
+    }
+
+    printf("watchdog: warn_sec=%d kill_sec=%d, %ld heartbeat(s) until t=%.2f\n",
+           warn_sec, kill_sec, beats, stop_sec);
+    // Last beat at most beat_dt before stop_sec, seen at W's next 100 ms poll
+    int ok = check("warning", g_warn_at, stop_sec + warn_sec, -beat_dt, 0.2 + 1e-9);
+    ok    &= check("stop",    g_term_at, stop_sec + kill_sec, -beat_dt, 0.2 + 1e-9);
+    printf("  %.1f virtual s in %.1f real ms\n", clock_now(), wall);
+    return ok;
+}
+
+// Generators: O and T on slots 1 and 2
+// ----------------------------------------------------------------------
+typedef struct {
+    const char *name;
+    int         fd;          // read end
+    pid_t       pid;
+    size_t      msg_size;
+    double      interval;    // expected, virtual seconds
+    double      at[MAX_BATCHES];
+    int         n;
+} GenCase;
+
+static void drain(GenCase *g, double now) {
+    char buf[sizeof(ObstacleSetMsg) > sizeof(TargetSetMsg) ? sizeof(ObstacleSetMsg) : sizeof(TargetSetMsg)];
+    for (;;) {
+        ssize_t n = read(g->fd, buf, g->msg_size);
+        if (n != (ssize_t)g->msg_size) break;
+        if (g->n < MAX_BATCHES) g->at[g->n++] = now;
+    }
+}
+
+static int report_gen(const GenCase *g, double sim_sec) {
+    int    expect = (int)floor(sim_sec / g->interval + 1e-9) + 1;   // one at t=0
+    double lo = INFINITY, hi = 0.0;
+    for (int i = 1; i < g->n; ++i) {
+        double d = g->at[i] - g->at[i - 1];
+        if (d < lo) lo = d;
+        if (d > hi) hi = d;
+    }
+    int ok = g->n == expect && g->n > 0 && g->at[0] == 0.0 &&
+             (g->n < 2 || (fabs(lo - g->interval) < 1e-6 && fabs(hi - g->interval) < 1e-6));
+    printf("  %s: %d batch(es) (expected %d), interval %.3f..%.3f s (expected %.3f)  %s\n",
+           g->name, g->n, expect, g->n > 1 ? lo : 0.0, hi, g->interval, ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+static int spawn_gen(GenCase *g, int slot, SimParams p, void (*run)(int, SimParams)) {
+    int fds[2];
+    if (pipe(fds) == -1) {
+        perror("[VCLOCK] pipe");
+        return -1;
+    }
+    g->pid = vclock_fork(slot);
+    if (g->pid == -1) {
+        perror("[VCLOCK] fork");
+        return -1;
+    }
+    if (g->pid == 0) {
+        close(fds[0]);
+        run(fds[1], p);   // never returns
+        _exit(EXIT_FAILURE);
+    }
+    close(fds[1]);
+    g->fd = fds[0];
+    fcntl(g->fd, F_SETFL, fcntl(g->fd, F_GETFL, 0) | O_NONBLOCK);
+    return 0;
+}
+
+static int run_generators_case(const SimParams *p, double sim_sec) {
+    double scale = p->time_scale > 0.0 ? p->time_scale : 1.0;
+    static GenCase gens[2];
+    gens[0] = (GenCase){ .name = "O", .msg_size = sizeof(ObstacleSetMsg),
+                         .interval = OBS_SPAWN_INTERVAL_SEC / scale };
+    gens[1] = (GenCase){ .name = "T", .msg_size = sizeof(TargetSetMsg),
+                         .interval = TGT_SPAWN_INTERVAL_SEC / scale };
+    if (spawn_gen(&gens[0], 1, *p, run_obstacle_process) == -1 ||
+        spawn_gen(&gens[1], 2, *p, run_target_process)   == -1) return 0;
+
+    double t0 = real_ms();
+    for (;;) {
+        vclock_settle();   // batches due now are in the pipes
+        double t = clock_now();
+        drain(&gens[0], t);
+        drain(&gens[1], t);
+        if (t >= sim_sec) break;
+        vclock_advance(sim_sec);
+    }
+    double wall = real_ms() - t0;
+
+    for (int i = 0; i < 2; ++i) {
+        kill(gens[i].pid, SIGTERM);   // asleep on the futex: default action
+        waitpid(gens[i].pid, NULL, 0);
+        vclock_mark_exited(i + 1);
+        close(gens[i].fd);
+    }
+
+    printf("generators: %.0f virtual s (time_scale=%g)\n", sim_sec, scale);
+    int ok = report_gen(&gens[0], sim_sec);
+    ok    &= report_gen(&gens[1], sim_sec);
+    printf("  %.1f virtual s in %.1f real ms\n", clock_now(), wall);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) usage(argv[0]);
+    const char *cmd = argv[1];
+
+    SimParams params;
+    init_default_params(&params);
+    load_params_from_file("params.txt", &params);
+
+    int    warn_sec = params.wd_warn_sec;
+    int    kill_sec = params.wd_kill_sec;
+    double stop_sec = -1.0;
+
+    int opt;
+    optind = 2;
+    while ((opt = getopt(argc, argv, "w:k:s:h")) != -1) {
+        switch (opt) {
+            case 'w': warn_sec = atoi(optarg); break;
+            case 'k': kill_sec = atoi(optarg); break;
+            case 's': stop_sec = atof(optarg); break;
+            default:  usage(argv[0]);
+        }
+    }
+
+    if (vclock_use_virtual() == -1) return EXIT_FAILURE;
+
+    int ok;
+    if (strcmp(cmd, "watchdog") == 0) {
+        if (warn_sec < 1 || kill_sec <= warn_sec) usage(argv[0]);
+        ok = run_watchdog_case(&params, warn_sec, kill_sec, stop_sec < 0.0 ? 30.0 : stop_sec);
+    } else if (strcmp(cmd, "generators") == 0) {
+        ok = run_generators_case(&params, stop_sec < 0.0 ? 900.0 : stop_sec);
+    } else {
+        usage(argv[0]);
+    }
+    printf("%s\n", ok ? "VCLOCK PASS" : "VCLOCK FAIL");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
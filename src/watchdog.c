@@ -9,6 +9,15 @@
 //   - If no heartbeat for warn_sec: send SIGUSR2 to B (warning notification).
 //   - If no heartbeat for kill_sec: send SIGTERM to all processes (stop system).
 //
+// Configuration:
+//   - B sends WatchPids once at startup and again whenever a supervised pid
+//     changes (generator restart, D failover); W always uses the latest set.
+//
+// Exits (pidwatch.h):
+//   - W holds a pidfd for every supervised process and waits on them with
+//     the heartbeat timer. B exiting stops the rest at once; any other exit
+//     is logged with its reason (B restarts that component).
+//
 // Why signals:
 //   - W is signal-based.
 //   - Heartbeat = "I'm alive" → classic SIGUSR1 usage.
@@ -17,6 +26,8 @@
 
 #include "headers/watchdog.h"
 #include "headers/util.h"   // die()
+#include "headers/vclock.h" // clock_now(), clock_sleep()
+#include "headers/pidwatch.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -25,12 +36,14 @@
 #include <time.h>
 #include <errno.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/select.h>
 
 // Global/shared state inside watchdog process only
 static volatile sig_atomic_t g_got_beat = 0;
 
-// Store last heartbeat time (monotonic clock)
-static struct timespec g_last_beat_ts;
+// Store last heartbeat time (component clock, see vclock.h)
+static double g_last_beat;
 
 // Received heartbeat from B
 static void on_sigusr1(int signo) {
@@ -38,16 +51,22 @@ static void on_sigusr1(int signo) {
     g_got_beat = 1;
 }
 
-// Helper: get monotonic time in seconds (double)
-static double now_monotonic_sec(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+// Helper: SIGTERM to a supervised pid (-1 = peer gone, never kill(-1, ...))
+static void term_pid(pid_t pid) {
+    if (pid > 0) kill(pid, SIGTERM);
 }
 
-// Helper: convert a timespec to seconds
-static double ts_to_sec(const struct timespec *ts) {
-    return (double)ts->tv_sec + (double)ts->tv_nsec * 1e-9;
+// pidfds for the current set; thread components report B's pid
+static void watch_pids(PidWatch *pw, const WatchPids *p, FILE *log) {
+    const char *names[5] = { "B", "I", "D", "O", "T" };
+    pid_t       pids[5]  = { p->pid_B, p->pid_I, p->pid_D, p->pid_O, p->pid_T };
+    for (int i = 0; i < 5; ++i) {
+        pid_t pid = (i > 0 && pids[i] == p->pid_B) ? -1 : pids[i];
+        if (pw_add(pw, names[i], pid) == -1 && log) {
+            fprintf(log, "[W] pidfd for %s (pid %d): %s%s\n", names[i], (int)pid, strerror(errno),
+                    errno == ENOSYS ? " -> heartbeat timeouts only" : "");
+        }
+    }
 }
 
 void run_watchdog_process(int cfg_read_fd, int warn_sec, int kill_sec) {
@@ -71,7 +90,9 @@ void run_watchdog_process(int cfg_read_fd, int warn_sec, int kill_sec) {
         close(cfg_read_fd);
         exit(EXIT_FAILURE);
     }
-    close(cfg_read_fd);
+    // Later updates are polled from the main loop
+    int fl = fcntl(cfg_read_fd, F_GETFL, 0);
+    fcntl(cfg_read_fd, F_SETFL, (fl == -1 ? 0 : fl) | O_NONBLOCK);
 
     if (log) {
         fprintf(log, "[W] Started. Watching PIDs: B=%d I=%d D=%d O=%d T=%d\n",
@@ -94,19 +115,67 @@ void run_watchdog_process(int cfg_read_fd, int warn_sec, int kill_sec) {
     }
 
     // Initialize last beat time to "now" (gives system time to start)
-    clock_gettime(CLOCK_MONOTONIC, &g_last_beat_ts);
+    g_last_beat = clock_now();
+
+    PidWatch pw;
+    pw_init(&pw);
+    watch_pids(&pw, &p, log);
 
     // 4) Main loop: check heartbeat timing
     int warned = 0;
     while (1) {
+        // Picks up pid updates from B (latest wins); EOF = B will not send more
+        while (cfg_read_fd != -1) {
+            WatchPids upd;
+            n = read(cfg_read_fd, &upd, sizeof(upd));
+            if (n == (int)sizeof(upd)) {
+                p = upd;
+                watch_pids(&pw, &p, log);
+                if (log) {
+                    fprintf(log, "[W] Updated PIDs: B=%d I=%d D=%d O=%d T=%d\n",
+                            (int)p.pid_B, (int)p.pid_I, (int)p.pid_D, (int)p.pid_O, (int)p.pid_T);
+                    fflush(log);
+                }
+                continue;
+            }
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+                close(cfg_read_fd);
+                cfg_read_fd = -1;
+            }
+            break;
+        }
+
+        // Supervised exits: B takes the system down with it, others are B's to restart
+        const char *who;
+        pid_t       gone;
+        int         stop = 0;
+        while (pw_next_exit(&pw, NULL, &who, &gone) == 0) {
+            char why[64];
+            pw_exit_reason(gone, why, sizeof(why));
+            if (strcmp(who, "B") == 0) {
+                if (log) fprintf(log, "[W] B (pid %d) %s -> stopping system (SIGTERM)\n", (int)gone, why);
+                stop = 1;
+            } else if (log) {
+                fprintf(log, "[W] %s (pid %d) %s\n", who, (int)gone, why);
+            }
+            if (log) fflush(log);
+        }
+        if (stop) {
+            term_pid(p.pid_I);
+            term_pid(p.pid_D);
+            term_pid(p.pid_O);
+            term_pid(p.pid_T);
+            break;
+        }
+
         // If we got heartbeat since last loop, update last_beat_ts
         if (g_got_beat) {
             g_got_beat = 0;
-            clock_gettime(CLOCK_MONOTONIC, &g_last_beat_ts);
+            g_last_beat = clock_now();
             warned = 0; // reset warning state once heartbeat resumes
         }
 
-        double elapsed = now_monotonic_sec() - ts_to_sec(&g_last_beat_ts);
+        double elapsed = clock_now() - g_last_beat;
 
         // WARN stage: notify B (one-time per missing-heartbeat episode)
         if (!warned && elapsed >= (double)warn_sec) {
@@ -127,22 +196,35 @@ void run_watchdog_process(int cfg_read_fd, int warn_sec, int kill_sec) {
             }
 
             // Termination order: first tell B (so UI can exit), then the others active processes
-            kill(p.pid_B, SIGTERM);
-            kill(p.pid_I, SIGTERM);
-            kill(p.pid_D, SIGTERM);
-            kill(p.pid_O, SIGTERM);
-            kill(p.pid_T, SIGTERM);
+            term_pid(p.pid_B);
+            term_pid(p.pid_I);
+            term_pid(p.pid_D);
+            term_pid(p.pid_O);
+            term_pid(p.pid_T);
 
             break;
         }
 
-        // Sleep a bit (low CPU usage)
-        struct timespec ts;
-        ts.tv_sec = 0;
-        ts.tv_nsec = 100 * 1000 * 1000; // 100 ms
-        nanosleep(&ts, NULL);
+        // Waits 100 ms for a heartbeat, a pid update or an exit (virtual
+        // time: plain sleep, exits are polled above)
+        if (vclock_is_virtual()) {
+            clock_sleep(0.1);
+        } else {
+            fd_set rfds;
+            FD_ZERO(&rfds);
+            int maxfd = -1;
+            pw_watch(&pw, &rfds, &maxfd);
+            if (cfg_read_fd != -1) {
+                FD_SET(cfg_read_fd, &rfds);
+                if (cfg_read_fd > maxfd) maxfd = cfg_read_fd;
+            }
+            struct timeval tv = { 0, 100000 };
+            select(maxfd + 1, &rfds, NULL, NULL, &tv);   // EINTR on a heartbeat
+        }
     }
 
+    pw_close(&pw);
+    if (cfg_read_fd != -1) close(cfg_read_fd);
     if (log) {
         fprintf(log, "[W] Exiting.\n");
         fclose(log);
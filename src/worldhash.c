@@ -0,0 +1,100 @@
+// worldhash.c
+// Incremental world-state hash (see worldhash.h)
+// ======================================================================
+
+#include "headers/worldhash.h"
+
+#include <string.h>
+
+static const char *k_group_names[WH_COUNT] = {
+    "drone", "force", "obstacles", "targets", "score", "streams"
+};
+
+const char *wh_group_name(WhGroup g) {
+    return (g >= 0 && g < WH_COUNT) ? k_group_names[g] : "?";
+}
+
+// splitmix64 finalizer: every input bit affects every output bit
+static uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static uint64_t fold(uint64_t h, uint64_t v) {
+    return mix64(h ^ mix64(v + 0x9E3779B97F4A7C15ull));
+}
+
+static uint64_t bits(double d) {
+    if (d == 0.0) d = 0.0;   // -0.0 and 0.0 are the same world
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    return u;
+}
+
+// Inactive slots contribute 0, so stale coordinates of a free slot do not count.
+static uint64_t slot_hash(WhGroup g, int i, double x, double y, int active) {
+    if (!active) return 0;
+    uint64_t h = fold((uint64_t)g << 32, (uint64_t)i);
+    h = fold(h, bits(x));
+    return fold(h, bits(y));
+}
+
+void wh_init(WorldHash *h) {
+    memset(h, 0, sizeof(*h));
+    DroneStateMsg s = { 0 };
+    ForceStateMsg f = { 0 };
+    WhStreams     st = { 0 };
+    wh_set_drone(h, &s);
+    wh_set_force(h, &f);
+    wh_set_score(h, 0, 0);
+    wh_set_streams(h, &st);
+}
+
+void wh_set_drone(WorldHash *h, const DroneStateMsg *s) {
+    uint64_t v = fold(WH_DRONE, bits(s->x));
+    v = fold(v, bits(s->y));
+    v = fold(v, bits(s->vx));
+    h->group[WH_DRONE] = fold(v, bits(s->vy));
+}
+
+void wh_set_force(WorldHash *h, const ForceStateMsg *f) {
+    uint64_t v = fold(WH_FORCE, bits(f->Fx));
+    h->group[WH_FORCE] = fold(v, bits(f->Fy));
+}
+
+void wh_set_score(WorldHash *h, int score, int collected) {
+    uint64_t v = fold(WH_SCORE, (uint64_t)(uint32_t)score);
+    h->group[WH_SCORE] = fold(v, (uint64_t)(uint32_t)collected);
+}
+
+void wh_set_streams(WorldHash *h, const WhStreams *st) {
+    uint64_t v = fold(WH_STREAMS, st->obs_batches);
+    v = fold(v, st->tgt_batches);
+    v = fold(v, st->soak_rng);
+    h->group[WH_STREAMS] = fold(v, st->scn_cursor);
+}
+
+void wh_set_obstacle(WorldHash *h, int i, double x, double y, int active) {
+    if (i < 0 || i >= NUM_OBSTACLES) return;
+    uint64_t v = slot_hash(WH_OBSTACLES, i, x, y, active);
+    if (v == h->obs_slot[i]) return;
+    h->group[WH_OBSTACLES] ^= h->obs_slot[i] ^ v;
+    h->obs_slot[i] = v;
+    h->slot_updates++;
+}
+
+void wh_set_target(WorldHash *h, int i, double x, double y, int active) {
+    if (i < 0 || i >= NUM_TARGETS) return;
+    uint64_t v = slot_hash(WH_TARGETS, i, x, y, active);
+    if (v == h->tgt_slot[i]) return;
+    h->group[WH_TARGETS] ^= h->tgt_slot[i] ^ v;
+    h->tgt_slot[i] = v;
+    h->slot_updates++;
+}
+
+uint64_t wh_world(const WorldHash *h) {
+    uint64_t w = 0;
+    for (int g = 0; g < WH_COUNT; ++g) w ^= h->group[g];
+    return w;
+}